@@ -0,0 +1,122 @@
+/*
+ * Copyright 2015-2017 Guillermo Frontera <guillermo.frontera@upm.es>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#ifndef UES_MISC_BINARY_IO_H
+#define UES_MISC_BINARY_IO_H
+
+#include <cstddef>
+#include <cstdint>
+#include <istream>
+#include <ostream>
+#include <type_traits>
+#include <vector>
+
+#include <exc/exception.h>
+
+namespace ues
+{
+namespace misc
+{
+
+/** Writes the raw representation of \a value to \a out. */
+template<class T>
+inline void write_binary ( std::ostream & out, const T & value );
+
+/** Writes the raw representation of all the elements of \a values to \a out, preceded by their
+ * number. */
+template<class T>
+inline void write_binary ( std::ostream & out, const std::vector<T> & values );
+
+/** Writes the raw representation of the \a count elements starting at \a values to \a out,
+ * without their number. */
+template<class T>
+inline void write_binary ( std::ostream & out, const T * values, std::size_t count );
+
+/** Reads the raw representation of \a value from \a in. */
+template<class T>
+inline void read_binary ( std::istream & in, T & value );
+
+/** Reads a vector written by write_binary from \a in. */
+template<class T>
+inline void read_binary ( std::istream & in, std::vector<T> & values );
+
+
+// Template implementation.
+
+
+template<class T>
+void write_binary ( std::ostream & out, const T & value )
+{
+    static_assert ( std::is_trivially_copyable<T>::value, "Only trivially copyable types can be written" );
+
+    out.write ( reinterpret_cast<const char *> ( &value ), sizeof ( T ) );
+    if ( !out )
+        throw ues::exc::exception ( "Unable to write binary data", UES_CONTEXT );
+}
+
+
+template<class T>
+void write_binary ( std::ostream & out, const std::vector<T> & values )
+{
+    static_assert ( std::is_trivially_copyable<T>::value, "Only trivially copyable types can be written" );
+
+    write_binary ( out, static_cast<std::uint64_t> ( values.size() ) );
+    out.write ( reinterpret_cast<const char *> ( values.data() ), values.size() * sizeof ( T ) );
+    if ( !out )
+        throw ues::exc::exception ( "Unable to write binary data", UES_CONTEXT );
+}
+
+
+template<class T>
+void write_binary ( std::ostream & out, const T * values, std::size_t count )
+{
+    static_assert ( std::is_trivially_copyable<T>::value, "Only trivially copyable types can be written" );
+
+    out.write ( reinterpret_cast<const char *> ( values ), count * sizeof ( T ) );
+    if ( !out )
+        throw ues::exc::exception ( "Unable to write binary data", UES_CONTEXT );
+}
+
+
+template<class T>
+void read_binary ( std::istream & in, T & value )
+{
+    static_assert ( std::is_trivially_copyable<T>::value, "Only trivially copyable types can be read" );
+
+    in.read ( reinterpret_cast<char *> ( &value ), sizeof ( T ) );
+    if ( !in )
+        throw ues::exc::exception ( "Unexpected end of binary data", UES_CONTEXT );
+}
+
+
+template<class T>
+void read_binary ( std::istream & in, std::vector<T> & values )
+{
+    static_assert ( std::is_trivially_copyable<T>::value, "Only trivially copyable types can be read" );
+
+    std::uint64_t size;
+    read_binary ( in, size );
+    values.resize ( size );
+    in.read ( reinterpret_cast<char *> ( values.data() ), size * sizeof ( T ) );
+    if ( !in )
+        throw ues::exc::exception ( "Unexpected end of binary data", UES_CONTEXT );
+}
+
+}
+}
+
+#endif // UES_MISC_BINARY_IO_H
@@ -0,0 +1,74 @@
+/*
+ * Copyright 2015-2017 Guillermo Frontera <guillermo.frontera@upm.es>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#ifndef UES_MISC_BITS_H
+#define UES_MISC_BITS_H
+
+#include <cstdint>
+
+namespace ues
+{
+namespace misc
+{
+
+/** Returns the number of zeros to the right of the least significant one of \a x, which must
+ * not be zero. */
+inline unsigned int count_trailing_zeros ( std::uint64_t x ) noexcept;
+
+/** Returns the number of zeros to the left of the most significant one of \a x, which must not
+ * be zero. */
+inline unsigned int count_leading_zeros ( std::uint64_t x ) noexcept;
+
+
+// Inline implementation.
+
+
+unsigned int count_trailing_zeros ( std::uint64_t x ) noexcept
+{
+#if defined(__GNUC__) || defined(__clang__)
+    return __builtin_ctzll ( x );
+#else
+    unsigned int result = 0;
+    while ( ( x & 1 ) == 0 )
+    {
+        x >>= 1;
+        ++result;
+    }
+    return result;
+#endif
+}
+
+
+unsigned int count_leading_zeros ( std::uint64_t x ) noexcept
+{
+#if defined(__GNUC__) || defined(__clang__)
+    return __builtin_clzll ( x );
+#else
+    unsigned int result = 0;
+    while ( ( x & ( std::uint64_t ( 1 ) << 63 ) ) == 0 )
+    {
+        x <<= 1;
+        ++result;
+    }
+    return result;
+#endif
+}
+
+}
+}
+
+#endif // UES_MISC_BITS_H
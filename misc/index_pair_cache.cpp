@@ -0,0 +1,93 @@
+/*
+ * Copyright 2015-2017 Guillermo Frontera <guillermo.frontera@upm.es>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include "index_pair_cache.h"
+
+#include <functional>
+
+using namespace ues::misc;
+
+namespace
+{
+
+// Layout of a cell: bit 63 marks the cell as used, bit 62 holds the cached value and the
+// remaining bits hold both indices.
+const std::uint64_t USED_BIT = std::uint64_t ( 1 ) << 63;
+const std::uint64_t VALUE_BIT = std::uint64_t ( 1 ) << 62;
+const unsigned int INDEX_BITS = 31;
+
+std::uint64_t pack_key ( std::size_t first, std::size_t second ) noexcept
+{
+    return USED_BIT | ( std::uint64_t ( first ) << INDEX_BITS ) | std::uint64_t ( second );
+}
+
+}
+
+const index_pair_cache::size_type index_pair_cache::MAXIMUM_INDEX = ( size_type ( 1 ) << INDEX_BITS ) - 1;
+
+
+index_pair_cache::index_pair_cache()
+    : index_pair_cache ( 0 )
+{
+}
+
+
+index_pair_cache::index_pair_cache ( size_type max_size )
+    : max_size ( max_size ),
+      cells ( new cell[max_size] )
+{
+    for ( size_type i = 0; i < max_size; ++i )
+    {
+        cells[i].store ( 0, std::memory_order_relaxed );
+    }
+}
+
+
+bool index_pair_cache::find ( size_type first, size_type second, bool & value ) const noexcept
+{
+    if ( max_size == 0 || first > MAXIMUM_INDEX || second > MAXIMUM_INDEX )
+    {
+        return false;
+    }
+
+    std::uint64_t content = cells[ position ( first, second ) ].load ( std::memory_order_relaxed );
+    if ( ( content & ~VALUE_BIT ) == pack_key ( first, second ) )
+    {
+        value = ( content & VALUE_BIT ) != 0;
+        return true;
+    }
+    return false;
+}
+
+
+void index_pair_cache::insert ( size_type first, size_type second, bool value ) noexcept
+{
+    if ( max_size == 0 || first > MAXIMUM_INDEX || second > MAXIMUM_INDEX )
+    {
+        return;
+    }
+
+    std::uint64_t content = pack_key ( first, second ) | ( value ? VALUE_BIT : 0 );
+    cells[ position ( first, second ) ].store ( content, std::memory_order_relaxed );
+}
+
+
+index_pair_cache::size_type index_pair_cache::position ( size_type first, size_type second ) const noexcept
+{
+    std::hash<size_type> f;
+    return ( ( f ( first ) << ( sizeof ( std::size_t ) << 2 ) ) ^ f ( second ) ) % max_size;
+}
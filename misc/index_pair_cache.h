@@ -0,0 +1,83 @@
+/*
+ * Copyright 2015-2017 Guillermo Frontera <guillermo.frontera@upm.es>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#ifndef UES_MISC_INDEX_PAIR_CACHE_H
+#define UES_MISC_INDEX_PAIR_CACHE_H
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+
+namespace ues
+{
+namespace misc
+{
+
+/** Direct-mapped cache of boolean results keyed by pairs of indices. Every cell is a single
+ * atomic word, so the cache can be read and filled concurrently without locks. Concurrent
+ * writers to the same cell simply replace each other, which only costs a recomputation. */
+class index_pair_cache
+{
+public:
+    typedef std::size_t size_type;
+
+    /** Largest index that can be stored in the cache. Pairs containing larger indices are
+     * never cached. */
+    static const size_type MAXIMUM_INDEX;
+
+    /** \name Constructor methods */
+    /** \{ */
+
+    index_pair_cache();
+    index_pair_cache ( size_type max_size );
+
+    index_pair_cache ( const index_pair_cache & other ) = delete;
+    index_pair_cache ( index_pair_cache && other ) = default;
+
+    ~index_pair_cache() noexcept = default;
+
+    /** \} */
+
+    /** \name Operators */
+    /** \{ */
+
+    index_pair_cache & operator= ( const index_pair_cache & ) = delete;
+    index_pair_cache & operator= ( index_pair_cache && ) = default;
+
+    /** \} */
+
+    /** Looks for the pair (\a first, \a second) in the cache. If found, its value is returned in
+     * \a value and the method returns true. */
+    bool find ( size_type first, size_type second, bool & value ) const noexcept;
+
+    /** Stores the value of the pair (\a first, \a second), replacing whatever was in its cell. */
+    void insert ( size_type first, size_type second, bool value ) noexcept;
+
+private:
+    typedef std::atomic< std::uint64_t > cell;
+
+    size_type max_size;
+    std::unique_ptr< cell[] > cells;
+
+    /** Returns the cell in which a pair is stored. */
+    size_type position ( size_type first, size_type second ) const noexcept;
+};
+
+}
+}
+
+#endif // UES_MISC_INDEX_PAIR_CACHE_H
@@ -0,0 +1,30 @@
+/*
+ * Copyright 2015-2017 Guillermo Frontera <guillermo.frontera@upm.es>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#ifndef UES_MISC_PREFETCH_H
+#define UES_MISC_PREFETCH_H
+
+/** \def UES_PREFETCH(address)
+ * Hints the processor to bring the cache line of \a address into the cache for reading, so a
+ * later access does not stall. It does nothing on compilers without such a builtin. */
+#if defined(__GNUC__) || defined(__clang__)
+#define UES_PREFETCH(address) __builtin_prefetch ( (address), 0, 3 )
+#else
+#define UES_PREFETCH(address) ( (void) (address) )
+#endif
+
+#endif // UES_MISC_PREFETCH_H
@@ -0,0 +1,148 @@
+/*
+ * Copyright 2015-2017 Guillermo Frontera <guillermo.frontera@upm.es>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include "thread_pool.h"
+
+#include <algorithm>
+
+using namespace ues::misc;
+
+
+thread_pool::thread_pool ( unsigned int number_of_threads )
+    : job ( nullptr ),
+      number_of_tasks ( 0 ),
+      next_task ( 0 ),
+      busy_workers ( 0 ),
+      generation ( 0 ),
+      stopping ( false ),
+      error_task ( 0 )
+{
+    if ( number_of_threads == 0 )
+    {
+        number_of_threads = std::max ( 1u, std::thread::hardware_concurrency() );
+    }
+
+    workers.reserve ( number_of_threads );
+    for ( unsigned int i = 0; i < number_of_threads; ++i )
+    {
+        workers.emplace_back ( &thread_pool::work, this, i );
+    }
+}
+
+
+thread_pool::~thread_pool() noexcept
+{
+    {
+        std::lock_guard< std::mutex > lock ( mtx );
+        stopping = true;
+    }
+    job_available.notify_all();
+
+    for ( std::thread & thr : workers )
+    {
+        if ( thr.joinable() )
+        {
+            thr.join();
+        }
+    }
+}
+
+
+unsigned int thread_pool::size() const noexcept
+{
+    return workers.size();
+}
+
+
+void thread_pool::run ( std::size_t number_of_tasks, const task_function & fn )
+{
+    if ( number_of_tasks == 0 )
+    {
+        return;
+    }
+
+    // Only one batch can be in flight at a time.
+    std::lock_guard< std::mutex > run_lock ( run_mtx );
+
+    std::unique_lock< std::mutex > lock ( mtx );
+    job = &fn;
+    this->number_of_tasks = number_of_tasks;
+    next_task = 0;
+    busy_workers = workers.size();
+    error = nullptr;
+    ++generation;
+
+    job_available.notify_all();
+    job_finished.wait ( lock, [this] { return busy_workers == 0; } );
+
+    job = nullptr;
+    if ( error )
+    {
+        std::exception_ptr e = error;
+        error = nullptr;
+        std::rethrow_exception ( e );
+    }
+}
+
+
+void thread_pool::work ( unsigned int worker )
+{
+    unsigned long last_generation = 0;
+
+    while ( true )
+    {
+        const task_function * fn;
+        std::size_t count;
+        {
+            std::unique_lock< std::mutex > lock ( mtx );
+            job_available.wait ( lock, [&] { return stopping || generation != last_generation; } );
+            if ( stopping )
+            {
+                return;
+            }
+            last_generation = generation;
+            fn = job;
+            count = number_of_tasks;
+        }
+
+        for ( std::size_t task = next_task++; task < count; task = next_task++ )
+        {
+            try
+            {
+                ( *fn ) ( task, worker );
+            }
+            catch ( ... )
+            {
+                // Keep the error of the lowest task, as if they were run in order.
+                std::lock_guard< std::mutex > lock ( mtx );
+                if ( !error || task < error_task )
+                {
+                    error = std::current_exception();
+                    error_task = task;
+                }
+            }
+        }
+
+        {
+            std::lock_guard< std::mutex > lock ( mtx );
+            if ( --busy_workers == 0 )
+            {
+                job_finished.notify_all();
+            }
+        }
+    }
+}
@@ -0,0 +1,92 @@
+/*
+ * Copyright 2015-2017 Guillermo Frontera <guillermo.frontera@upm.es>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#ifndef UES_MISC_THREAD_POOL_H
+#define UES_MISC_THREAD_POOL_H
+
+#include <atomic>
+#include <condition_variable>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace ues
+{
+namespace misc
+{
+
+/** Fixed set of worker threads that execute batches of independent tasks. Tasks are
+ * distributed dynamically, so workers that finish early take the remaining ones. */
+class thread_pool
+{
+public:
+    /** Function executed for every task. It receives the task index and the index of the
+     * worker running it, which is always lower than size(). */
+    typedef std::function< void ( std::size_t, unsigned int ) > task_function;
+
+    /** \name Constructor and destructor methods */
+    /** \{ */
+
+    /** Creates a pool with \a number_of_threads workers. If zero, the number of hardware
+     * threads is used. */
+    thread_pool ( unsigned int number_of_threads = 0 );
+
+    thread_pool ( const thread_pool & ) = delete;
+
+    ~thread_pool() noexcept;
+
+    /** \} */
+
+    thread_pool & operator= ( const thread_pool & ) = delete;
+
+    /** Returns the number of workers of the pool. */
+    unsigned int size() const noexcept;
+
+    /** Runs \a fn for every task index in [0, \a number_of_tasks) and blocks until all of them
+     * have finished. If any task throws, the exception of the lowest task index is rethrown
+     * once the batch is complete, so it does not depend on the timing of the workers. Must not
+     * be called from inside a task of the same pool. */
+    void run ( std::size_t number_of_tasks, const task_function & fn );
+
+private:
+    std::vector< std::thread > workers;
+
+    std::mutex run_mtx;
+    std::mutex mtx;
+    std::condition_variable job_available;
+    std::condition_variable job_finished;
+
+    const task_function * job;
+    std::size_t number_of_tasks;
+    std::atomic< std::size_t > next_task;
+    unsigned int busy_workers;
+    unsigned long generation;
+    bool stopping;
+    std::exception_ptr error;
+    /** Index of the task that threw \a error. */
+    std::size_t error_task;
+
+    /** Main loop of every worker thread. */
+    void work ( unsigned int worker );
+};
+
+}
+}
+
+#endif // UES_MISC_THREAD_POOL_H
@@ -0,0 +1,36 @@
+/*
+ * Copyright 2015-2017 Guillermo Frontera <guillermo.frontera@upm.es>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include "ellipse_bound.h"
+
+#include <algorithm>
+
+
+ues::math::numeric_type ues::pf::fly_over_length ( const ues::env::obstacle_vector & obstacles,
+                                                   const ues::geom::point<3> & origin,
+                                                   const ues::geom::point<3> & target ) noexcept
+{
+    ues::math::numeric_type height = std::max ( origin.get_z(), target.get_z() );
+    for ( const ues::env::obstacle & obs : obstacles )
+    {
+        height = std::max ( height, obs.get_height() );
+    }
+
+    ues::math::numeric_type dx = target.get_x() - origin.get_x();
+    ues::math::numeric_type dy = target.get_y() - origin.get_y();
+    return ( height - origin.get_z() ) + std::sqrt ( dx * dx + dy * dy ) + ( height - target.get_z() );
+}
@@ -0,0 +1,136 @@
+/*
+ * Copyright 2015-2017 Guillermo Frontera <guillermo.frontera@upm.es>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#ifndef UES_PF_ELLIPSE_BOUND_H
+#define UES_PF_ELLIPSE_BOUND_H
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+#include <env/obstacle_vector.h>
+#include <geom/box_2d.h>
+#include <geom/point.h>
+#include <math/constants.h>
+
+namespace ues
+{
+namespace pf
+{
+
+/** The ellipse_bound describes the region where a path between two points that is not longer
+ * than a known length must lie. Once a feasible path of length L is known, a point p can only be
+ * on a better path if |origin - p| + |p - target| <= L, that is, if p is inside the ellipse (or
+ * ellipsoid) whose foci are the origin and the target. Searches and graph builders may discard
+ * every point out of it. */
+template<unsigned short N>
+class ellipse_bound
+{
+public:
+    /** Constructor method of a bound that contains every point. */
+    ellipse_bound ( ues::geom::point<N> origin, ues::geom::point<N> target ) noexcept;
+
+    /** Constructor method of the bound of the paths not longer than \a length. */
+    ellipse_bound ( ues::geom::point<N> origin, ues::geom::point<N> target, ues::math::numeric_type length ) noexcept;
+
+    /** Returns the maximum length of the paths, which is infinite if the bound is not set. */
+    ues::math::numeric_type get_length() const noexcept;
+
+    /** Returns true if the bound discards any point. */
+    bool is_bounded() const noexcept;
+
+    /** Returns true if \a point may be on a path not longer than the bound. */
+    inline bool contains ( const ues::geom::point<N> & point ) const noexcept;
+
+    /** Returns true if a path not longer than the bound may go through the projection of the
+     * \a box on the first two coordinates. Points out of the box are never discarded wrongly, but
+     * some boxes that cannot be reached may be kept. */
+    bool may_intersect ( const ues::geom::box_2d & box ) const noexcept;
+
+private:
+    ues::geom::point<N> origin;
+    ues::geom::point<N> target;
+    /** The length, including a small tolerance for rounding errors. */
+    ues::math::numeric_type length;
+};
+
+/** Returns the length of the path from \a origin to \a target that climbs vertically over the
+ * tallest of the \a obstacles, goes straight above them and descends vertically. Since the
+ * obstacles are vertical prisms, such path is always feasible, so its length bounds the length
+ * of the shortest path. */
+ues::math::numeric_type fly_over_length ( const ues::env::obstacle_vector & obstacles,
+                                          const ues::geom::point<3> & origin,
+                                          const ues::geom::point<3> & target ) noexcept;
+
+
+// Template implementation.
+
+
+template<unsigned short N>
+ellipse_bound<N>::ellipse_bound ( ues::geom::point<N> origin, ues::geom::point<N> target ) noexcept
+    : ellipse_bound ( std::move ( origin ), std::move ( target ), std::numeric_limits<ues::math::numeric_type>::infinity() )
+{
+}
+
+
+template<unsigned short N>
+ellipse_bound<N>::ellipse_bound ( ues::geom::point<N> origin, ues::geom::point<N> target, ues::math::numeric_type length ) noexcept
+    : origin ( std::move ( origin ) ),
+      target ( std::move ( target ) ),
+      length ( length + ues::math::epsilon * ( 1 + length ) )
+{
+}
+
+
+template<unsigned short N>
+ues::math::numeric_type ellipse_bound<N>::get_length() const noexcept
+{
+    return length;
+}
+
+
+template<unsigned short N>
+bool ellipse_bound<N>::is_bounded() const noexcept
+{
+    return std::isfinite ( length );
+}
+
+
+template<unsigned short N>
+bool ellipse_bound<N>::contains ( const ues::geom::point<N> & point ) const noexcept
+{
+    return origin.distance_to ( point ) + point.distance_to ( target ) <= length;
+}
+
+
+template<unsigned short N>
+bool ellipse_bound<N>::may_intersect ( const ues::geom::box_2d & box ) const noexcept
+{
+    // The distance from each focus to the box is a lower bound of the distance to any of its points.
+    auto distance_to_box = [&box] ( const ues::geom::point<N> & p )
+    {
+        ues::math::numeric_type dx = std::max ( { box.get_min_x() - p.get ( 0 ), ues::math::numeric_type ( 0 ), p.get ( 0 ) - box.get_max_x() } );
+        ues::math::numeric_type dy = std::max ( { box.get_min_y() - p.get ( 1 ), ues::math::numeric_type ( 0 ), p.get ( 1 ) - box.get_max_y() } );
+        return std::sqrt ( dx * dx + dy * dy );
+    };
+    return distance_to_box ( origin ) + distance_to_box ( target ) <= length;
+}
+
+}
+}
+
+#endif // UES_PF_ELLIPSE_BOUND_H
@@ -86,41 +86,53 @@ bool visibility_graph::check_visibility ( size_type point1_index, size_type poin
 {
     size_type min_index = std::min ( point1_index, point2_index );
     size_type max_index = std::max ( point1_index, point2_index );
-    point_index_pair index_pair = std::make_pair ( min_index, max_index );
 
     ues::geom::segment<3> seg ( points[point1_index], points[point2_index] );
     distance = seg.length();
     bool result;
 
-    index_cache::iterator cache_it = cache.find ( index_pair );
-    if ( cache_it != cache.end() )
-    {
-        result = cache_it->second;
-    }
-    else
+    if ( !cache.find ( min_index, max_index, result ) )
     {
         result = !obstacles.check_intersection ( seg );
-        cache.insert ( index_pair, result );
+        cache.insert ( min_index, max_index, result );
     }
 
     return result;
 }
 
 
-visibility_graph::point_index_vector visibility_graph::adjacents ( size_type point_index ) const
+void visibility_graph::visit_adjacents ( size_type point_index, edge_visitor & visitor ) const
 {
-    point_index_vector result;
-    ues::math::numeric_type dummy_dist;
+    ues::math::numeric_type distance;
 
     for ( size_type i = 0; i < size(); ++i )
     {
-        if ( i != point_index && check_visibility ( point_index, i, dummy_dist ) )
+        if ( i != point_index && check_visibility ( point_index, i, distance ) )
         {
-            result.push_back ( i );
+            visitor.visit ( i, distance );
         }
     }
+}
 
-    return result;
+
+void visibility_graph::visit_candidate_adjacents ( size_type point_index, edge_visitor & visitor ) const
+{
+    const ues::geom::point<3> & point = points[point_index];
+
+    for ( size_type i = 0; i < size(); ++i )
+    {
+        if ( i != point_index )
+        {
+            visitor.visit ( i, point.distance_to ( points[i] ) );
+        }
+    }
+}
+
+
+bool visibility_graph::validate_candidate ( size_type point1_index, size_type point2_index ) const
+{
+    ues::math::numeric_type distance;
+    return check_visibility ( point1_index, point2_index, distance );
 }
 
 
@@ -162,10 +174,3 @@ void visibility_graph::describe ( std::ostream & out ) const noexcept
     out << "Visibility graph with obstacles:\n";
     out << obstacles << '\n';
 }
-
-
-std::size_t visibility_graph::index_pair_hash::operator() ( const point_index_pair & p ) const noexcept
-{
-    std::hash<size_type> f;
-    return ( f ( p.first ) << ( sizeof ( std::size_t ) << 2 ) ) ^ f ( p.second );
-}
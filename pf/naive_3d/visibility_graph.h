@@ -23,7 +23,7 @@
 #include <env/obstacle_vector.h>
 
 #include <pf/visibility_graph/visibility_graph.h>
-#include <misc/cache.h>
+#include <misc/index_pair_cache.h>
 
 namespace ues
 {
@@ -63,27 +63,11 @@ public:
     /** Prints the visibility matrix to the \a out parameter. */
     void describe ( std::ostream & out ) const noexcept override;
 
-private:
-    typedef std::vector< ues::geom::point<3> > point_vector;
-    typedef std::unordered_map<ues::geom::point<3>, size_type> point_map;
-    typedef typename ues::pf::visibility_graph<3>::point_index_vector point_index_vector;
-    typedef std::pair<size_type, size_type> point_index_pair;
-
-    struct index_pair_hash
-    {
-        std::size_t operator() ( const point_index_pair & ) const noexcept;
-    };
-
-    typedef ues::misc::cache< point_index_pair, bool, index_pair_hash > index_cache;
-
-    ues::env::obstacle_vector obstacles;
-    point_vector points;
-    point_map point_indices;
-    mutable index_cache cache;
+    typedef typename ues::pf::visibility_graph<3>::edge_visitor edge_visitor;
 
-    /** Returns the index assigned to a point. */
-    const geom::point<3> & index_to_point ( size_type point_index ) const override;
     /** Returns the point assigned to an index. */
+    const geom::point<3> & index_to_point ( size_type point_index ) const override;
+    /** Returns the index assigned to a point. */
     size_type point_to_index ( const geom::point<3> & point ) const override;
 
     /** Returns true if the points of indices \a point1_index and \a point2_index are visible
@@ -91,9 +75,33 @@ private:
      * points is returned in the variable \a distance. */
     bool check_visibility ( size_type point1_index, size_type point2_index, ues::math::numeric_type & distance ) const override;
 
-    /** Returns a vector containing all the point indices corresponding to points that are
-     * visible from the point of index \a point_index. */
-    point_index_vector adjacents ( size_type point_index ) const override;
+    /** Calls the \a visitor for every point visible from the point of index \a point_index,
+     * without allocating any memory. */
+    void visit_adjacents ( size_type point_index, edge_visitor & visitor ) const override;
+
+    /** Calls the \a visitor for every other point of the graph, with the distance to it. The
+     * visibility of these candidates is only checked by validate_candidate. */
+    void visit_candidate_adjacents ( size_type point_index, edge_visitor & visitor ) const override;
+
+    /** Returns true if the points of indices \a point1_index and \a point2_index are visible
+     * from one another. */
+    bool validate_candidate ( size_type point1_index, size_type point2_index ) const override;
+
+    /** Reintroduce hidden overloads. */
+    using ues::pf::visibility_graph<3>::check_visibility;
+
+private:
+    typedef std::vector< ues::geom::point<3> > point_vector;
+    typedef std::unordered_map<ues::geom::point<3>, size_type> point_map;
+
+    /** Visibility results already computed. The cache is lock-free, so concurrent searches
+     * over the same graph can share it. */
+    typedef ues::misc::index_pair_cache index_cache;
+
+    ues::env::obstacle_vector obstacles;
+    point_vector points;
+    point_map point_indices;
+    mutable index_cache cache;
 
     /** Inserts a point as a vertex of the graph. */
     bool insert_point ( ues::geom::point<3> point );
@@ -31,6 +31,16 @@ const std::string component_name = "Edge Sampling Pathfinder";
 ues::pf::path<3> visibility_graph_pathfinder::find_path ( const ues::env::obstacle_vector & obstacles,
                                                           const ues::geom::point<3> & origin,
                                                           const ues::geom::point<3> & target ) const
+{
+    ues::pf::search_statistics statistics;
+    return find_path ( obstacles, origin, target, statistics );
+}
+
+
+ues::pf::path<3> visibility_graph_pathfinder::find_path ( const ues::env::obstacle_vector & obstacles,
+                                                          const ues::geom::point<3> & origin,
+                                                          const ues::geom::point<3> & target,
+                                                          ues::pf::search_statistics & statistics ) const
 {
     ues::log::logger lg;
 
@@ -45,8 +55,13 @@ ues::pf::path<3> visibility_graph_pathfinder::find_path ( const ues::env::obstac
     try
     {
 
+        // Most of the sampled points are never part of the path, so their visibility is only
+        // checked when the search is about to use them.
         ues::pf::graph_pathfinder<3> finder ( std::make_shared<visibility_graph> ( obstacles, origin, target ) );
-        ues::pf::path<3> result = finder.find_path ( origin, target );
+        finder.set_edge_evaluation ( ues::pf::graph_pathfinder<3>::LAZY_EVALUATION );
+        ues::pf::search_workspace<3> workspace;
+        ues::pf::path<3> result = finder.find_path ( origin, target, workspace );
+        statistics = workspace.statistics;
 
         if ( lg.min_level() <= ues::log::DEBUG_LVL )
         {
@@ -0,0 +1,221 @@
+/*
+ * Copyright 2015-2017 Guillermo Frontera <guillermo.frontera@upm.es>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include "path_shortcutter.h"
+
+#include <algorithm>
+#include <limits>
+
+#include <geom/box_2d.h>
+#include <log/logger.h>
+
+using namespace ues::pf;
+
+const std::string component_name = "Path shortcutter";
+
+namespace
+{
+
+/** Number of shortcuts checked together by the greedy strategy. */
+const std::size_t GREEDY_BATCH_SIZE = 8;
+
+/** Bounds of an obstacle, used to discard it quickly for the segments that cannot reach it. */
+struct obstacle_bounds
+{
+    ues::geom::box_2d box;
+    ues::math::numeric_type height;
+};
+
+std::vector< obstacle_bounds > compute_bounds ( const ues::env::obstacle_vector & obstacles )
+{
+    std::vector< obstacle_bounds > result;
+    result.reserve ( obstacles.size() );
+    for ( const ues::env::obstacle & obs : obstacles )
+    {
+        ues::geom::box_2d box ( obs.get_shape().get_point_at ( 0 ) );
+        for ( const ues::geom::point<2> & p : obs.get_shape() )
+        {
+            box.include_point ( p );
+        }
+        result.push_back ( { box, obs.get_height() } );
+    }
+    return result;
+}
+
+/** Checks the visibility from the vertex of index \a origin of \a input_path to each of the
+ * vertices of indices \a candidates, leaving the result in \a visible. */
+void check_shortcuts ( const ues::env::obstacle_vector & obstacles,
+                       const std::vector< obstacle_bounds > & bounds,
+                       const ues::pf::path<3> & input_path,
+                       std::size_t origin,
+                       const std::vector< std::size_t > & candidates,
+                       std::vector< bool > & visible )
+{
+    const ues::geom::point<3> & first = input_path[ origin ];
+    const ues::geom::point<2> first_2d ( first.get_x(), first.get_y() );
+
+    std::vector< ues::geom::box_2d > boxes;
+    std::vector< ues::math::numeric_type > min_heights;
+    boxes.reserve ( candidates.size() );
+    min_heights.reserve ( candidates.size() );
+    for ( std::size_t candidate : candidates )
+    {
+        const ues::geom::point<3> & second = input_path[ candidate ];
+        ues::geom::box_2d box ( first_2d );
+        box.include_point ( ues::geom::point<2> ( second.get_x(), second.get_y() ) );
+        boxes.push_back ( box );
+        min_heights.push_back ( std::min ( first.get_z(), second.get_z() ) );
+    }
+    visible.assign ( candidates.size(), true );
+    std::size_t remaining = candidates.size();
+
+    for ( std::size_t k = 0; k < obstacles.size() && remaining > 0; ++k )
+    {
+        for ( std::size_t c = 0; c < candidates.size(); ++c )
+        {
+            if ( visible[c] && min_heights[c] < bounds[k].height && boxes[c].intersects ( bounds[k].box ) )
+            {
+                ues::geom::point<3> intersection_point;
+                if ( obstacles[k].check_intersection ( ues::geom::segment<3> ( first, input_path[ candidates[c] ] ), intersection_point ) )
+                {
+                    visible[c] = false;
+                    --remaining;
+                }
+            }
+        }
+    }
+}
+
+}
+
+
+path_shortcutter::path_shortcutter ( strategy used_strategy ) noexcept
+    : used_strategy ( used_strategy )
+{
+}
+
+
+path_shortcutter::strategy path_shortcutter::get_strategy() const noexcept
+{
+    return used_strategy;
+}
+
+
+void path_shortcutter::set_strategy ( strategy used_strategy ) noexcept
+{
+    this->used_strategy = used_strategy;
+}
+
+
+path<3> path_shortcutter::shortcut ( const ues::env::obstacle_vector & obstacles,
+                                     const path<3> & input_path ) const
+{
+    if ( input_path.size() < 3 )
+    {
+        return input_path;
+    }
+
+    const std::vector< obstacle_bounds > bounds = compute_bounds ( obstacles );
+    const std::size_t n = input_path.size();
+    std::vector< std::size_t > candidates;
+    std::vector< bool > visible;
+
+    // Index of the vertex from which every vertex of the result is reached.
+    std::vector< std::size_t > parents ( n );
+
+    if ( used_strategy == GREEDY )
+    {
+        std::size_t current = 0;
+        while ( current + 1 < n )
+        {
+            // Check the furthest vertices first, falling back to the next one in the path.
+            std::size_t next = current + 1;
+            std::size_t last = n;
+            while ( last > current + 2 && next == current + 1 )
+            {
+                candidates.clear();
+                for ( std::size_t j = last - 1; j > current + 1 && candidates.size() < GREEDY_BATCH_SIZE; --j )
+                {
+                    candidates.push_back ( j );
+                }
+                check_shortcuts ( obstacles, bounds, input_path, current, candidates, visible );
+                std::vector< bool >::const_iterator it = std::find ( visible.begin(), visible.end(), true );
+                if ( it != visible.end() )
+                {
+                    next = candidates[ it - visible.begin() ];
+                }
+                last = candidates.back();
+            }
+            parents[ next ] = current;
+            current = next;
+        }
+    }
+    else
+    {
+        // Vertices are in topological order, since shortcuts only go forward.
+        std::vector< ues::math::numeric_type > costs ( n, std::numeric_limits<ues::math::numeric_type>::infinity() );
+        costs[0] = 0;
+        auto relax = [&] ( std::size_t i, std::size_t j )
+        {
+            const ues::math::numeric_type cost = costs[i] + input_path[i].distance_to ( input_path[j] );
+            if ( cost < costs[j] )
+            {
+                costs[j] = cost;
+                parents[j] = i;
+            }
+        };
+
+        for ( std::size_t i = 0; i + 1 < n; ++i )
+        {
+            // The segments of the input path are not checked.
+            relax ( i, i + 1 );
+
+            candidates.clear();
+            for ( std::size_t j = i + 2; j < n; ++j )
+            {
+                candidates.push_back ( j );
+            }
+            check_shortcuts ( obstacles, bounds, input_path, i, candidates, visible );
+            for ( std::size_t c = 0; c < candidates.size(); ++c )
+            {
+                if ( visible[c] )
+                {
+                    relax ( i, candidates[c] );
+                }
+            }
+        }
+    }
+
+    path<3> reverse_result;
+    for ( std::size_t current = n - 1; current != 0; current = parents[ current ] )
+    {
+        reverse_result.push_back ( input_path[ current ] );
+    }
+    reverse_result.push_back ( input_path.front() );
+    path<3> result ( reverse_result.rbegin(), reverse_result.rend() );
+
+    ues::log::logger lg;
+    if ( lg.min_level() <= ues::log::DEBUG_LVL )
+    {
+        ues::log::event e ( ues::log::DEBUG_LVL, component_name, "Shortcut path" );
+        e.message() << "Removed " << n - result.size() << " of " << n << " vertices, length reduced from "
+                    << input_path.length() << " to " << result.length() << '\n';
+        lg.record ( std::move ( e ) );
+    }
+
+    return result;
+}
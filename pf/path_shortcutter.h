@@ -0,0 +1,70 @@
+/*
+ * Copyright 2015-2017 Guillermo Frontera <guillermo.frontera@upm.es>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#ifndef UES_PF_PATH_SHORTCUTTER_H
+#define UES_PF_PATH_SHORTCUTTER_H
+
+#include <env/obstacle_vector.h>
+
+#include <pf/path.h>
+
+namespace ues
+{
+namespace pf
+{
+
+/** The path_shortcutter removes unnecessary intermediate vertices of a path, replacing parts of
+ * the path with straight segments that do not intersect any obstacle. The segments leaving a
+ * vertex are checked together, so every obstacle is only visited once per vertex and discarded
+ * early for the segments whose bounding box does not reach it. The segments of the original
+ * path are never checked, so the result is only as valid as the input path. */
+class path_shortcutter
+{
+public:
+    /** Strategies used to choose the shortcuts. */
+    enum strategy
+    {
+        /** From every vertex, jump to the furthest vertex of the path that is visible from it.
+         * Checks at most n segments per vertex, but the result may not be the shortest one. */
+        GREEDY,
+        /** Checks the visibility between every pair of vertices and keeps the shortest path
+         * along the visible pairs. */
+        DYNAMIC
+    };
+
+    /** Constructor method. */
+    path_shortcutter ( strategy used_strategy = GREEDY ) noexcept;
+
+    /** Returns the strategy used to choose the shortcuts. */
+    strategy get_strategy() const noexcept;
+
+    /** Changes the strategy used to choose the shortcuts. */
+    void set_strategy ( strategy used_strategy ) noexcept;
+
+    /** Returns a path from the first to the last vertex of \a input_path, whose vertices are a
+     * subsequence of the vertices of \a input_path, and that is not longer than it. */
+    path<3> shortcut ( const ues::env::obstacle_vector & obstacles,
+                       const path<3> & input_path ) const;
+
+private:
+    strategy used_strategy;
+};
+
+}
+}
+
+#endif // UES_PF_PATH_SHORTCUTTER_H
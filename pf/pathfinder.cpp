@@ -20,6 +20,39 @@
 using namespace ues::pf;
 
 
+path<3> pathfinder::find_path ( const ues::env::obstacle_vector & obstacles,
+                                const ues::geom::point<3> & origin,
+                                const ues::geom::point<3> & target,
+                                search_statistics & statistics ) const
+{
+    statistics = search_statistics();
+    return find_path ( obstacles, origin, target );
+}
+
+
+const std::shared_ptr< const path_shortcutter > & pathfinder::get_path_shortcutter() const noexcept
+{
+    return shortcutter;
+}
+
+
+void pathfinder::set_path_shortcutter ( std::shared_ptr< const path_shortcutter > shortcutter ) noexcept
+{
+    this->shortcutter = std::move ( shortcutter );
+}
+
+
+path<3> pathfinder::postprocess_path ( const ues::env::obstacle_vector & obstacles,
+                                       path<3> input_path ) const
+{
+    if ( shortcutter )
+    {
+        return shortcutter->shortcut ( obstacles, input_path );
+    }
+    return input_path;
+}
+
+
 pathfinder * ues::pf::new_clone ( const pathfinder & p )
 {
     return p.clone();
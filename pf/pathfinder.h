@@ -18,9 +18,13 @@
 #ifndef UES_PF_PATHFINDER_H
 #define UES_PF_PATHFINDER_H
 
+#include <memory>
+
 #include <env/obstacle_vector.h>
 
 #include <pf/path.h>
+#include <pf/path_shortcutter.h>
+#include <pf/search_statistics.h>
 
 namespace ues
 {
@@ -38,6 +42,26 @@ public:
                                 const ues::geom::point<3> & origin,
                                 const ues::geom::point<3> & target ) const = 0;
 
+    /** Generates a path like the other overload, describing the work done by its graph searches
+     * in \a statistics. Pathfinders not based on graph searches leave the statistics empty. */
+    virtual path<3> find_path ( const ues::env::obstacle_vector & obstacles,
+                                const ues::geom::point<3> & origin,
+                                const ues::geom::point<3> & target,
+                                search_statistics & statistics ) const;
+
+    /** Returns the shortcutter applied to the paths of this pathfinder, or a null pointer if
+     * the paths are not post-processed. */
+    const std::shared_ptr< const path_shortcutter > & get_path_shortcutter() const noexcept;
+
+    /** Changes the shortcutter applied to the paths of this pathfinder. A null pointer disables
+     * the post-processing. */
+    void set_path_shortcutter ( std::shared_ptr< const path_shortcutter > shortcutter ) noexcept;
+
+    /** Applies the shortcutter of this pathfinder to a path found among the \a obstacles, or
+     * returns the path unchanged if there is none. */
+    path<3> postprocess_path ( const ues::env::obstacle_vector & obstacles,
+                               path<3> input_path ) const;
+
     /** \name Clone methods */
     /** \{ */
     /** Returns a pointer to a copy of this \c pathfinder object. */
@@ -45,6 +69,9 @@ public:
     /** Returns a pointer to a copy of this \c pathfinder object, destroying the original. */
     virtual pathfinder * clone() && = 0;
     /** \} */
+
+private:
+    std::shared_ptr< const path_shortcutter > shortcutter;
 };
 
 pathfinder * new_clone ( const pathfinder & );
@@ -34,6 +34,16 @@ const unsigned int plane_cut_pathfinder::CUT_NUMBER = 4;
 path<3> plane_cut_pathfinder::find_path ( const ues::env::obstacle_vector & obstacles,
                                           const ues::geom::point<3> & origin,
                                           const ues::geom::point<3> & target ) const
+{
+    search_statistics statistics;
+    return find_path ( obstacles, origin, target, statistics );
+}
+
+
+path<3> plane_cut_pathfinder::find_path ( const ues::env::obstacle_vector & obstacles,
+                                          const ues::geom::point<3> & origin,
+                                          const ues::geom::point<3> & target,
+                                          search_statistics & statistics ) const
 {
     ues::log::logger lg;
 
@@ -49,6 +59,7 @@ path<3> plane_cut_pathfinder::find_path ( const ues::env::obstacle_vector & obst
     {
 
         path<3> result;
+        statistics = search_statistics();
 
         if ( origin != target )
         {
@@ -65,7 +76,9 @@ path<3> plane_cut_pathfinder::find_path ( const ues::env::obstacle_vector & obst
                     ues::geom::point<2> transformed_target;
                     std::vector< ues::geom::polygon > transformed_obstacles;
                     transform_environment ( std::move ( transform ), obstacles, origin, target, transformed_obstacles, transformed_origin, transformed_target );
-                    path<2> path_2d = ues::pf::vg2d::visibility_graph_pathfinder::find_path ( transformed_obstacles, transformed_origin, transformed_target );
+                    search_statistics plane_statistics;
+                    path<2> path_2d = ues::pf::vg2d::visibility_graph_pathfinder::find_path ( transformed_obstacles, transformed_origin, transformed_target, plane_statistics );
+                    statistics += plane_statistics;
                     path<3> temp_result = expand_path ( path_2d, inverse_transform );
                     bool is_valid = true;
                     for ( path<3>::size_type i = 1; i < temp_result.size() - 1; ++i )
@@ -32,7 +32,12 @@ public:
     
     path<3> find_path ( const ues::env::obstacle_vector & obstacles,
                         const ues::geom::point<3> & origin,
-                        const ues::geom::point<3> & target ) const;
+                        const ues::geom::point<3> & target ) const override;
+
+    path<3> find_path ( const ues::env::obstacle_vector & obstacles,
+                        const ues::geom::point<3> & origin,
+                        const ues::geom::point<3> & target,
+                        search_statistics & statistics ) const override;
 
     static ues::math::matrix transformation_matrix ( const geom::point<3> & origin, const geom::point<3> & target );
 
@@ -0,0 +1,127 @@
+/*
+ * Copyright 2015-2017 Guillermo Frontera <guillermo.frontera@upm.es>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#ifndef UES_PF_SEARCH_STATISTICS_H
+#define UES_PF_SEARCH_STATISTICS_H
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+
+/** \def UES_PF_STATISTICS(...)
+ * Keeps its arguments only when the search statistics are compiled in, that is, when the
+ * UES_PF_SEARCH_STATISTICS macro is defined. Otherwise the searches are not instrumented. */
+#ifdef UES_PF_SEARCH_STATISTICS
+#define UES_PF_STATISTICS(...) __VA_ARGS__
+#else
+#define UES_PF_STATISTICS(...)
+#endif
+
+namespace ues
+{
+namespace pf
+{
+
+#ifdef UES_PF_SEARCH_STATISTICS
+
+/** The search_statistics type describes the work done by the graph searches of a query. */
+struct search_statistics
+{
+    typedef std::chrono::steady_clock clock;
+    typedef std::chrono::nanoseconds duration;
+
+    /** Points extracted from the open list and expanded. */
+    std::size_t expanded_points = 0;
+    /** Edges examined towards points not expanded yet. */
+    std::size_t relaxed_edges = 0;
+    /** Points of the open list whose cost was improved, with eager evaluation. */
+    std::size_t decreased_keys = 0;
+    /** Maximum number of entries in the open list. */
+    std::size_t peak_frontier_size = 0;
+    /** Time spent computing the heuristic. */
+    duration heuristic_time = duration::zero();
+    /** Time spent enumerating the neighbours of the expanded points. With eager evaluation,
+     * it includes the evaluation of the edges done by the graph. */
+    duration adjacents_time = duration::zero();
+    /** Time spent validating candidate edges, with lazy evaluation. */
+    duration edge_time = duration::zero();
+
+    /** Accumulates the statistics of another search run for the same query. */
+    inline search_statistics & operator+= ( const search_statistics & other ) noexcept;
+
+    /** The scoped_timer class adds the time elapsed during its lifetime to a duration. */
+    class scoped_timer
+    {
+    public:
+        explicit scoped_timer ( duration & total ) noexcept
+            : total ( total ), start ( clock::now() )
+        {
+        }
+
+        ~scoped_timer() noexcept
+        {
+            total += clock::now() - start;
+        }
+
+    private:
+        duration & total;
+        clock::time_point start;
+    };
+};
+
+#else
+
+/** Without UES_PF_SEARCH_STATISTICS, the search_statistics type is empty, so the searches and
+ * the results that carry it store nothing. */
+struct search_statistics
+{
+    /** Does nothing, as there is nothing to accumulate. */
+    inline search_statistics & operator+= ( const search_statistics & other ) noexcept;
+};
+
+#endif
+
+
+// Inlined methods.
+
+#ifdef UES_PF_SEARCH_STATISTICS
+
+search_statistics & search_statistics::operator+= ( const search_statistics & other ) noexcept
+{
+    expanded_points += other.expanded_points;
+    relaxed_edges += other.relaxed_edges;
+    decreased_keys += other.decreased_keys;
+    peak_frontier_size = std::max ( peak_frontier_size, other.peak_frontier_size );
+    heuristic_time += other.heuristic_time;
+    adjacents_time += other.adjacents_time;
+    edge_time += other.edge_time;
+    return *this;
+}
+
+#else
+
+search_statistics & search_statistics::operator+= ( const search_statistics & ) noexcept
+{
+    return *this;
+}
+
+#endif
+
+}
+}
+
+#endif // UES_PF_SEARCH_STATISTICS_H
@@ -0,0 +1,186 @@
+/*
+ * Copyright 2015-2017 Guillermo Frontera <guillermo.frontera@upm.es>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include "augmented_visibility_graph.h"
+
+#include <exc/exception.h>
+
+using namespace ues::pf;
+
+
+template<unsigned short N>
+augmented_visibility_graph<N>::augmented_visibility_graph ( std::shared_ptr< const visibility_graph<N> > base )
+    : base ( std::move ( base ) ),
+      base_size ( 0 )
+{
+    if ( this->base.get() == nullptr )
+        throw ues::exc::exception ( "Provided graph cannot be null", UES_CONTEXT );
+
+    base_size = this->base->size();
+}
+
+
+template<unsigned short N>
+typename augmented_visibility_graph<N>::size_type augmented_visibility_graph<N>::add_point ( const ues::geom::point<N> & point )
+{
+    added_points.push_back ( point );
+    return base_size + added_points.size() - 1;
+}
+
+
+template<unsigned short N>
+void augmented_visibility_graph<N>::add_visibility ( size_type point1_index,
+                                                     size_type point2_index,
+                                                     ues::math::numeric_type distance )
+{
+    if ( point1_index >= size() || point2_index >= size() )
+        throw ues::exc::exception ( "Point index out of the visibility graph", UES_CONTEXT );
+
+    added_edges[point1_index].push_back ( { point2_index, distance } );
+    added_edges[point2_index].push_back ( { point1_index, distance } );
+}
+
+
+template<unsigned short N>
+typename augmented_visibility_graph<N>::size_type augmented_visibility_graph<N>::size() const noexcept
+{
+    return base_size + added_points.size();
+}
+
+
+template<unsigned short N>
+void augmented_visibility_graph<N>::describe ( std::ostream & out ) const noexcept
+{
+    out << "Graph of " << base_size << " points, with added points:\n";
+    for ( size_type i = 0; i < added_points.size(); ++i )
+    {
+        out << '\t' << base_size + i << '\t' << added_points[i] << '\n';
+    }
+    out << "Added edges:\n";
+    for ( const std::pair< const size_type, edge_vector > & point_edges : added_edges )
+    {
+        for ( const std::pair< size_type, ues::math::numeric_type > & e : point_edges.second )
+        {
+            out << '\t' << point_edges.first << '\t' << e.first << '\t' << e.second << '\n';
+        }
+    }
+}
+
+
+template<unsigned short N>
+typename augmented_visibility_graph<N>::size_type augmented_visibility_graph<N>::point_to_index ( const ues::geom::point<N> & point ) const
+{
+    for ( size_type i = 0; i < added_points.size(); ++i )
+    {
+        if ( added_points[i] == point )
+            return base_size + i;
+    }
+    return base->point_to_index ( point );
+}
+
+
+template<unsigned short N>
+const ues::geom::point<N> & augmented_visibility_graph<N>::index_to_point ( size_type point_index ) const
+{
+    return point_index < base_size ? base->index_to_point ( point_index ) : added_points.at ( point_index - base_size );
+}
+
+
+template<unsigned short N>
+bool augmented_visibility_graph<N>::check_visibility ( size_type point1_index,
+                                                       size_type point2_index,
+                                                       ues::math::numeric_type & distance ) const
+{
+    auto it = added_edges.find ( point1_index );
+    if ( it != added_edges.end() )
+    {
+        for ( const std::pair< size_type, ues::math::numeric_type > & e : it->second )
+        {
+            if ( e.first == point2_index )
+            {
+                distance = e.second;
+                return true;
+            }
+        }
+    }
+    return point1_index < base_size && point2_index < base_size && base->check_visibility ( point1_index, point2_index, distance );
+}
+
+
+template<unsigned short N>
+void augmented_visibility_graph<N>::visit_adjacents ( size_type point_index, edge_visitor & visitor ) const
+{
+    if ( point_index < base_size )
+        base->visit_adjacents ( point_index, visitor );
+    visit_added_edges ( point_index, visitor );
+}
+
+
+template<unsigned short N>
+void augmented_visibility_graph<N>::visit_candidate_adjacents ( size_type point_index, edge_visitor & visitor ) const
+{
+    if ( point_index < base_size )
+        base->visit_candidate_adjacents ( point_index, visitor );
+    visit_added_edges ( point_index, visitor );
+}
+
+
+template<unsigned short N>
+bool augmented_visibility_graph<N>::validate_candidate ( size_type point1_index, size_type point2_index ) const
+{
+    // The added edges are always valid, and the base graph checks its own.
+    if ( point1_index >= base_size || point2_index >= base_size )
+        return true;
+
+    auto it = added_edges.find ( point1_index );
+    if ( it != added_edges.end() )
+    {
+        for ( const std::pair< size_type, ues::math::numeric_type > & e : it->second )
+        {
+            if ( e.first == point2_index )
+                return true;
+        }
+    }
+    return base->validate_candidate ( point1_index, point2_index );
+}
+
+
+template<unsigned short N>
+void augmented_visibility_graph<N>::prefetch_adjacents ( size_type point_index ) const noexcept
+{
+    if ( point_index < base_size )
+        base->prefetch_adjacents ( point_index );
+}
+
+
+template<unsigned short N>
+void augmented_visibility_graph<N>::visit_added_edges ( size_type point_index, edge_visitor & visitor ) const
+{
+    auto it = added_edges.find ( point_index );
+    if ( it != added_edges.end() )
+    {
+        for ( const std::pair< size_type, ues::math::numeric_type > & e : it->second )
+        {
+            visitor.visit ( e.first, e.second );
+        }
+    }
+}
+
+
+// Instantiate the templates in this translation unit, just once.
+template class ues::pf::augmented_visibility_graph<2>;
+template class ues::pf::augmented_visibility_graph<3>;
@@ -0,0 +1,90 @@
+/*
+ * Copyright 2015-2017 Guillermo Frontera <guillermo.frontera@upm.es>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#ifndef UES_PF_AUGMENTED_VISIBILITY_GRAPH_H
+#define UES_PF_AUGMENTED_VISIBILITY_GRAPH_H
+
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+#include <pf/visibility_graph/visibility_graph.h>
+
+namespace ues
+{
+namespace pf
+{
+
+/** The augmented_visibility_graph class adds a few points and edges to a visibility graph
+ * without modifying or copying it, so a graph built once can be shared by many queries, each
+ * of them adding its own origin and target. */
+template<unsigned short N>
+class augmented_visibility_graph : public visibility_graph<N>
+{
+public:
+    typedef typename visibility_graph<N>::size_type size_type; /**< Type used for point indices. */
+
+    /** Constructor method. The points of the \a base graph keep their indices. */
+    augmented_visibility_graph ( std::shared_ptr< const visibility_graph<N> > base );
+
+    /** Adds a point that is not in the base graph, and returns its index. */
+    size_type add_point ( const ues::geom::point<N> & point );
+
+    /** Adds an edge between the points of indices \a point1_index and \a point2_index, which
+     * may belong to the base graph. */
+    void add_visibility ( size_type point1_index,
+                          size_type point2_index,
+                          ues::math::numeric_type distance );
+
+    /** Returns the number of points in the graph. */
+    size_type size() const noexcept override;
+
+    /** Prints the points and edges added to the base graph to the \a out parameter. */
+    void describe ( std::ostream & out ) const noexcept override;
+
+    /** Reintroduce hidden overloads. */
+    using visibility_graph<N>::check_visibility;
+
+    typedef typename visibility_graph<N>::edge_visitor edge_visitor;
+
+    size_type point_to_index ( const ues::geom::point<N> & point ) const override;
+    const ues::geom::point<N> & index_to_point ( size_type point_index ) const override;
+    bool check_visibility ( size_type point1_index,
+                            size_type point2_index,
+                            ues::math::numeric_type & distance ) const override;
+    void visit_adjacents ( size_type point_index, edge_visitor & visitor ) const override;
+    void visit_candidate_adjacents ( size_type point_index, edge_visitor & visitor ) const override;
+    bool validate_candidate ( size_type point1_index, size_type point2_index ) const override;
+    void prefetch_adjacents ( size_type point_index ) const noexcept override;
+
+private:
+    typedef std::vector< std::pair< size_type, ues::math::numeric_type > > edge_vector;
+
+    std::shared_ptr< const visibility_graph<N> > base;
+    size_type base_size;
+    std::vector< ues::geom::point<N> > added_points;
+    /** Edges added to every point, stored in both endpoints. */
+    std::unordered_map< size_type, edge_vector > added_edges;
+
+    /** Calls the \a visitor for the edges added to the point of index \a point_index. */
+    void visit_added_edges ( size_type point_index, edge_visitor & visitor ) const;
+};
+
+}
+}
+
+#endif // UES_PF_AUGMENTED_VISIBILITY_GRAPH_H
@@ -30,7 +30,7 @@ basic_visibility_graph<N>::basic_visibility_graph() noexcept
 template<unsigned short N>
 basic_visibility_graph<N>::basic_visibility_graph ( size_type number_of_points ) noexcept
     : number_of_points ( number_of_points ),
-      vv ( ( number_of_points == 0 ) ? number_of_points : number_of_points - 1 )
+      vv ( number_of_points )
 {
 }
 
@@ -54,11 +54,8 @@ bool basic_visibility_graph<N>::check_visibility ( size_type point1_index,
     }
 
     // Search for distance information.
-    size_type min_point_index = std::min ( point1_index, point2_index );
-    size_type max_point_index = std::max ( point1_index, point2_index );
-
-    const point_visibility & pv = vv[min_point_index];
-    typename basic_visibility_graph<N>::point_visibility::const_iterator distance_info = pv.find ( max_point_index );
+    const point_visibility & pv = vv[point1_index];
+    typename basic_visibility_graph<N>::point_visibility::const_iterator distance_info = pv.find ( point2_index );
     if ( distance_info != pv.end() )
     {
         // If distance information is found, then both points are visible
@@ -104,11 +101,8 @@ void basic_visibility_graph<N>::add_visibility ( size_type point1_index,
     // is not added.
     if ( point1_index != point2_index )
     {
-        size_type min_point_index = std::min ( point1_index, point2_index );
-        size_type max_point_index = std::max ( point1_index, point2_index );
-
-        point_visibility & pv = vv[min_point_index];
-        pv[ max_point_index ] = distance ;
+        vv[point1_index][point2_index] = distance;
+        vv[point2_index][point1_index] = distance;
     }
 }
 
@@ -119,7 +113,7 @@ void basic_visibility_graph<N>::add_point()
     // Increase the number of points and expand the
     // visibility vector.
     ++number_of_points;
-    vv.resize ( number_of_points - 1 );
+    vv.resize ( number_of_points );
 }
 
 
@@ -130,6 +124,21 @@ typename basic_visibility_graph<N>::size_type basic_visibility_graph<N>::size()
 }
 
 
+template<unsigned short N>
+std::size_t basic_visibility_graph<N>::memory_size() const noexcept
+{
+    std::size_t result = sizeof ( *this ) + vv.capacity() * sizeof ( point_visibility );
+    for ( const point_visibility & visibility : vv )
+    {
+        // Every edge is a node of the hash table, linked to the next one, and every bucket
+        // points to a node.
+        result += visibility.size() * ( sizeof ( typename point_visibility::value_type ) + sizeof ( void * ) ) +
+                  visibility.bucket_count() * sizeof ( void * );
+    }
+    return result;
+}
+
+
 template<unsigned short N>
 void basic_visibility_graph<N>::describe ( std::ostream & out ) const noexcept
 {
@@ -169,36 +178,12 @@ void basic_visibility_graph<N>::describe ( std::ostream & out ) const noexcept
 
 
 template<unsigned short N>
-typename basic_visibility_graph<N>::point_index_vector basic_visibility_graph<N>::adjacents ( size_type point_index ) const
+void basic_visibility_graph<N>::visit_adjacents ( size_type point_index, edge_visitor & visitor ) const
 {
-    point_index_vector result;
-
-    // Adjacent points with index i < point_index are stored at
-    // the visibility_info object corresponding to i (vv[i]).
-    for ( size_type i = 0; i < point_index; ++i )
+    for_each_neighbour ( point_index, [&visitor] ( size_type neighbour_index, ues::math::numeric_type weight )
     {
-        const point_visibility & pv = vv[i];
-        typename point_visibility::const_iterator it = pv.find ( point_index );
-        if ( it != pv.end() )
-        {
-            result.push_back ( i );
-        }
-    }
-
-    // Adjacent points with index i > point_index are stored at the
-    // visibility_info object corresponding to point_index (vv[point_index]).
-    // Note that if point_index == number_of_points - 1, there is no
-    // i > point_index and therefore all the adjacent points have already
-    // been found.
-    if ( point_index < number_of_points - 1 )
-    {
-        for ( auto point_visibility_info : vv[point_index] )
-        {
-            result.push_back ( point_visibility_info.first );
-        }
-    }
-
-    return result;
+        visitor.visit ( neighbour_index, weight );
+    } );
 }
 
 
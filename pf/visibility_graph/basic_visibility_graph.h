@@ -63,43 +63,69 @@ public:
     /** Prints the visibility matrix to the \a out parameter. */
     virtual void describe ( std::ostream & out ) const noexcept override;
 
+    /** Returns an estimate of the bytes of memory used by the edges of the graph. */
+    std::size_t memory_size() const noexcept;
+
+    /** Calls \a fn ( neighbour_index, weight ) for every point visible from the point of index
+     * \a point_index. Unlike the virtual interface, it can be inlined by searches that know the
+     * concrete type of the graph. */
+    template<class F>
+    inline void for_each_neighbour ( size_type point_index, F && fn ) const;
+
     /** Reintroduce hidden overloads. */
     using visibility_graph<N>::check_visibility;
 
+    typedef typename visibility_graph<N>::edge_visitor edge_visitor;
+
+    /** Returns the index assigned to a point. */
+    virtual size_type point_to_index ( const ues::geom::point<N> & point ) const override = 0;
+    /** Returns the point assigned to an index. */
+    virtual const ues::geom::point<N> & index_to_point ( size_type point_index ) const override = 0;
+
+    /** Returns true if the points of indices \a point1_index and \a point2_index are visible
+     * from one another, and false otherwise. If points are visible, the distance between the
+     * points is returned in the variable \a distance. */
+    bool check_visibility ( size_type point1_index,
+                            size_type point2_index,
+                            ues::math::numeric_type & distance ) const override;
+
+    /** Calls the \a visitor for every point visible from the point of index \a point_index,
+     * without allocating any memory. */
+    void visit_adjacents ( size_type point_index, edge_visitor & visitor ) const override;
+
 protected:
     /** Makes room for another point in the graph. */
     void add_point();
 
 private:
-    typedef typename visibility_graph<N>::point_index_vector point_index_vector;
+    /** Visibility of a point, indexed by the visible point. Every edge is stored in both
+     * endpoints, so the neighbours of a point can be iterated directly. */
     typedef std::unordered_map< size_type, ues::math::numeric_type > point_visibility;
     typedef std::vector< point_visibility > visibility_vector;
 
     size_type number_of_points;
     visibility_vector vv;
 
-    /** Returns the index assigned to a point. */
-    virtual size_type point_to_index ( const ues::geom::point<N> & point ) const override = 0;
-    /** Returns the point assigned to an index. */
-    virtual const ues::geom::point<N> & index_to_point ( size_type point_index ) const override = 0;
-
     /** Adds visibility information between points of indices \a point1_index and \a point2_index.
      * The distance between both points is provided in \a distance. */
     void add_visibility ( size_type point1_index,
                           size_type point2_index,
                           ues::math::numeric_type distance );
+};
 
-    /** Returns true if the points of indices \a point1_index and \a point2_index are visible
-     * from one another, and false otherwise. If points are visible, the distance between the
-     * points is returned in the variable \a distance. */
-    bool check_visibility ( size_type point1_index,
-                            size_type point2_index,
-                            ues::math::numeric_type & distance ) const override;
 
-    /** Returns a vector containing all the point indices corresponding to points that are
-     * visible from the point of index \a point_index. */
-    point_index_vector adjacents ( size_type point_index ) const override;
-};
+// Template implementation.
+
+
+template<unsigned short N>
+template<class F>
+void basic_visibility_graph<N>::for_each_neighbour ( size_type point_index, F && fn ) const
+{
+    for ( const std::pair< const size_type, ues::math::numeric_type > & point_visibility_info : vv[point_index] )
+    {
+        fn ( point_visibility_info.first, point_visibility_info.second );
+    }
+}
 
 }
 }
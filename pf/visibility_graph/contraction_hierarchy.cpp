@@ -0,0 +1,645 @@
+/*
+ * Copyright 2015-2017 Guillermo Frontera <guillermo.frontera@upm.es>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include "contraction_hierarchy.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <functional>
+#include <queue>
+
+#include <exc/exception.h>
+#include <log/logger.h>
+#include <misc/binary_io.h>
+
+using namespace ues::pf;
+
+const std::string component_name = "Contraction Hierarchy";
+
+namespace
+{
+
+/** Identifier of the binary format, and its current version. */
+const std::uint32_t FORMAT_MAGIC = 0x48434555; // "UECH"
+const std::uint32_t FORMAT_VERSION = 1;
+
+typedef std::size_t size_type;
+
+/** An edge of the graph being contracted. */
+struct contraction_edge
+{
+    size_type target;
+    ues::math::numeric_type weight;
+    size_type middle;
+};
+
+/** A shortcut that must be added when a point is contracted. */
+struct shortcut
+{
+    size_type from;
+    size_type to;
+    ues::math::numeric_type weight;
+};
+
+typedef std::vector< contraction_edge > contraction_edge_vector;
+typedef std::vector< shortcut > shortcut_vector;
+
+/** Min-priority queue of (distance, point index) pairs. */
+typedef std::pair< ues::math::numeric_type, size_type > queue_entry;
+typedef std::priority_queue< queue_entry, std::vector< queue_entry >, std::greater< queue_entry > > distance_queue;
+
+/** The contractor class holds the remaining graph while points are contracted. */
+class contractor
+{
+public:
+    contractor ( std::vector< contraction_edge_vector > adjacency, size_type witness_search_limit, size_type no_point );
+
+    /** Contracts all the points and returns the upward edges of every point. */
+    std::vector< contraction_edge_vector > contract_all ( size_type & number_of_shortcuts );
+
+private:
+    std::vector< contraction_edge_vector > adjacency;
+    std::vector< bool > contracted;
+    std::vector< int > contracted_neighbours;
+    size_type witness_search_limit;
+    size_type no_point;
+
+    std::unordered_map< size_type, ues::math::numeric_type > witness_distances;
+
+    /** Returns the shortcuts required to contract \a point. */
+    shortcut_vector required_shortcuts ( size_type point );
+
+    /** Computes the distances from \a source to the points around it, without going through
+     * \a excluded or exceeding \a max_distance. */
+    void witness_search ( size_type source, size_type excluded, ues::math::numeric_type max_distance );
+
+    /** Adds an edge, or reduces its weight if it already existed. */
+    void add_edge ( size_type from, size_type to, ues::math::numeric_type weight, size_type middle );
+};
+
+
+contractor::contractor ( std::vector< contraction_edge_vector > adjacency, size_type witness_search_limit, size_type no_point )
+    : adjacency ( std::move ( adjacency ) ),
+      contracted ( this->adjacency.size(), false ),
+      contracted_neighbours ( this->adjacency.size(), 0 ),
+      witness_search_limit ( witness_search_limit ),
+      no_point ( no_point )
+{
+}
+
+
+std::vector< contraction_edge_vector > contractor::contract_all ( size_type & number_of_shortcuts )
+{
+    typedef std::pair< long, size_type > priority_entry;
+    std::priority_queue< priority_entry, std::vector< priority_entry >, std::greater< priority_entry > > order;
+
+    // The priority of a point is its edge difference (the shortcuts it requires minus the edges
+    // it removes) plus the number of neighbours already contracted, which spreads contractions
+    // uniformly over the graph.
+    auto priority = [&] ( size_type point, const shortcut_vector & shortcuts )
+    {
+        long removed_edges = 0;
+        for ( const contraction_edge & e : adjacency[point] )
+        {
+            if ( !contracted[e.target] )
+                ++removed_edges;
+        }
+        return static_cast<long> ( shortcuts.size() ) - removed_edges + contracted_neighbours[point];
+    };
+
+    for ( size_type point = 0; point < adjacency.size(); ++point )
+    {
+        order.push ( { priority ( point, required_shortcuts ( point ) ), point } );
+    }
+
+    std::vector< contraction_edge_vector > upward ( adjacency.size() );
+    number_of_shortcuts = 0;
+
+    while ( !order.empty() )
+    {
+        size_type point = order.top().second;
+        order.pop();
+
+        // Priorities are updated lazily: if the point is no longer the least important one, it
+        // is reinserted with its current priority.
+        shortcut_vector shortcuts = required_shortcuts ( point );
+        long current_priority = priority ( point, shortcuts );
+        if ( !order.empty() && current_priority > order.top().first )
+        {
+            order.push ( { current_priority, point } );
+            continue;
+        }
+
+        // The edges to the remaining points are the upward edges of the contracted point.
+        for ( const contraction_edge & e : adjacency[point] )
+        {
+            if ( !contracted[e.target] )
+            {
+                upward[point].push_back ( e );
+                ++contracted_neighbours[e.target];
+            }
+        }
+
+        for ( const shortcut & s : shortcuts )
+        {
+            add_edge ( s.from, s.to, s.weight, point );
+            add_edge ( s.to, s.from, s.weight, point );
+        }
+        number_of_shortcuts += shortcuts.size();
+
+        contracted[point] = true;
+        contraction_edge_vector().swap ( adjacency[point] );
+    }
+
+    return upward;
+}
+
+
+shortcut_vector contractor::required_shortcuts ( size_type point )
+{
+    shortcut_vector result;
+
+    std::vector< const contraction_edge * > neighbours;
+    ues::math::numeric_type max_weight = 0;
+    for ( const contraction_edge & e : adjacency[point] )
+    {
+        if ( !contracted[e.target] )
+        {
+            neighbours.push_back ( &e );
+            max_weight = std::max ( max_weight, e.weight );
+        }
+    }
+
+    for ( std::size_t i = 0; i < neighbours.size(); ++i )
+    {
+        const contraction_edge & in = *neighbours[i];
+        witness_search ( in.target, point, in.weight + max_weight );
+
+        for ( std::size_t j = i + 1; j < neighbours.size(); ++j )
+        {
+            const contraction_edge & out = *neighbours[j];
+            ues::math::numeric_type via_point = in.weight + out.weight;
+
+            // A shortcut is needed only if there is no other path as short as the one through
+            // the contracted point.
+            auto witness = witness_distances.find ( out.target );
+            if ( witness == witness_distances.end() || witness->second > via_point )
+            {
+                result.push_back ( { in.target, out.target, via_point } );
+            }
+        }
+    }
+
+    return result;
+}
+
+
+void contractor::witness_search ( size_type source, size_type excluded, ues::math::numeric_type max_distance )
+{
+    witness_distances.clear();
+    witness_distances[source] = 0;
+
+    distance_queue frontier;
+    frontier.push ( { 0, source } );
+    size_type settled = 0;
+
+    while ( !frontier.empty() )
+    {
+        queue_entry entry = frontier.top();
+        frontier.pop();
+
+        if ( entry.first > witness_distances[entry.second] )
+            continue;
+        if ( entry.first > max_distance || settled++ >= witness_search_limit )
+            break;
+
+        for ( const contraction_edge & e : adjacency[entry.second] )
+        {
+            if ( contracted[e.target] || e.target == excluded )
+                continue;
+
+            ues::math::numeric_type distance = entry.first + e.weight;
+            auto it = witness_distances.find ( e.target );
+            if ( it == witness_distances.end() || distance < it->second )
+            {
+                witness_distances[e.target] = distance;
+                frontier.push ( { distance, e.target } );
+            }
+        }
+    }
+}
+
+
+void contractor::add_edge ( size_type from, size_type to, ues::math::numeric_type weight, size_type middle )
+{
+    for ( contraction_edge & e : adjacency[from] )
+    {
+        if ( e.target == to )
+        {
+            if ( weight < e.weight )
+            {
+                e.weight = weight;
+                e.middle = middle;
+            }
+            return;
+        }
+    }
+    adjacency[from].push_back ( { to, weight, middle } );
+}
+
+}
+
+
+template<unsigned short N>
+const typename contraction_hierarchy<N>::size_type contraction_hierarchy<N>::WITNESS_SEARCH_LIMIT = 500;
+
+template<unsigned short N>
+const typename contraction_hierarchy<N>::size_type contraction_hierarchy<N>::NO_POINT = std::numeric_limits<size_type>::max();
+
+
+template<unsigned short N>
+contraction_hierarchy<N>::contraction_hierarchy() noexcept
+    : shortcuts ( 0 )
+{
+}
+
+
+template<unsigned short N>
+contraction_hierarchy<N>::contraction_hierarchy ( const visibility_graph<N> & graph )
+    : shortcuts ( 0 )
+{
+    // Copy the points and edges of the graph.
+    std::vector< contraction_edge_vector > adjacency ( graph.size() );
+    points.reserve ( graph.size() );
+    for ( size_type i = 0; i < graph.size(); ++i )
+    {
+        points.push_back ( graph.index_to_point ( i ) );
+        point_indices.insert ( { points.back(), i } );
+        graph.for_each_adjacent ( i, [&] ( size_type neighbour, ues::math::numeric_type weight )
+        {
+            adjacency[i].push_back ( { neighbour, weight, NO_POINT } );
+        } );
+    }
+
+    // Contract the points and store the resulting upward edges contiguously.
+    contractor c ( std::move ( adjacency ), WITNESS_SEARCH_LIMIT, NO_POINT );
+    std::vector< contraction_edge_vector > upward = c.contract_all ( shortcuts );
+
+    offsets.reserve ( points.size() + 1 );
+    offsets.push_back ( 0 );
+    for ( const contraction_edge_vector & point_edges : upward )
+    {
+        for ( const contraction_edge & e : point_edges )
+        {
+            edges.push_back ( { e.target, e.weight, e.middle } );
+        }
+        offsets.push_back ( edges.size() );
+    }
+
+    ues::log::logger lg;
+    if ( lg.min_level() <= ues::log::DEBUG_LVL )
+    {
+        ues::log::event e ( ues::log::DEBUG_LVL, component_name, "Built contraction hierarchy" );
+        e.message() << points.size() << " points, " << edges.size() << " upward edges, " << shortcuts << " shortcuts\n";
+        lg.record ( std::move ( e ) );
+    }
+}
+
+
+template<unsigned short N>
+typename contraction_hierarchy<N>::size_type contraction_hierarchy<N>::size() const noexcept
+{
+    return points.size();
+}
+
+
+template<unsigned short N>
+typename contraction_hierarchy<N>::size_type contraction_hierarchy<N>::number_of_shortcuts() const noexcept
+{
+    return shortcuts;
+}
+
+
+template<unsigned short N>
+path<N> contraction_hierarchy<N>::find_path ( const ues::geom::point<N> & origin,
+                                              const ues::geom::point<N> & target ) const
+{
+    index_vector indices = search ( { { point_to_index ( origin ), 0 } }, { { point_to_index ( target ), 0 } } );
+
+    path<N> result;
+    result.reserve ( indices.size() );
+    for ( size_type i : indices )
+    {
+        result.push_back ( points[i] );
+    }
+    return result;
+}
+
+
+template<unsigned short N>
+path<N> contraction_hierarchy<N>::find_path ( const point_visibility<N> & obstacles,
+                                              const ues::geom::point<N> & origin,
+                                              const ues::geom::point<N> & target ) const
+{
+    const bool free_origin = point_indices.find ( origin ) == point_indices.end();
+    const bool free_target = point_indices.find ( target ) == point_indices.end();
+
+    // The search only goes through the hierarchy, so the direct segment between two free
+    // points is checked first.
+    if ( free_origin && free_target && obstacles.check_visibility ( origin, target ) )
+        return path<N> { origin, target };
+
+    index_vector indices = search ( attach ( obstacles, origin ), attach ( obstacles, target ) );
+
+    path<N> result;
+    result.reserve ( indices.size() + 2 );
+    if ( free_origin )
+        result.push_back ( origin );
+    for ( size_type i : indices )
+    {
+        result.push_back ( points[i] );
+    }
+    if ( free_target )
+        result.push_back ( target );
+    return result;
+}
+
+
+template<unsigned short N>
+typename contraction_hierarchy<N>::index_vector contraction_hierarchy<N>::search ( const attachment_vector & sources,
+                                                                                   const attachment_vector & targets ) const
+{
+    /** Distance to a point and the upward edge it has been reached from. */
+    struct label
+    {
+        ues::math::numeric_type distance;
+        size_type parent;
+        size_type middle;
+    };
+    typedef std::unordered_map< size_type, label > label_map;
+
+    label_map labels[2];
+    distance_queue frontiers[2];
+    const attachment_vector * initial[2] = { &sources, &targets };
+
+    for ( unsigned int direction = 0; direction < 2; ++direction )
+    {
+        for ( const attachment & a : *initial[direction] )
+        {
+            auto it = labels[direction].find ( a.first );
+            if ( it == labels[direction].end() || a.second < it->second.distance )
+            {
+                labels[direction][a.first] = { a.second, NO_POINT, NO_POINT };
+                frontiers[direction].push ( { a.second, a.first } );
+            }
+        }
+    }
+
+    // Both searches only follow upward edges, and they meet at the most important point of the
+    // shortest path. A search can stop once its next point is farther than the best path found.
+    ues::math::numeric_type best_distance = std::numeric_limits<ues::math::numeric_type>::infinity();
+    size_type meeting_point = NO_POINT;
+    unsigned int direction = 1;
+
+    while ( true )
+    {
+        for ( unsigned int d = 0; d < 2; ++d )
+        {
+            if ( !frontiers[d].empty() && frontiers[d].top().first >= best_distance )
+                frontiers[d] = distance_queue();
+        }
+        if ( frontiers[0].empty() && frontiers[1].empty() )
+            break;
+
+        direction = frontiers[1 - direction].empty() ? direction : 1 - direction;
+
+        queue_entry entry = frontiers[direction].top();
+        frontiers[direction].pop();
+        if ( entry.first > labels[direction][entry.second].distance )
+            continue;
+
+        auto other = labels[1 - direction].find ( entry.second );
+        if ( other != labels[1 - direction].end() && entry.first + other->second.distance < best_distance )
+        {
+            best_distance = entry.first + other->second.distance;
+            meeting_point = entry.second;
+        }
+
+        for ( size_type i = offsets[entry.second]; i < offsets[entry.second + 1]; ++i )
+        {
+            const upward_edge & e = edges[i];
+            ues::math::numeric_type distance = entry.first + e.weight;
+            auto it = labels[direction].find ( e.target );
+            if ( it == labels[direction].end() || distance < it->second.distance )
+            {
+                labels[direction][e.target] = { distance, entry.second, e.middle };
+                frontiers[direction].push ( { distance, e.target } );
+            }
+        }
+    }
+
+    if ( meeting_point == NO_POINT )
+        throw ues::exc::exception ( "Unable to find a path between points", UES_CONTEXT );
+
+    // Walk back from the meeting point to the origin, and then to the target, unpacking the
+    // shortcuts found on the way.
+    index_vector upward_chain;
+    for ( size_type p = meeting_point; p != NO_POINT; p = labels[0][p].parent )
+    {
+        upward_chain.push_back ( p );
+    }
+    std::reverse ( upward_chain.begin(), upward_chain.end() );
+
+    index_vector result { upward_chain.front() };
+    for ( std::size_t i = 1; i < upward_chain.size(); ++i )
+    {
+        unpack_edge ( upward_chain[i - 1], upward_chain[i], labels[0][upward_chain[i]].middle, result );
+    }
+    for ( size_type p = meeting_point; labels[1][p].parent != NO_POINT; p = labels[1][p].parent )
+    {
+        unpack_edge ( p, labels[1][p].parent, labels[1][p].middle, result );
+    }
+
+    return result;
+}
+
+
+template<unsigned short N>
+void contraction_hierarchy<N>::unpack_edge ( size_type from, size_type to, size_type middle, index_vector & result ) const
+{
+    if ( middle == NO_POINT )
+    {
+        result.push_back ( to );
+    }
+    else
+    {
+        // The skipped point is less important than both ends, so it has upward edges to them.
+        unpack_edge ( from, middle, find_upward_edge ( middle, from ).middle, result );
+        unpack_edge ( middle, to, find_upward_edge ( middle, to ).middle, result );
+    }
+}
+
+
+template<unsigned short N>
+const typename contraction_hierarchy<N>::upward_edge & contraction_hierarchy<N>::find_upward_edge ( size_type from, size_type to ) const
+{
+    for ( size_type i = offsets[from]; i < offsets[from + 1]; ++i )
+    {
+        if ( edges[i].target == to )
+            return edges[i];
+    }
+    throw ues::exc::exception ( "Corrupted contraction hierarchy", UES_CONTEXT );
+}
+
+
+template<unsigned short N>
+typename contraction_hierarchy<N>::size_type contraction_hierarchy<N>::point_to_index ( const ues::geom::point<N> & point ) const
+{
+    auto it = point_indices.find ( point );
+    if ( it != point_indices.end() )
+    {
+        return it->second;
+    }
+    throw ues::exc::exception ( "Point not found in contraction hierarchy", UES_CONTEXT );
+}
+
+
+template<unsigned short N>
+typename contraction_hierarchy<N>::attachment_vector contraction_hierarchy<N>::attach ( const point_visibility<N> & obstacles,
+                                                                                        const ues::geom::point<N> & point ) const
+{
+    typename point_map::const_iterator it = point_indices.find ( point );
+    if ( it != point_indices.end() )
+        return { { it->second, 0 } };
+
+    // Vertices of the obstacles that are not in the hierarchy, if any, are skipped.
+    typename point_visibility<N>::point_vector visible;
+    obstacles.visible_vertices ( point, visible );
+    attachment_vector result;
+    for ( const ues::geom::point<N> & v : visible )
+    {
+        it = point_indices.find ( v );
+        if ( it != point_indices.end() )
+            result.push_back ( { it->second, point.distance_to ( v ) } );
+    }
+    return result;
+}
+
+
+template<unsigned short N>
+void contraction_hierarchy<N>::save ( std::ostream & out ) const
+{
+    using ues::misc::write_binary;
+
+    write_binary ( out, FORMAT_MAGIC );
+    write_binary ( out, FORMAT_VERSION );
+    write_binary ( out, static_cast<std::uint32_t> ( N ) );
+    write_binary ( out, static_cast<std::uint64_t> ( shortcuts ) );
+
+    std::vector< double > coordinates;
+    coordinates.reserve ( points.size() * N );
+    for ( const ues::geom::point<N> & p : points )
+    {
+        for ( unsigned short i = 0; i < N; ++i )
+        {
+            coordinates.push_back ( p.get ( i ) );
+        }
+    }
+    write_binary ( out, coordinates );
+
+    std::vector< std::uint64_t > edge_offsets ( offsets.begin(), offsets.end() );
+    std::vector< std::uint64_t > targets, middles;
+    std::vector< double > weights;
+    for ( const upward_edge & e : edges )
+    {
+        targets.push_back ( e.target );
+        weights.push_back ( e.weight );
+        middles.push_back ( e.middle == NO_POINT ? std::numeric_limits<std::uint64_t>::max() : e.middle );
+    }
+    write_binary ( out, edge_offsets );
+    write_binary ( out, targets );
+    write_binary ( out, weights );
+    write_binary ( out, middles );
+}
+
+
+template<unsigned short N>
+contraction_hierarchy<N> contraction_hierarchy<N>::load ( std::istream & in )
+{
+    using ues::misc::read_binary;
+
+    std::uint32_t magic, version, dimension;
+    read_binary ( in, magic );
+    read_binary ( in, version );
+    read_binary ( in, dimension );
+    if ( magic != FORMAT_MAGIC || version != FORMAT_VERSION || dimension != N )
+        throw ues::exc::exception ( "Unsupported contraction hierarchy format", UES_CONTEXT );
+
+    contraction_hierarchy<N> result;
+
+    std::uint64_t shortcuts;
+    read_binary ( in, shortcuts );
+    result.shortcuts = shortcuts;
+
+    std::vector< double > coordinates;
+    read_binary ( in, coordinates );
+    if ( coordinates.size() % N != 0 )
+        throw ues::exc::exception ( "Corrupted contraction hierarchy", UES_CONTEXT );
+    for ( std::size_t i = 0; i < coordinates.size(); i += N )
+    {
+        ues::geom::point<N> p;
+        for ( unsigned short j = 0; j < N; ++j )
+        {
+            p.set ( j, coordinates[i + j] );
+        }
+        result.point_indices.insert ( { p, result.points.size() } );
+        result.points.push_back ( std::move ( p ) );
+    }
+
+    std::vector< std::uint64_t > edge_offsets, targets, middles;
+    std::vector< double > weights;
+    read_binary ( in, edge_offsets );
+    read_binary ( in, targets );
+    read_binary ( in, weights );
+    read_binary ( in, middles );
+    if ( edge_offsets.size() != result.points.size() + 1 || edge_offsets.front() != 0 || edge_offsets.back() != targets.size() ||
+            weights.size() != targets.size() || middles.size() != targets.size() )
+        throw ues::exc::exception ( "Corrupted contraction hierarchy", UES_CONTEXT );
+
+    // Searches index the edges with the offsets and the points with the ends of the edges, so
+    // both are checked here instead of in every query.
+    if ( !std::is_sorted ( edge_offsets.begin(), edge_offsets.end() ) )
+        throw ues::exc::exception ( "Corrupted contraction hierarchy", UES_CONTEXT );
+
+    result.offsets.assign ( edge_offsets.begin(), edge_offsets.end() );
+    result.edges.reserve ( targets.size() );
+    for ( std::size_t i = 0; i < targets.size(); ++i )
+    {
+        const bool shortcut = middles[i] != std::numeric_limits<std::uint64_t>::max();
+        if ( targets[i] >= result.points.size() || ( shortcut && middles[i] >= result.points.size() ) )
+            throw ues::exc::exception ( "Corrupted contraction hierarchy", UES_CONTEXT );
+        size_type middle = shortcut ? middles[i] : NO_POINT;
+        result.edges.push_back ( { targets[i], weights[i], middle } );
+    }
+
+    return result;
+}
+
+
+// Instantiate the templates in this translation unit, just once.
+template class ues::pf::contraction_hierarchy<2>;
+template class ues::pf::contraction_hierarchy<3>;
@@ -0,0 +1,139 @@
+/*
+ * Copyright 2015-2017 Guillermo Frontera <guillermo.frontera@upm.es>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#ifndef UES_PF_CONTRACTION_HIERARCHY_H
+#define UES_PF_CONTRACTION_HIERARCHY_H
+
+#include <istream>
+#include <limits>
+#include <ostream>
+#include <unordered_map>
+#include <vector>
+
+#include <pf/path.h>
+#include <pf/visibility_graph/point_visibility.h>
+#include <pf/visibility_graph/visibility_graph.h>
+
+namespace ues
+{
+namespace pf
+{
+
+/** The contraction_hierarchy class preprocesses a visibility graph that is not going to change,
+ * so shortest paths between its points can be found exploring a tiny part of the graph. Points
+ * are contracted in order of importance, adding shortcut edges that preserve the distances of
+ * the remaining points, and queries run a bidirectional search that only follows edges towards
+ * more important points. */
+template<unsigned short N>
+class contraction_hierarchy
+{
+public:
+    typedef typename visibility_graph<N>::size_type size_type; /**< Type used for point indices. */
+
+    /** Maximum number of points settled by every witness search during the preprocessing.
+     * Lower values make the preprocessing faster, but add unnecessary shortcuts. */
+    static const size_type WITNESS_SEARCH_LIMIT;
+
+    /** \name Constructor methods */
+    /** \{ */
+
+    /** Builds the contraction hierarchy of a \a graph. */
+    contraction_hierarchy ( const visibility_graph<N> & graph );
+
+    /** \} */
+
+    /** Returns the number of points in the hierarchy. */
+    size_type size() const noexcept;
+
+    /** Returns the number of shortcut edges added by the preprocessing. */
+    size_type number_of_shortcuts() const noexcept;
+
+    /** Finds the shortest path between two points of the graph. */
+    path<N> find_path ( const ues::geom::point<N> & origin,
+                        const ues::geom::point<N> & target ) const;
+
+    /** Finds the shortest path between two points among the \a obstacles the graph was built
+     * from. Points that are not in the hierarchy are attached to the points of it they see. */
+    path<N> find_path ( const point_visibility<N> & obstacles,
+                        const ues::geom::point<N> & origin,
+                        const ues::geom::point<N> & target ) const;
+
+    /** Writes the hierarchy to \a out in a binary format. */
+    void save ( std::ostream & out ) const;
+
+    /** Reads a hierarchy written with save. */
+    static contraction_hierarchy load ( std::istream & in );
+
+private:
+    /** The upward_edge type links a point with a more important one. If the edge is a shortcut,
+     * \a middle is the point it skips, and otherwise it is NO_POINT. */
+    struct upward_edge
+    {
+        size_type target;
+        ues::math::numeric_type weight;
+        size_type middle;
+    };
+
+    /** A point of the hierarchy visible from a point outside of it, together with the
+     * distance between both points. */
+    typedef std::pair< size_type, ues::math::numeric_type > attachment;
+    typedef std::vector< attachment > attachment_vector;
+
+    typedef std::vector< upward_edge > edge_vector;
+    typedef std::vector< size_type > offset_vector;
+    typedef std::vector< ues::geom::point<N> > point_vector;
+    typedef std::unordered_map< ues::geom::point<N>, size_type > point_map;
+    typedef std::vector< size_type > index_vector;
+
+    static const size_type NO_POINT;
+
+    point_vector points;
+    point_map point_indices;
+    /** Upward edges of every point, stored contiguously. The edges of point i are in the range
+     * [offsets[i], offsets[i + 1]). */
+    offset_vector offsets;
+    edge_vector edges;
+    size_type shortcuts;
+
+    /** Constructor used when loading a hierarchy. */
+    contraction_hierarchy() noexcept;
+
+    /** Returns the point index of a point of the graph. */
+    size_type point_to_index ( const ues::geom::point<N> & point ) const;
+
+    /** Returns the points of the hierarchy a \a point is attached to: itself if it belongs to
+     * the hierarchy, or the ones it sees among the \a obstacles otherwise. */
+    attachment_vector attach ( const point_visibility<N> & obstacles,
+                               const ues::geom::point<N> & point ) const;
+
+    /** Runs the bidirectional upward search from the \a sources to the \a targets and returns
+     * the sequence of point indices of the shortest path. */
+    index_vector search ( const attachment_vector & sources,
+                          const attachment_vector & targets ) const;
+
+    /** Appends to \a result the points of the edge from \a from to \a to, excluding \a from, and
+     * replacing shortcuts by the edges they represent. */
+    void unpack_edge ( size_type from, size_type to, size_type middle, index_vector & result ) const;
+
+    /** Returns the upward edge of \a from that reaches \a to. */
+    const upward_edge & find_upward_edge ( size_type from, size_type to ) const;
+};
+
+}
+}
+
+#endif // UES_PF_CONTRACTION_HIERARCHY_H
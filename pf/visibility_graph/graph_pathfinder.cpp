@@ -17,10 +17,9 @@
 
 #include "graph_pathfinder.h"
 
-#include <unordered_set>
-#include <unordered_map>
-
-#include <boost/heap/fibonacci_heap.hpp>
+#include <algorithm>
+#include <exception>
+#include <limits>
 
 #include <log/logger.h>
 #include <exc/exception.h>
@@ -32,45 +31,49 @@ const std::string component_name = "Pathfinder";
 namespace
 {
 
-/** The state type contains a point index and the estimated cost of such point.*/
-template<unsigned short N>
-struct state
+/** Number of expansions between two checks of the deadline of an anytime search. */
+const std::size_t DEADLINE_CHECK_PERIOD = 64;
+
+/** Situation of a point during an anytime search. */
+enum anytime_status : unsigned char
 {
-    typename visibility_graph<N>::size_type point_index;
-    ues::math::numeric_type accumulated_cost;
-    ues::math::numeric_type estimated_cost;
+    /** Not in any of the lists. */
+    NOT_LISTED,
+    /** In the open list, pending to be expanded. */
+    OPEN,
+    /** Expanded during the current search. */
+    CLOSED,
+    /** Expanded during the current search, but its cost has improved afterwards. It will
+     * be expanded again in the next search. */
+    INCONSISTENT
 };
 
-/** The state_comparator class contains the required comparator method so the
- * states are sorted in the desired order in the priority queue. */
+}
+
+
 template<unsigned short N>
-struct state_comparator
+path<N> graph_pathfinder<N>::find_path ( const ues::geom::point<N> & origin,
+                                         const ues::geom::point<N> & target ) const
 {
-    bool operator() ( const state<N> & one, const state<N> & two ) const noexcept
-    {
-        return one.estimated_cost > two.estimated_cost;
-    }
-};
+    search_workspace<N> workspace;
+    return find_path ( origin, target, workspace );
+}
 
-/** The priority_queue stores and keeps a sorted list of state objects. */
-template<unsigned short N>
-using priority_queue = boost::heap::fibonacci_heap< state<N>, boost::heap::compare< state_comparator<N> > >;
-/** The index_set contains all the points whose cost has already been computed. */
-template<unsigned short N>
-using index_set = std::unordered_set< typename visibility_graph<N>::size_type >;
-/** Stores the handles that allow modifying the states of the priority queue. */
-template<unsigned short N>
-using handle_storage = std::unordered_map< typename visibility_graph<N>::size_type, typename priority_queue<N>::handle_type >;
-/** Stores the point from which current point has been reached. */
-template<unsigned short N>
-using parent_point = std::vector< typename visibility_graph<N>::size_type >;
 
+template<unsigned short N>
+path<N> graph_pathfinder<N>::find_path ( const ues::geom::point<N> & origin,
+                                         const ues::geom::point<N> & target,
+                                         search_workspace<N> & workspace ) const
+{
+    return find_path ( origin, target, workspace, ellipse_bound<N> ( origin, target ) );
 }
 
 
 template<unsigned short N>
 path<N> graph_pathfinder<N>::find_path ( const ues::geom::point<N> & origin,
-                                         const ues::geom::point<N> & target )
+                                         const ues::geom::point<N> & target,
+                                         search_workspace<N> & workspace,
+                                         const ellipse_bound<N> & bound ) const
 {
     ues::log::logger lg;
 
@@ -81,98 +84,361 @@ path<N> graph_pathfinder<N>::find_path ( const ues::geom::point<N> & origin,
         lg.record ( std::move ( e ) );
     }
 
-    // Get indices to the origin and target points.
-    const typename visibility_graph<N>::size_type origin_index = graph->point_to_index ( origin );
-    const typename visibility_graph<N>::size_type target_index = graph->point_to_index ( target );
+    return make_search().find_path ( origin, target, workspace, bound, evaluation == LAZY_EVALUATION );
+}
+
+
+template<unsigned short N>
+typename graph_pathfinder<N>::bounded_path graph_pathfinder<N>::find_path_anytime ( const ues::geom::point<N> & origin,
+                                                                                    const ues::geom::point<N> & target,
+                                                                                    ues::math::numeric_type initial_weight,
+                                                                                    ues::math::numeric_type weight_step,
+                                                                                    const boost::posix_time::ptime & deadline,
+                                                                                    const bounded_path_callback & callback ) const
+{
+    if ( initial_weight < 1 )
+        throw ues::exc::exception ( "Heuristic weight cannot be lower than 1", UES_CONTEXT );
+    if ( weight_step <= 0 )
+        throw ues::exc::exception ( "Heuristic weight step must be positive", UES_CONTEXT );
 
-    // Declare necesary data structures.
-    priority_queue<N> frontier;
-    handle_storage<N> handles;
-    index_set<N> explored;
-    parent_point<N> parents ( graph->size() );
+    const ues::math::numeric_type infinity = std::numeric_limits<ues::math::numeric_type>::infinity();
+    const search_core core = make_search();
+
+    const size_type origin_index = graph->point_to_index ( origin );
+    const size_type target_index = graph->point_to_index ( target );
+    const size_type size = graph->size();
+
+    // The costs, parents and heuristic estimates of the points are kept across the searches,
+    // so each search only expands the points whose cost has improved.
+    std::vector< ues::math::numeric_type > costs ( size, infinity );
+    std::vector< ues::math::numeric_type > estimates ( size, -1 );
+    std::vector< anytime_status > status ( size, NOT_LISTED );
+    typename search_workspace<N>::parent_point parents ( size );
+    typename search_workspace<N>::lazy_priority_queue frontier;
+    typename search_workspace<N>::state_comparator comparator;
+
+    auto heuristic = [&] ( size_type p )
+    {
+        if ( estimates[p] < 0 )
+        {
+            estimates[p] = core.estimate ( p, target, target_index );
+        }
+        return estimates[p];
+    };
+
+    // Weighted A* search which stops as soon as no point of the open list may improve the
+    // path to the target. Returns false if the deadline is reached first.
+    auto improve_path = [&] ( ues::math::numeric_type weight )
+    {
+        std::size_t expansions = 0;
+        while ( !frontier.empty() )
+        {
+            const typename search_workspace<N>::lazy_state & top = frontier.front();
+
+            // Entries of points that have been reached through a cheaper path are outdated.
+            if ( status[ top.point_index ] != OPEN || top.accumulated_cost != costs[ top.point_index ] )
+            {
+                std::pop_heap ( frontier.begin(), frontier.end(), comparator );
+                frontier.pop_back();
+                continue;
+            }
+
+            if ( costs[ target_index ] <= top.estimated_cost )
+            {
+                return true;
+            }
+
+            if ( ++expansions % DEADLINE_CHECK_PERIOD == 0
+                    && boost::posix_time::microsec_clock::universal_time() >= deadline )
+            {
+                return false;
+            }
+
+            const size_type current = top.point_index;
+            std::pop_heap ( frontier.begin(), frontier.end(), comparator );
+            frontier.pop_back();
+            status[ current ] = CLOSED;
+
+            graph->for_each_adjacent ( current, [&] ( size_type p, ues::math::numeric_type last_edge )
+            {
+                const ues::math::numeric_type cost = costs[ current ] + last_edge;
+                if ( cost < costs[p] )
+                {
+                    costs[p] = cost;
+                    parents[p] = current;
+                    if ( status[p] == CLOSED || status[p] == INCONSISTENT )
+                    {
+                        status[p] = INCONSISTENT;
+                    }
+                    else
+                    {
+                        status[p] = OPEN;
+                        frontier.push_back ( { p, current, cost, cost + weight * heuristic ( p ) } );
+                        std::push_heap ( frontier.begin(), frontier.end(), comparator );
+                    }
+                }
+            } );
+        }
+        return true;
+    };
+
+    // Proven bound of the current path: no path may be cheaper than the lowest unweighted
+    // estimate among the points pending to be expanded.
+    auto suboptimality_bound = [&] ( ues::math::numeric_type weight )
+    {
+        ues::math::numeric_type lower_bound = infinity;
+        for ( size_type p = 0; p < size; ++p )
+        {
+            if ( status[p] == OPEN || status[p] == INCONSISTENT )
+            {
+                lower_bound = std::min ( lower_bound, costs[p] + heuristic ( p ) );
+            }
+        }
+        const ues::math::numeric_type cost = costs[ target_index ];
+        if ( lower_bound >= cost )
+        {
+            return ues::math::numeric_type ( 1 );
+        }
+        return std::max ( ues::math::numeric_type ( 1 ), std::min ( weight, cost / lower_bound ) );
+    };
+
+    costs[ origin_index ] = 0;
     parents[ origin_index ] = origin_index;
+    status[ origin_index ] = OPEN;
+    frontier.push_back ( { origin_index, origin_index, 0, initial_weight * heuristic ( origin_index ) } );
 
-    // Add initial node to the priority queue.
-    typename priority_queue<N>::handle_type handle = frontier.push ( { origin_index, 0, origin.distance_to ( target ) } );
-    handles.insert ( { origin_index, handle } );
+    bounded_path result;
+    bool found = false;
+    ues::math::numeric_type weight = initial_weight;
 
-    while ( !frontier.empty() )
+    while ( improve_path ( weight ) )
     {
-        state<N> node = frontier.top();
-        frontier.pop();
-        handles.erase ( node.point_index );
+        if ( costs[ target_index ] == infinity )
+        {
+            throw ues::exc::exception ( "Unable to find a path between points", UES_CONTEXT );
+        }
 
-        if ( node.point_index == target_index )
+        const ues::math::numeric_type bound = suboptimality_bound ( weight );
+        if ( !found || costs[ target_index ] < result.cost || bound < result.suboptimality_bound )
         {
-            path<N> reverse_result;
-            typename visibility_graph<N>::size_type current_point = target_index;
-            while ( current_point != parents[ current_point ] )
+            result.points = core.reconstruct_path ( origin, target_index, costs[ target_index ], parents );
+            result.cost = costs[ target_index ];
+            result.suboptimality_bound = bound;
+            found = true;
+            if ( callback )
             {
-                reverse_result.push_back ( graph->index_to_point ( current_point ) );
-                current_point = parents[ current_point ];
+                callback ( result );
             }
-            reverse_result.push_back ( origin );
-            path<N> result ( reverse_result.rbegin(), reverse_result.rend() );
+        }
 
-            if ( lg.min_level() <= ues::log::DEBUG_LVL )
+        if ( result.suboptimality_bound <= 1
+                || boost::posix_time::microsec_clock::universal_time() >= deadline )
+        {
+            break;
+        }
+
+        // Decrease the weight and move the inconsistent points to the open list, so the next
+        // search only revisits the points whose cost has improved.
+        weight = std::max ( ues::math::numeric_type ( 1 ), weight - weight_step );
+        frontier.clear();
+        for ( size_type p = 0; p < size; ++p )
+        {
+            if ( status[p] == OPEN || status[p] == INCONSISTENT )
+            {
+                status[p] = OPEN;
+                frontier.push_back ( { p, parents[p], costs[p], costs[p] + weight * heuristic ( p ) } );
+            }
+            else if ( status[p] == CLOSED )
             {
-                ues::log::event e ( ues::log::DEBUG_LVL, component_name, "Found path" );
-                e.message() << "Cost of the path: " << node.accumulated_cost << '\n';
-                e.message() << result << '\n';
-                lg.record ( std::move ( e ) );
+                status[p] = NOT_LISTED;
             }
+        }
+        std::make_heap ( frontier.begin(), frontier.end(), comparator );
+    }
+
+    if ( !found )
+        throw ues::exc::exception ( "Unable to find a path before the deadline", UES_CONTEXT );
+
+    return result;
+}
+
+
+template<unsigned short N>
+typename graph_pathfinder<N>::path_vector graph_pathfinder<N>::find_paths ( const query_vector & queries,
+                                                                            unsigned int number_of_threads ) const
+{
+    ues::misc::thread_pool pool ( number_of_threads );
+    return find_paths ( queries, pool );
+}
+
+
+template<unsigned short N>
+typename graph_pathfinder<N>::path_vector graph_pathfinder<N>::find_paths ( const query_vector & queries,
+                                                                            ues::misc::thread_pool & pool ) const
+{
+    // Each worker reuses its own workspace for all the queries it runs, while the graph is
+    // only read, so no synchronization is needed besides the task distribution of the pool.
+    std::vector< search_workspace<N> > workspaces ( pool.size() );
+    path_vector result ( queries.size() );
+
+    pool.run ( queries.size(), [&] ( std::size_t i, unsigned int worker )
+    {
+        result[i] = find_path ( queries[i].first, queries[i].second, workspaces[worker] );
+    } );
+
+    return result;
+}
+
+
+template<unsigned short N>
+typename graph_pathfinder<N>::path_vector graph_pathfinder<N>::find_paths_interleaved ( const query_vector & queries,
+                                                                                        unsigned int interleaving ) const
+{
+    if ( interleaving == 0 )
+        throw ues::exc::exception ( "At least one search must be run at a time", UES_CONTEXT );
 
-            return std::move ( result );
+    const search_core core = make_search();
+    const std::size_t number_of_slots = std::min<std::size_t> ( interleaving, queries.size() );
+    std::vector< search_workspace<N> > workspaces ( number_of_slots );
+    std::vector< typename search_core::eager_search > searches ( number_of_slots );
+    std::vector< std::size_t > slot_queries ( number_of_slots );
+    path_vector result ( queries.size() );
+    std::exception_ptr first_error;
+    std::size_t next_query = 0;
+
+    // Starts the next pending query in a slot. Returns false if no query is left.
+    auto start_next_query = [&] ( std::size_t slot )
+    {
+        while ( next_query < queries.size() )
+        {
+            const std::size_t q = next_query++;
+            try
+            {
+                const size_type origin_index = graph->point_to_index ( queries[q].first );
+                const size_type target_index = graph->point_to_index ( queries[q].second );
+                workspaces[slot].reset ( graph->size() );
+                searches[slot] = { &queries[q].second, target_index, &workspaces[slot],
+                                   std::numeric_limits<ues::math::numeric_type>::infinity(), false, 0 };
+                core.start_eager ( searches[slot], origin_index );
+                slot_queries[slot] = q;
+                return true;
+            }
+            catch ( ... )
+            {
+                if ( !first_error )
+                    first_error = std::current_exception();
+            }
         }
+        return false;
+    };
 
-        explored.insert ( node.point_index );
+    std::vector< std::size_t > active_slots;
+    for ( std::size_t slot = 0; slot < number_of_slots; ++slot )
+    {
+        if ( start_next_query ( slot ) )
+            active_slots.push_back ( slot );
+    }
 
-        for ( typename visibility_graph<N>::size_type p : graph->adjacents ( node.point_index ) )
+    while ( !active_slots.empty() )
+    {
+        std::size_t k = 0;
+        while ( k < active_slots.size() )
         {
-            if ( explored.find ( p ) == explored.end() )
+            const std::size_t slot = active_slots[k];
+            typename search_core::eager_search & search = searches[slot];
+
+            if ( !core.expand_eager ( search ) )
             {
-                // Get the cost of the edge from node.point_index to p.
-                ues::math::numeric_type last_edge;
-                graph->check_visibility ( node.point_index, p, last_edge );
-
-                // Generate a node with the cost of getting to p from node.point_index.
-                state<N> new_node;
-                new_node.point_index = p;
-                new_node.accumulated_cost = node.accumulated_cost + last_edge;
-                ues::math::numeric_type heuristic_cost = graph->index_to_point ( p ).distance_to ( target );
-                new_node.estimated_cost = new_node.accumulated_cost + heuristic_cost;
-
-                typename handle_storage<N>::const_iterator it = handles.find ( p );
-                if ( it == handles.end() )
-                {
-                    handle = frontier.push ( new_node );
-                    handles.insert ( { p, handle } );
-                    parents[p] = node.point_index;
-                }
-                else if ( new_node.estimated_cost < ( *it->second ).estimated_cost )
+                // The memory of the next expansion is loaded while the other searches run.
+                if ( !workspaces[slot].frontier.empty() )
                 {
-                    ( *it->second ).estimated_cost = new_node.estimated_cost;
-                    ( *it->second ).accumulated_cost = new_node.accumulated_cost;
-                    frontier.decrease ( it->second );
-                    parents[p] = node.point_index;
+                    graph->prefetch_adjacents ( workspaces[slot].frontier.top().point_index );
                 }
+                ++k;
+                continue;
+            }
+
+            const std::size_t q = slot_queries[slot];
+            if ( search.found )
+            {
+                result[q] = core.reconstruct_path ( queries[q].first, search.target_index, search.cost, workspaces[slot].parents );
+            }
+            else if ( !first_error )
+            {
+                first_error = std::make_exception_ptr ( ues::exc::exception ( "Unable to find a path between points", UES_CONTEXT ) );
+            }
+
+            if ( start_next_query ( slot ) )
+            {
+                ++k;
+            }
+            else
+            {
+                active_slots[k] = active_slots.back();
+                active_slots.pop_back();
             }
         }
     }
 
-    throw ues::exc::exception ( "Unable to find a path between points", UES_CONTEXT );
+    if ( first_error )
+        std::rethrow_exception ( first_error );
+
+    return result;
 }
 
 
 template<unsigned short N>
 graph_pathfinder<N>::graph_pathfinder ( std::shared_ptr< visibility_graph<N> > graph )
-    : graph ( std::move ( graph ) )
+    : graph ( std::move ( graph ) ),
+      evaluation ( EAGER_EVALUATION ),
+      heuristic_weight ( 1 )
 {
     if ( this->graph.get() == nullptr )
         throw ues::exc::exception ( "Provided graph cannot be null", UES_CONTEXT );
 }
 
 
+template<unsigned short N>
+typename graph_pathfinder<N>::edge_evaluation graph_pathfinder<N>::get_edge_evaluation() const noexcept
+{
+    return evaluation;
+}
+
+
+template<unsigned short N>
+void graph_pathfinder<N>::set_edge_evaluation ( edge_evaluation evaluation ) noexcept
+{
+    this->evaluation = evaluation;
+}
+
+
+template<unsigned short N>
+void graph_pathfinder<N>::set_landmark_heuristic ( std::shared_ptr< const landmark_heuristic<N> > landmarks )
+{
+    if ( landmarks && landmarks->size() != graph->size() )
+        throw ues::exc::exception ( "Landmarks were computed for a different graph", UES_CONTEXT );
+
+    this->landmarks = std::move ( landmarks );
+}
+
+
+template<unsigned short N>
+ues::math::numeric_type graph_pathfinder<N>::get_heuristic_weight() const noexcept
+{
+    return heuristic_weight;
+}
+
+
+template<unsigned short N>
+void graph_pathfinder<N>::set_heuristic_weight ( ues::math::numeric_type weight )
+{
+    if ( weight < 1 )
+        throw ues::exc::exception ( "Heuristic weight cannot be lower than 1", UES_CONTEXT );
+
+    heuristic_weight = weight;
+}
+
+
 // Instantiate the templates in this translation unit, just once.
 template class ues::pf::graph_pathfinder<2>;
 template class ues::pf::graph_pathfinder<3>;
@@ -18,7 +18,17 @@
 #ifndef UES_PF_GRAPH_PATHFINDER_H
 #define UES_PF_GRAPH_PATHFINDER_H
 
+#include <functional>
+
+#include <boost/date_time/posix_time/posix_time_types.hpp>
+
+#include <misc/thread_pool.h>
+
+#include <pf/ellipse_bound.h>
 #include <pf/path.h>
+#include <pf/visibility_graph/graph_search.h>
+#include <pf/visibility_graph/landmark_heuristic.h>
+#include <pf/visibility_graph/search_workspace.h>
 #include <pf/visibility_graph/visibility_graph.h>
 
 namespace ues
@@ -30,17 +40,132 @@ template<unsigned short N>
 class graph_pathfinder
 {
 public:
+    /** An origin and target pair. */
+    typedef std::pair< ues::geom::point<N>, ues::geom::point<N> > query;
+    typedef std::vector< query > query_vector;
+    typedef std::vector< path<N> > path_vector;
+
+    /** A path together with its cost and a proven bound of its suboptimality: the cost of the
+     * path is at most \a suboptimality_bound times the cost of the shortest path. */
+    struct bounded_path
+    {
+        path<N> points;
+        ues::math::numeric_type cost;
+        ues::math::numeric_type suboptimality_bound;
+    };
+
+    /** Function receiving each of the improved paths found by an anytime search. */
+    typedef std::function< void ( const bounded_path & ) > bounded_path_callback;
+
+    /** Strategies used to evaluate the edges of the graph during the search. */
+    enum edge_evaluation
+    {
+        /** Only valid edges are generated when a point is expanded. */
+        EAGER_EVALUATION,
+        /** Candidate edges are assumed to be valid, and they are only validated when the point
+         * they lead to is about to be expanded. Useful when validating edges is expensive. */
+        LAZY_EVALUATION
+    };
+
     /** Constructor method receiving a visibility graph. */
     graph_pathfinder ( std::shared_ptr< visibility_graph<N> > graph );
 
+    /** Returns the strategy used to evaluate the edges of the graph. */
+    edge_evaluation get_edge_evaluation() const noexcept;
+
+    /** Changes the strategy used to evaluate the edges of the graph. */
+    void set_edge_evaluation ( edge_evaluation evaluation ) noexcept;
+
+    /** Combines the straight-line distance heuristic with the lower bounds of the \a landmarks,
+     * which must have been computed for the same graph. A null pointer restores the
+     * straight-line distance alone. */
+    void set_landmark_heuristic ( std::shared_ptr< const landmark_heuristic<N> > landmarks );
+
+    /** Returns the weight applied to the heuristic. */
+    ues::math::numeric_type get_heuristic_weight() const noexcept;
+
+    /** Changes the weight applied to the heuristic (weighted A*). A weight of 1 + epsilon finds
+     * paths whose cost is at most 1 + epsilon times the optimal one, usually expanding fewer
+     * points. The weight must not be lower than 1. */
+    void set_heuristic_weight ( ues::math::numeric_type weight );
+
     /** Finds a path between two points using the provided visibility graph. */
     path<N> find_path ( const ues::geom::point<N> & origin,
-                        const ues::geom::point<N> & target );
+                        const ues::geom::point<N> & target ) const;
+
+    /** Finds a path between two points using the provided visibility graph and the buffers
+     * of \a workspace. Searches with different workspaces may run concurrently. */
+    path<N> find_path ( const ues::geom::point<N> & origin,
+                        const ues::geom::point<N> & target,
+                        search_workspace<N> & workspace ) const;
+
+    /** Finds a path like the other overloads, discarding the points that cannot be on a path
+     * within the \a bound, which must have been built for the same origin and target. A point
+     * is not pushed to the open list if its cost plus its estimate exceed the length of the
+     * bound; as both are not shorter than straight lines, this discards the points out of the
+     * ellipse. Throws if there is no path within the bound. */
+    path<N> find_path ( const ues::geom::point<N> & origin,
+                        const ues::geom::point<N> & target,
+                        search_workspace<N> & workspace,
+                        const ellipse_bound<N> & bound ) const;
+
+    /** Anytime search (ARA*). Starting with \a initial_weight, runs weighted A* searches that
+     * reuse the work of the previous ones, reducing the weight by \a weight_step each time. Every
+     * improved path is passed to \a callback as soon as it is found, until the path is proven
+     * optimal or the \a deadline is reached. Returns the best path found, and throws if none
+     * was found before the deadline. Edges are always evaluated eagerly. */
+    bounded_path find_path_anytime ( const ues::geom::point<N> & origin,
+                                     const ues::geom::point<N> & target,
+                                     ues::math::numeric_type initial_weight,
+                                     ues::math::numeric_type weight_step,
+                                     const boost::posix_time::ptime & deadline,
+                                     const bounded_path_callback & callback = bounded_path_callback() ) const;
+
+    /** Finds the paths of all the \a queries using \a number_of_threads threads (or as many
+     * as hardware threads if zero). The i-th path of the result corresponds to the i-th query.
+     * If any query fails, the first error is thrown once the rest have finished. */
+    path_vector find_paths ( const query_vector & queries,
+                             unsigned int number_of_threads = 0 ) const;
+
+    /** Finds the paths of all the \a queries using the workers of \a pool. */
+    path_vector find_paths ( const query_vector & queries,
+                             ues::misc::thread_pool & pool ) const;
+
+    /** Finds the paths of all the \a queries in the calling thread, advancing up to
+     * \a interleaving searches in turns, one expansion each. Before switching to another
+     * search, the graph is asked to prefetch the edges of the next point to expand, so they are
+     * loaded while the other searches run. The i-th path of the result corresponds to the i-th
+     * query. Edges are always evaluated eagerly. If any query fails, the first error is thrown
+     * once the rest have finished. By default the searches run one after another: interleaving
+     * is opt-in, since each search keeps its own workspace and the larger working set was
+     * slower than the graph misses it hides in the graphs measured so far. */
+    path_vector find_paths_interleaved ( const query_vector & queries,
+                                         unsigned int interleaving = 1 ) const;
 
 private:
-    std::shared_ptr< visibility_graph<N> > graph;
+    typedef typename visibility_graph<N>::size_type size_type;
+    /** The search core, run through the virtual interface of the graph. */
+    typedef graph_search< N, visibility_graph<N> > search_core;
+
+    std::shared_ptr< const visibility_graph<N> > graph;
+    edge_evaluation evaluation;
+    std::shared_ptr< const landmark_heuristic<N> > landmarks;
+    ues::math::numeric_type heuristic_weight;
+
+    /** Returns the search core over the graph, with the current heuristic. */
+    inline search_core make_search() const noexcept;
 };
 
+
+// Inlined methods.
+
+
+template<unsigned short N>
+typename graph_pathfinder<N>::search_core graph_pathfinder<N>::make_search() const noexcept
+{
+    return search_core ( *graph, landmarks.get(), heuristic_weight );
+}
+
 }
 }
 
@@ -0,0 +1,421 @@
+/*
+ * Copyright 2015-2017 Guillermo Frontera <guillermo.frontera@upm.es>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#ifndef UES_PF_GRAPH_SEARCH_H
+#define UES_PF_GRAPH_SEARCH_H
+
+#include <algorithm>
+#include <utility>
+
+#include <exc/exception.h>
+#include <log/logger.h>
+
+#include <pf/ellipse_bound.h>
+#include <pf/path.h>
+#include <pf/visibility_graph/landmark_heuristic.h>
+#include <pf/visibility_graph/search_workspace.h>
+
+namespace ues
+{
+namespace pf
+{
+
+/** The graph_search class runs the A* searches of graph_pathfinder and static_graph_pathfinder
+ * over a graph of type Graph, so both share a single implementation. graph_pathfinder uses it
+ * through the virtual interface of visibility_graph, while static_graph_pathfinder binds it to
+ * the concrete type of the graph, so the accesses in the innermost loop can be inlined. The
+ * Graph type must provide the size, point_to_index, index_to_point, for_each_adjacent,
+ * for_each_candidate_adjacent and validate_candidate members of visibility_graph. The search
+ * only refers to the graph and the landmarks, which must outlive it. */
+template<unsigned short N, class Graph>
+class graph_search
+{
+public:
+    typedef typename search_workspace<N>::size_type size_type; /**< Type used for point indices. */
+
+    /** State of an eager search, which can be advanced one expansion at a time. */
+    struct eager_search
+    {
+        const ues::geom::point<N> * target;
+        size_type target_index;
+        search_workspace<N> * workspace;
+        ues::math::numeric_type length_bound;
+        /** Whether the target has been reached, and the cost of the path to it. */
+        bool found;
+        ues::math::numeric_type cost;
+    };
+
+    /** Constructor method receiving the \a graph, the optional \a landmarks computed for it and
+     * the weight applied to the heuristic. */
+    graph_search ( const Graph & graph,
+                   const landmark_heuristic<N> * landmarks,
+                   ues::math::numeric_type heuristic_weight ) noexcept;
+
+    /** Finds a path between two points using the buffers of \a workspace, discarding the points
+     * that cannot be on a path within the \a bound. Edges are evaluated lazily if \a lazy is
+     * set, and eagerly otherwise. */
+    path<N> find_path ( const ues::geom::point<N> & origin,
+                        const ues::geom::point<N> & target,
+                        search_workspace<N> & workspace,
+                        const ellipse_bound<N> & bound,
+                        bool lazy ) const;
+
+    /** Pushes the point of index \a origin_index to the open list of the \a search. */
+    void start_eager ( eager_search & search, size_type origin_index ) const;
+
+    /** Expands the next point of the \a search. Returns true once the search has finished,
+     * either because the target was reached or because no point is left. */
+    bool expand_eager ( eager_search & search ) const;
+
+    /** Returns a lower bound of the cost from the point of index \a point_index to the target. */
+    inline ues::math::numeric_type estimate ( size_type point_index,
+                                              const ues::geom::point<N> & target,
+                                              size_type target_index ) const;
+
+    /** Builds the path to the point of index \a target_index from the \a parents of the points. */
+    path<N> reconstruct_path ( const ues::geom::point<N> & origin,
+                               size_type target_index,
+                               ues::math::numeric_type cost,
+                               const typename search_workspace<N>::parent_point & parents ) const;
+
+private:
+    typedef typename search_workspace<N>::state state;
+    typedef typename search_workspace<N>::priority_queue priority_queue;
+    typedef typename search_workspace<N>::handle_storage handle_storage;
+
+    static constexpr const char * component_name = "Pathfinder";
+
+    const Graph & graph;
+    const landmark_heuristic<N> * landmarks;
+    ues::math::numeric_type heuristic_weight;
+
+    /** A* search generating only valid edges. Points whose estimated cost exceeds the
+     * \a length_bound are discarded. */
+    path<N> find_path_eager ( const ues::geom::point<N> & origin,
+                              const ues::geom::point<N> & target,
+                              size_type origin_index,
+                              size_type target_index,
+                              search_workspace<N> & workspace,
+                              ues::math::numeric_type length_bound ) const;
+
+    /** A* search generating candidate edges, which are validated when extracted from the queue.
+     * Points whose estimated cost exceeds the \a length_bound are discarded. */
+    path<N> find_path_lazy ( const ues::geom::point<N> & origin,
+                             const ues::geom::point<N> & target,
+                             size_type origin_index,
+                             size_type target_index,
+                             search_workspace<N> & workspace,
+                             ues::math::numeric_type length_bound ) const;
+};
+
+
+// Template implementation.
+
+
+template<unsigned short N, class Graph>
+constexpr const char * graph_search<N, Graph>::component_name;
+
+
+template<unsigned short N, class Graph>
+graph_search<N, Graph>::graph_search ( const Graph & graph,
+                                       const landmark_heuristic<N> * landmarks,
+                                       ues::math::numeric_type heuristic_weight ) noexcept
+    : graph ( graph ),
+      landmarks ( landmarks ),
+      heuristic_weight ( heuristic_weight )
+{
+}
+
+
+template<unsigned short N, class Graph>
+ues::math::numeric_type graph_search<N, Graph>::estimate ( size_type point_index,
+                                                           const ues::geom::point<N> & target,
+                                                           size_type target_index ) const
+{
+    ues::math::numeric_type result = graph.index_to_point ( point_index ).distance_to ( target );
+    if ( landmarks )
+    {
+        result = std::max ( result, landmarks->lower_bound ( point_index, target_index ) );
+    }
+    return result;
+}
+
+
+template<unsigned short N, class Graph>
+path<N> graph_search<N, Graph>::find_path ( const ues::geom::point<N> & origin,
+                                            const ues::geom::point<N> & target,
+                                            search_workspace<N> & workspace,
+                                            const ellipse_bound<N> & bound,
+                                            bool lazy ) const
+{
+    // Get indices to the origin and target points.
+    const size_type origin_index = graph.point_to_index ( origin );
+    const size_type target_index = graph.point_to_index ( target );
+
+    // Prepare the data structures of the workspace.
+    workspace.reset ( graph.size() );
+
+    if ( lazy )
+    {
+        return find_path_lazy ( origin, target, origin_index, target_index, workspace, bound.get_length() );
+    }
+    return find_path_eager ( origin, target, origin_index, target_index, workspace, bound.get_length() );
+}
+
+
+template<unsigned short N, class Graph>
+path<N> graph_search<N, Graph>::find_path_eager ( const ues::geom::point<N> & origin,
+                                                  const ues::geom::point<N> & target,
+                                                  size_type origin_index,
+                                                  size_type target_index,
+                                                  search_workspace<N> & workspace,
+                                                  ues::math::numeric_type length_bound ) const
+{
+    eager_search search { &target, target_index, &workspace, length_bound, false, 0 };
+    start_eager ( search, origin_index );
+    while ( !expand_eager ( search ) )
+    {
+    }
+
+    if ( search.found )
+    {
+        return reconstruct_path ( origin, target_index, search.cost, workspace.parents );
+    }
+    throw ues::exc::exception ( "Unable to find a path between points", UES_CONTEXT );
+}
+
+
+template<unsigned short N, class Graph>
+void graph_search<N, Graph>::start_eager ( eager_search & search, size_type origin_index ) const
+{
+    search_workspace<N> & workspace = *search.workspace;
+    workspace.parents[ origin_index ] = origin_index;
+
+    // Add initial node to the priority queue.
+    typename priority_queue::handle_type handle = workspace.frontier.push ( { origin_index, 0, heuristic_weight * estimate ( origin_index, *search.target, search.target_index ) } );
+    workspace.handles.insert ( { origin_index, handle } );
+    UES_PF_STATISTICS ( workspace.statistics.peak_frontier_size = 1; )
+}
+
+
+template<unsigned short N, class Graph>
+bool graph_search<N, Graph>::expand_eager ( eager_search & search ) const
+{
+    priority_queue & frontier = search.workspace->frontier;
+    handle_storage & handles = search.workspace->handles;
+    typename search_workspace<N>::index_set & explored = search.workspace->explored;
+    typename search_workspace<N>::parent_point & parents = search.workspace->parents;
+    const ues::geom::point<N> & target = *search.target;
+    const size_type target_index = search.target_index;
+    UES_PF_STATISTICS ( search_statistics & statistics = search.workspace->statistics; )
+
+    if ( frontier.empty() )
+    {
+        return true;
+    }
+
+    state node = frontier.top();
+    frontier.pop();
+    handles.erase ( node.point_index );
+
+    if ( node.point_index == target_index )
+    {
+        search.found = true;
+        search.cost = node.accumulated_cost;
+        return true;
+    }
+
+    explored.insert ( node.point_index );
+    UES_PF_STATISTICS ( ++statistics.expanded_points; )
+
+    // The time spent processing each edge is not part of the neighbour enumeration.
+    UES_PF_STATISTICS ( search_statistics::duration edges_time = search_statistics::duration::zero(); )
+    UES_PF_STATISTICS ( search_statistics::clock::time_point enumeration_start = search_statistics::clock::now(); )
+
+    graph.for_each_adjacent ( node.point_index, [&] ( size_type p, ues::math::numeric_type last_edge )
+    {
+        UES_PF_STATISTICS ( search_statistics::scoped_timer edge_timer ( edges_time ); )
+        if ( explored.find ( p ) == explored.end() )
+        {
+            UES_PF_STATISTICS ( ++statistics.relaxed_edges; )
+
+            // Generate a node with the cost of getting to p from node.point_index.
+            state new_node;
+            new_node.point_index = p;
+            new_node.accumulated_cost = node.accumulated_cost + last_edge;
+            ues::math::numeric_type heuristic_cost;
+            {
+                UES_PF_STATISTICS ( search_statistics::scoped_timer heuristic_timer ( statistics.heuristic_time ); )
+                heuristic_cost = estimate ( p, target, target_index );
+            }
+            if ( new_node.accumulated_cost + heuristic_cost > search.length_bound )
+            {
+                return;
+            }
+            new_node.estimated_cost = new_node.accumulated_cost + heuristic_weight * heuristic_cost;
+
+            typename handle_storage::const_iterator it = handles.find ( p );
+            if ( it == handles.end() )
+            {
+                typename priority_queue::handle_type handle = frontier.push ( new_node );
+                handles.insert ( { p, handle } );
+                parents[p] = node.point_index;
+                UES_PF_STATISTICS ( statistics.peak_frontier_size = std::max ( statistics.peak_frontier_size, frontier.size() ); )
+            }
+            else if ( new_node.estimated_cost < ( *it->second ).estimated_cost )
+            {
+                ( *it->second ).estimated_cost = new_node.estimated_cost;
+                ( *it->second ).accumulated_cost = new_node.accumulated_cost;
+                frontier.decrease ( it->second );
+                parents[p] = node.point_index;
+                UES_PF_STATISTICS ( ++statistics.decreased_keys; )
+            }
+        }
+    } );
+
+    UES_PF_STATISTICS ( statistics.adjacents_time += search_statistics::clock::now() - enumeration_start - edges_time; )
+    return false;
+}
+
+
+template<unsigned short N, class Graph>
+path<N> graph_search<N, Graph>::find_path_lazy ( const ues::geom::point<N> & origin,
+                                                 const ues::geom::point<N> & target,
+                                                 size_type origin_index,
+                                                 size_type target_index,
+                                                 search_workspace<N> & workspace,
+                                                 ues::math::numeric_type length_bound ) const
+{
+    typedef typename search_workspace<N>::lazy_state lazy_state;
+
+    typename search_workspace<N>::lazy_priority_queue & frontier = workspace.lazy_frontier;
+    typename search_workspace<N>::index_set & explored = workspace.explored;
+    typename search_workspace<N>::parent_point & parents = workspace.parents;
+    typename search_workspace<N>::state_comparator comparator;
+    UES_PF_STATISTICS ( search_statistics & statistics = workspace.statistics; )
+
+    // Add initial node to the priority queue.
+    frontier.push_back ( { origin_index, origin_index, 0, heuristic_weight * estimate ( origin_index, target, target_index ) } );
+    UES_PF_STATISTICS ( statistics.peak_frontier_size = 1; )
+
+    while ( !frontier.empty() )
+    {
+        std::pop_heap ( frontier.begin(), frontier.end(), comparator );
+        lazy_state node = frontier.back();
+        frontier.pop_back();
+
+        // The point may have already been reached through a cheaper edge.
+        if ( explored.find ( node.point_index ) != explored.end() )
+        {
+            continue;
+        }
+
+        // The edge is only validated now that it is about to be used. If it is not valid, other
+        // entries of the queue may still reach the point.
+        bool valid_edge = true;
+        if ( node.point_index != node.parent_index )
+        {
+            UES_PF_STATISTICS ( search_statistics::scoped_timer validation_timer ( statistics.edge_time ); )
+            valid_edge = graph.validate_candidate ( node.parent_index, node.point_index );
+        }
+        if ( !valid_edge )
+        {
+            continue;
+        }
+
+        explored.insert ( node.point_index );
+        UES_PF_STATISTICS ( ++statistics.expanded_points; )
+        parents[ node.point_index ] = node.parent_index;
+
+        if ( node.point_index == target_index )
+        {
+            return reconstruct_path ( origin, target_index, node.accumulated_cost, parents );
+        }
+
+        // The time spent processing each edge is not part of the neighbour enumeration.
+        UES_PF_STATISTICS ( search_statistics::duration edges_time = search_statistics::duration::zero(); )
+        UES_PF_STATISTICS ( search_statistics::clock::time_point enumeration_start = search_statistics::clock::now(); )
+
+        graph.for_each_candidate_adjacent ( node.point_index, [&] ( size_type p, ues::math::numeric_type last_edge )
+        {
+            UES_PF_STATISTICS ( search_statistics::scoped_timer edge_timer ( edges_time ); )
+            if ( explored.find ( p ) == explored.end() )
+            {
+                UES_PF_STATISTICS ( ++statistics.relaxed_edges; )
+
+                // Generate a node with the cost of getting to p from node.point_index, if the
+                // edge turns out to be valid.
+                lazy_state new_node;
+                new_node.point_index = p;
+                new_node.parent_index = node.point_index;
+                new_node.accumulated_cost = node.accumulated_cost + last_edge;
+                ues::math::numeric_type heuristic_cost;
+                {
+                    UES_PF_STATISTICS ( search_statistics::scoped_timer heuristic_timer ( statistics.heuristic_time ); )
+                    heuristic_cost = estimate ( p, target, target_index );
+                }
+                if ( new_node.accumulated_cost + heuristic_cost > length_bound )
+                {
+                    return;
+                }
+                new_node.estimated_cost = new_node.accumulated_cost + heuristic_weight * heuristic_cost;
+
+                frontier.push_back ( new_node );
+                std::push_heap ( frontier.begin(), frontier.end(), comparator );
+                UES_PF_STATISTICS ( statistics.peak_frontier_size = std::max ( statistics.peak_frontier_size, frontier.size() ); )
+            }
+        } );
+
+        UES_PF_STATISTICS ( statistics.adjacents_time += search_statistics::clock::now() - enumeration_start - edges_time; )
+    }
+
+    throw ues::exc::exception ( "Unable to find a path between points", UES_CONTEXT );
+}
+
+
+template<unsigned short N, class Graph>
+path<N> graph_search<N, Graph>::reconstruct_path ( const ues::geom::point<N> & origin,
+                                                   size_type target_index,
+                                                   ues::math::numeric_type cost,
+                                                   const typename search_workspace<N>::parent_point & parents ) const
+{
+    path<N> reverse_result;
+    size_type current_point = target_index;
+    while ( current_point != parents[ current_point ] )
+    {
+        reverse_result.push_back ( graph.index_to_point ( current_point ) );
+        current_point = parents[ current_point ];
+    }
+    reverse_result.push_back ( origin );
+    path<N> result ( reverse_result.rbegin(), reverse_result.rend() );
+
+    ues::log::logger lg;
+    if ( lg.min_level() <= ues::log::DEBUG_LVL )
+    {
+        ues::log::event e ( ues::log::DEBUG_LVL, component_name, "Found path" );
+        e.message() << "Cost of the path: " << cost << '\n';
+        e.message() << result << '\n';
+        lg.record ( std::move ( e ) );
+    }
+
+    return result;
+}
+
+}
+}
+
+#endif // UES_PF_GRAPH_SEARCH_H
@@ -0,0 +1,278 @@
+/*
+ * Copyright 2015-2017 Guillermo Frontera <guillermo.frontera@upm.es>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include "landmark_heuristic.h"
+
+#include <functional>
+#include <limits>
+#include <queue>
+
+#include <exc/exception.h>
+#include <log/logger.h>
+
+using namespace ues::pf;
+
+const std::string component_name = "Landmark Heuristic";
+
+namespace
+{
+
+const ues::math::numeric_type INFINITE_DISTANCE = std::numeric_limits<ues::math::numeric_type>::infinity();
+
+/** Returns \a value in single precision, rounded towards zero so bounds remain admissible. */
+float round_down ( ues::math::numeric_type value ) noexcept
+{
+    float result = static_cast<float> ( value );
+    if ( result > value )
+    {
+        result = std::nextafter ( result, 0.0f );
+    }
+    return result;
+}
+
+}
+
+
+template<unsigned short N>
+landmark_heuristic<N>::landmark_heuristic ( const visibility_graph<N> & graph,
+                                            unsigned int number_of_landmarks,
+                                            selection_strategy strategy )
+    : number_of_points ( graph.size() ),
+      slack ( 0 )
+{
+    if ( number_of_landmarks == 0 )
+        throw ues::exc::exception ( "At least one landmark is required", UES_CONTEXT );
+
+    number_of_landmarks = std::min<size_type> ( number_of_landmarks, number_of_points );
+    std::vector< distance_vector > landmark_distances;
+
+    // Distance from every point to its closest landmark, used by the farthest strategy, and to
+    // find the first landmark.
+    distance_vector closest_landmark ( number_of_points, INFINITE_DISTANCE );
+    if ( number_of_points > 0 )
+    {
+        distance_vector from_start;
+        shortest_distances ( graph, 0, from_start );
+        closest_landmark = std::move ( from_start );
+    }
+
+    while ( landmarks.size() < number_of_landmarks )
+    {
+        // The point farthest from the current landmarks. Unreachable points are preferred,
+        // since they are in a component without landmarks yet.
+        size_type farthest_point = number_of_points;
+        ues::math::numeric_type farthest = -1;
+        for ( size_type p = 0; p < number_of_points; ++p )
+        {
+            if ( closest_landmark[p] > farthest && std::find ( landmarks.begin(), landmarks.end(), p ) == landmarks.end() )
+            {
+                farthest = closest_landmark[p];
+                farthest_point = p;
+            }
+        }
+
+        // The avoid strategy grows its shortest path tree from the point worst covered by the
+        // current landmarks, which makes the choice deterministic. If no region of the tree is
+        // badly bounded, the farthest point is chosen instead.
+        size_type next = farthest_point;
+        if ( strategy == AVOID_SELECTION && !landmarks.empty() )
+        {
+            const size_type avoided = avoid_landmark ( graph, farthest_point, landmarks, landmark_distances );
+            if ( avoided != number_of_points )
+                next = avoided;
+        }
+
+        landmarks.push_back ( next );
+        landmark_distances.emplace_back();
+        shortest_distances ( graph, next, landmark_distances.back() );
+
+        for ( size_type p = 0; p < number_of_points; ++p )
+        {
+            closest_landmark[p] = ( landmarks.size() == 1 ) ? landmark_distances.back() [p]
+                                  : std::min ( closest_landmark[p], landmark_distances.back() [p] );
+        }
+    }
+
+    // Store the distances in single precision, grouped by point so a bound reads a single
+    // contiguous block per point.
+    const size_type k = landmarks.size();
+    distances.resize ( number_of_points * k );
+    ues::math::numeric_type max_distance = 0;
+    for ( size_type l = 0; l < k; ++l )
+    {
+        for ( size_type p = 0; p < number_of_points; ++p )
+        {
+            distances[p * k + l] = round_down ( landmark_distances[l][p] );
+            if ( !std::isinf ( landmark_distances[l][p] ) )
+                max_distance = std::max ( max_distance, landmark_distances[l][p] );
+        }
+    }
+    slack = max_distance * std::numeric_limits<float>::epsilon();
+
+    ues::log::logger lg;
+    if ( lg.min_level() <= ues::log::DEBUG_LVL )
+    {
+        ues::log::event e ( ues::log::DEBUG_LVL, component_name, "Computed landmark distances" );
+        e.message() << "Landmarks:";
+        for ( size_type l : landmarks )
+        {
+            e.message() << ' ' << l;
+        }
+        e.message() << '\n';
+        lg.record ( std::move ( e ) );
+    }
+}
+
+
+template<unsigned short N>
+typename landmark_heuristic<N>::size_type landmark_heuristic<N>::size() const noexcept
+{
+    return number_of_points;
+}
+
+
+template<unsigned short N>
+const typename landmark_heuristic<N>::index_vector & landmark_heuristic<N>::get_landmarks() const noexcept
+{
+    return landmarks;
+}
+
+
+template<unsigned short N>
+void landmark_heuristic<N>::shortest_distances ( const visibility_graph<N> & graph,
+                                                 size_type source,
+                                                 distance_vector & result,
+                                                 index_vector * parents,
+                                                 index_vector * order )
+{
+    typedef std::pair< ues::math::numeric_type, size_type > queue_entry;
+    std::priority_queue< queue_entry, std::vector< queue_entry >, std::greater< queue_entry > > frontier;
+
+    result.assign ( graph.size(), INFINITE_DISTANCE );
+    if ( parents != nullptr )
+        parents->assign ( graph.size(), source );
+    if ( order != nullptr )
+        order->clear();
+
+    result[source] = 0;
+    frontier.push ( { 0, source } );
+
+    while ( !frontier.empty() )
+    {
+        queue_entry entry = frontier.top();
+        frontier.pop();
+        if ( entry.first > result[entry.second] )
+            continue;
+
+        if ( order != nullptr )
+            order->push_back ( entry.second );
+
+        graph.for_each_adjacent ( entry.second, [&] ( size_type p, ues::math::numeric_type weight )
+        {
+            ues::math::numeric_type distance = entry.first + weight;
+            if ( distance < result[p] )
+            {
+                result[p] = distance;
+                if ( parents != nullptr )
+                    ( *parents ) [p] = entry.second;
+                frontier.push ( { distance, p } );
+            }
+        } );
+    }
+}
+
+
+template<unsigned short N>
+typename landmark_heuristic<N>::size_type landmark_heuristic<N>::avoid_landmark ( const visibility_graph<N> & graph,
+                                                                                  size_type root,
+                                                                                  const index_vector & chosen,
+                                                                                  const std::vector< distance_vector > & chosen_distances )
+{
+    const size_type n = graph.size();
+
+    distance_vector distances;
+    index_vector parents, order;
+    shortest_distances ( graph, root, distances, &parents, &order );
+
+    // The weight of a point is how much the current landmarks underestimate its distance to the
+    // root. The size of a point accumulates the weights of its subtree, unless the subtree
+    // already contains a landmark.
+    distance_vector size ( n, 0 );
+    std::vector< bool > has_landmark ( n, false );
+    for ( size_type l : chosen )
+    {
+        has_landmark[l] = true;
+    }
+
+    for ( auto it = order.rbegin(); it != order.rend(); ++it )
+    {
+        size_type p = *it;
+        ues::math::numeric_type bound = 0;
+        for ( const distance_vector & d : chosen_distances )
+        {
+            if ( !std::isinf ( d[root] ) && !std::isinf ( d[p] ) )
+                bound = std::max ( bound, std::abs ( d[root] - d[p] ) );
+        }
+        size[p] += distances[p] - bound;
+
+        if ( has_landmark[p] )
+            size[p] = 0;
+        if ( p != root )
+        {
+            if ( has_landmark[p] )
+                has_landmark[ parents[p] ] = true;
+            size[ parents[p] ] += size[p];
+        }
+    }
+
+    size_type best = n;
+    ues::math::numeric_type best_size = 0;
+    for ( size_type p : order )
+    {
+        if ( size[p] > best_size )
+        {
+            best_size = size[p];
+            best = p;
+        }
+    }
+    if ( best == n )
+        return n;
+
+    // Go down the tree, following the children of largest size, until reaching a leaf.
+    std::vector< index_vector > children ( n );
+    for ( size_type p : order )
+    {
+        if ( p != root )
+            children[ parents[p] ].push_back ( p );
+    }
+    while ( !children[best].empty() )
+    {
+        size_type next = children[best].front();
+        for ( size_type child : children[best] )
+        {
+            if ( size[child] > size[next] )
+                next = child;
+        }
+        best = next;
+    }
+    return best;
+}
+
+
+// Instantiate the templates in this translation unit, just once.
+template class ues::pf::landmark_heuristic<2>;
+template class ues::pf::landmark_heuristic<3>;
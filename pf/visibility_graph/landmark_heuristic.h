@@ -0,0 +1,123 @@
+/*
+ * Copyright 2015-2017 Guillermo Frontera <guillermo.frontera@upm.es>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#ifndef UES_PF_LANDMARK_HEURISTIC_H
+#define UES_PF_LANDMARK_HEURISTIC_H
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+#include <pf/visibility_graph/visibility_graph.h>
+
+namespace ues
+{
+namespace pf
+{
+
+/** The landmark_heuristic class stores the distances from a few landmark points to every point
+ * of a visibility graph that is not going to change. By the triangle inequality, they provide
+ * lower bounds of the distance between any two points (ALT heuristic), which are usually much
+ * tighter than the straight-line distance when obstacles are dense. */
+template<unsigned short N>
+class landmark_heuristic
+{
+public:
+    typedef typename visibility_graph<N>::size_type size_type; /**< Type used for point indices. */
+    typedef std::vector< size_type > index_vector;
+
+    /** Strategies used to choose the landmarks. */
+    enum selection_strategy
+    {
+        /** Every landmark is the point farthest from the landmarks already chosen. */
+        FARTHEST_SELECTION,
+        /** Every landmark is placed in the region of a shortest path tree in which the current
+         * landmarks give the worst bounds. The tree grows from the point farthest from them. */
+        AVOID_SELECTION
+    };
+
+    /** Chooses \a number_of_landmarks landmarks of the \a graph and computes their distances
+     * to every point. */
+    landmark_heuristic ( const visibility_graph<N> & graph,
+                         unsigned int number_of_landmarks,
+                         selection_strategy strategy = AVOID_SELECTION );
+
+    /** Returns the number of points of the graph. */
+    size_type size() const noexcept;
+
+    /** Returns the indices of the chosen landmarks. */
+    const index_vector & get_landmarks() const noexcept;
+
+    /** Returns a lower bound of the distance between the points of indices \a point_index and
+     * \a target_index. */
+    inline ues::math::numeric_type lower_bound ( size_type point_index, size_type target_index ) const noexcept;
+
+private:
+    typedef std::vector< ues::math::numeric_type > distance_vector;
+
+    size_type number_of_points;
+    index_vector landmarks;
+    /** Distances from every landmark, stored by point: the distance from landmark l to point p
+     * is at position p * landmarks.size() + l. Values are rounded down. */
+    std::vector< float > distances;
+    /** Error that the single precision storage may add to a bound. */
+    ues::math::numeric_type slack;
+
+    /** Computes the distances from \a source to every point of the \a graph, and optionally the
+     * shortest path tree and the order in which points are settled. */
+    static void shortest_distances ( const visibility_graph<N> & graph,
+                                     size_type source,
+                                     distance_vector & result,
+                                     index_vector * parents = nullptr,
+                                     index_vector * order = nullptr );
+
+    /** Returns the point that the avoid strategy would choose as next landmark, given the
+     * distances of the landmarks already chosen. */
+    static size_type avoid_landmark ( const visibility_graph<N> & graph,
+                                      size_type root,
+                                      const index_vector & chosen,
+                                      const std::vector< distance_vector > & chosen_distances );
+};
+
+
+// Template implementation.
+
+
+template<unsigned short N>
+ues::math::numeric_type landmark_heuristic<N>::lower_bound ( size_type point_index, size_type target_index ) const noexcept
+{
+    const size_type k = landmarks.size();
+    const float * point_distances = distances.data() + point_index * k;
+    const float * target_distances = distances.data() + target_index * k;
+
+    ues::math::numeric_type result = 0;
+    for ( size_type l = 0; l < k; ++l )
+    {
+        // Points unreachable from a landmark give no information.
+        if ( std::isinf ( point_distances[l] ) || std::isinf ( target_distances[l] ) )
+            continue;
+
+        ues::math::numeric_type bound = std::abs ( static_cast<ues::math::numeric_type> ( target_distances[l] ) - point_distances[l] );
+        result = std::max ( result, bound );
+    }
+    return std::max<ues::math::numeric_type> ( 0, result - slack );
+}
+
+}
+}
+
+#endif // UES_PF_LANDMARK_HEURISTIC_H
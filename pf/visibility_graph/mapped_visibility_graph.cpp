@@ -0,0 +1,587 @@
+/*
+ * Copyright 2015-2017 Guillermo Frontera <guillermo.frontera@upm.es>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include "mapped_visibility_graph.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <limits>
+#include <sstream>
+
+#include <boost/interprocess/file_mapping.hpp>
+#include <boost/interprocess/mapped_region.hpp>
+
+#include <exc/exception.h>
+#include <misc/binary_io.h>
+#include <misc/prefetch.h>
+#include <pf/visibility_graph/morton_order.h>
+
+using namespace ues::pf;
+
+
+template<unsigned short N>
+const std::uint32_t mapped_visibility_graph<N>::FORMAT_MAGIC = 0x47564555; // "UEVG"
+
+template<unsigned short N>
+const std::uint32_t mapped_visibility_graph<N>::FORMAT_VERSION = 2;
+
+
+/** Header at the beginning of the binary layout. Sections are given by their offset in bytes
+ * from the beginning of the layout, or zero if they are not present. */
+template<unsigned short N>
+struct mapped_visibility_graph<N>::file_header
+{
+    std::uint32_t magic;
+    std::uint32_t version;
+    std::uint32_t dimension;
+    std::uint32_t reserved;
+    std::uint64_t number_of_points;
+    std::uint64_t number_of_edges;
+    std::uint64_t number_of_occlusions;
+    std::uint64_t number_of_segments;
+    std::uint64_t coordinates;
+    std::uint64_t point_order;
+    std::uint64_t offsets;
+    std::uint64_t neighbours;
+    std::uint64_t weights;
+    std::uint64_t occlusion_offsets;
+    std::uint64_t occlusion_targets;
+    std::uint64_t occlusion_segments;
+    std::uint64_t segment_endpoints;
+    std::uint64_t original_indices;
+    std::uint64_t total_size;
+};
+
+
+namespace
+{
+
+const std::size_t VALUE_SIZE = 8;
+
+static_assert ( sizeof ( double ) == VALUE_SIZE, "Coordinates and weights are stored as 8-byte values" );
+
+/** Returns true if the point at \a coordinates goes before \a point in lexicographic order. */
+template<unsigned short N>
+bool coordinates_less ( const double * coordinates, const ues::geom::point<N> & point )
+{
+    for ( unsigned short i = 0; i < N; ++i )
+    {
+        if ( coordinates[i] != point.get ( i ) )
+        {
+            return coordinates[i] < point.get ( i );
+        }
+    }
+    return false;
+}
+
+/** Returns true if the point at \a coordinates is exactly \a point. */
+template<unsigned short N>
+bool coordinates_equal ( const double * coordinates, const ues::geom::point<N> & point )
+{
+    for ( unsigned short i = 0; i < N; ++i )
+    {
+        if ( coordinates[i] != point.get ( i ) )
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+}
+
+
+template<unsigned short N>
+mapped_visibility_graph<N>::mapped_visibility_graph ( std::shared_ptr<const void> data, std::size_t size )
+    : data ( std::move ( data ) ),
+      header ( static_cast<const file_header *> ( this->data.get() ) ),
+      occlusion_offsets ( nullptr ),
+      occlusion_targets ( nullptr ),
+      occlusion_segments ( nullptr ),
+      segment_endpoints ( nullptr ),
+      original_indices ( nullptr )
+{
+    const char * base = static_cast<const char *> ( this->data.get() );
+
+    if ( base == nullptr || reinterpret_cast<std::uintptr_t> ( base ) % VALUE_SIZE != 0 )
+        throw ues::exc::exception ( "Binary visibility graph must be aligned to 8 bytes", UES_CONTEXT );
+    if ( size < sizeof ( file_header ) || header->magic != FORMAT_MAGIC )
+        throw ues::exc::exception ( "Data is not a binary visibility graph", UES_CONTEXT );
+    if ( header->version != FORMAT_VERSION || header->dimension != N )
+        throw ues::exc::exception ( "Unsupported binary visibility graph format", UES_CONTEXT );
+    if ( header->total_size > size )
+        throw ues::exc::exception ( "Binary visibility graph is truncated", UES_CONTEXT );
+
+    // Returns the address of a section, checking that it lies within the layout.
+    auto section = [&] ( std::uint64_t offset, std::uint64_t count ) -> const void *
+    {
+        if ( offset < sizeof ( file_header ) || offset % VALUE_SIZE != 0 || offset > header->total_size ||
+                count > ( header->total_size - offset ) / VALUE_SIZE )
+            throw ues::exc::exception ( "Corrupted binary visibility graph", UES_CONTEXT );
+        return base + offset;
+    };
+
+    const std::uint64_t n = header->number_of_points;
+    if ( n > ( std::numeric_limits<std::uint64_t>::max() - 1 ) / N )
+        throw ues::exc::exception ( "Corrupted binary visibility graph", UES_CONTEXT );
+
+    coordinates = static_cast<const double *> ( section ( header->coordinates, n * N ) );
+    point_order = static_cast<const std::uint64_t *> ( section ( header->point_order, n ) );
+    offsets = static_cast<const std::uint64_t *> ( section ( header->offsets, n + 1 ) );
+    neighbours = static_cast<const std::uint64_t *> ( section ( header->neighbours, header->number_of_edges ) );
+    weights = static_cast<const double *> ( section ( header->weights, header->number_of_edges ) );
+    if ( offsets[0] != 0 || offsets[n] != header->number_of_edges )
+        throw ues::exc::exception ( "Corrupted binary visibility graph", UES_CONTEXT );
+
+    if ( header->occlusion_offsets != 0 )
+    {
+        occlusion_offsets = static_cast<const std::uint64_t *> ( section ( header->occlusion_offsets, n + 1 ) );
+        occlusion_targets = static_cast<const std::uint64_t *> ( section ( header->occlusion_targets, header->number_of_occlusions ) );
+        occlusion_segments = static_cast<const std::uint64_t *> ( section ( header->occlusion_segments, header->number_of_occlusions ) );
+        segment_endpoints = static_cast<const std::uint64_t *> ( section ( header->segment_endpoints, 2 * header->number_of_segments ) );
+        if ( occlusion_offsets[0] != 0 || occlusion_offsets[n] != header->number_of_occlusions )
+            throw ues::exc::exception ( "Corrupted binary visibility graph", UES_CONTEXT );
+    }
+
+    if ( header->original_indices != 0 )
+    {
+        original_indices = static_cast<const std::uint64_t *> ( section ( header->original_indices, n ) );
+        renumbered_indices.assign ( n, n );
+        for ( size_type i = 0; i < n; ++i )
+        {
+            if ( original_indices[i] >= n || renumbered_indices[ original_indices[i] ] != n )
+                throw ues::exc::exception ( "Corrupted binary visibility graph", UES_CONTEXT );
+            renumbered_indices[ original_indices[i] ] = i;
+        }
+    }
+
+    points.resize ( n );
+    for ( size_type i = 0; i < n; ++i )
+    {
+        for ( unsigned short j = 0; j < N; ++j )
+        {
+            points[i].set ( j, coordinates[ i * N + j ] );
+        }
+    }
+}
+
+
+template<unsigned short N>
+void mapped_visibility_graph<N>::validate() const
+{
+    const std::uint64_t n = header->number_of_points;
+
+    // Returns whether the \a count \a values are below \a limit.
+    auto below = [] ( const std::uint64_t * values, std::uint64_t count, std::uint64_t limit )
+    {
+        return std::all_of ( values, values + count, [limit] ( std::uint64_t v ) { return v < limit; } );
+    };
+    // Returns whether the offsets of the lists of every point never decrease. The first and last
+    // ones were checked by the constructor.
+    auto sorted_offsets = [n] ( const std::uint64_t * list_offsets )
+    {
+        return std::is_sorted ( list_offsets, list_offsets + n + 1 );
+    };
+
+    if ( !below ( point_order, n, n ) || !sorted_offsets ( offsets ) || !below ( neighbours, header->number_of_edges, n ) )
+        throw ues::exc::exception ( "Corrupted binary visibility graph", UES_CONTEXT );
+
+    if ( has_occlusions() )
+    {
+        if ( !sorted_offsets ( occlusion_offsets ) ||
+                !below ( occlusion_targets, header->number_of_occlusions, n ) ||
+                !below ( occlusion_segments, header->number_of_occlusions, header->number_of_segments ) ||
+                !below ( segment_endpoints, 2 * header->number_of_segments, n ) )
+            throw ues::exc::exception ( "Corrupted binary visibility graph", UES_CONTEXT );
+    }
+}
+
+
+template<unsigned short N>
+std::shared_ptr< mapped_visibility_graph<N> > mapped_visibility_graph<N>::map_file ( const std::string & file_name )
+{
+    try
+    {
+        boost::interprocess::file_mapping file ( file_name.c_str(), boost::interprocess::read_only );
+        std::shared_ptr< boost::interprocess::mapped_region > region =
+            std::make_shared< boost::interprocess::mapped_region > ( file, boost::interprocess::read_only );
+        // The mapping lives as long as the graph holds the data pointer.
+        std::shared_ptr<const void> data ( region, region->get_address() );
+        return std::make_shared< mapped_visibility_graph<N> > ( std::move ( data ), region->get_size() );
+    }
+    catch ( boost::interprocess::interprocess_exception & e )
+    {
+        throw ues::exc::exception ( "Unable to map binary visibility graph " + file_name + ": " + e.what(), UES_CONTEXT );
+    }
+}
+
+
+template<unsigned short N>
+void mapped_visibility_graph<N>::save ( const visibility_graph<N> & graph,
+                                        std::ostream & out,
+                                        const occlusion_table * occlusions,
+                                        point_numbering numbering )
+{
+    using ues::misc::write_binary;
+
+    const size_type n = graph.size();
+
+    if ( occlusions != nullptr )
+    {
+        if ( occlusions->offsets.size() != n + 1 || occlusions->offsets.front() != 0 ||
+                occlusions->offsets.back() != occlusions->targets.size() ||
+                occlusions->segments.size() != occlusions->targets.size() )
+            throw ues::exc::exception ( "Occlusion table does not match the graph", UES_CONTEXT );
+    }
+
+    std::vector< double > point_coordinates;
+    point_coordinates.reserve ( n * N );
+    for ( size_type i = 0; i < n; ++i )
+    {
+        const ues::geom::point<N> & p = graph.index_to_point ( i );
+        for ( unsigned short j = 0; j < N; ++j )
+        {
+            point_coordinates.push_back ( p.get ( j ) );
+        }
+    }
+
+    // The i-th point of the layout is the point original[i] of the graph, and the point i of
+    // the graph is the point renumbered[i] of the layout.
+    std::vector< std::uint64_t > original ( n ), renumbered ( n );
+    for ( size_type i = 0; i < n; ++i )
+    {
+        original[i] = i;
+    }
+    if ( numbering == SPATIAL_NUMBERING )
+    {
+        original = morton_order<N> ( point_coordinates );
+        std::vector< double > renumbered_coordinates ( n * N );
+        for ( size_type i = 0; i < n; ++i )
+        {
+            std::copy ( &point_coordinates[ original[i] * N ], &point_coordinates[ original[i] * N ] + N, &renumbered_coordinates[ i * N ] );
+        }
+        point_coordinates.swap ( renumbered_coordinates );
+    }
+    for ( size_type i = 0; i < n; ++i )
+    {
+        renumbered[ original[i] ] = i;
+    }
+
+    std::vector< std::uint64_t > order ( n );
+    for ( size_type i = 0; i < n; ++i )
+    {
+        order[i] = i;
+    }
+    std::sort ( order.begin(), order.end(), [&] ( std::uint64_t one, std::uint64_t two )
+    {
+        return std::lexicographical_compare ( &point_coordinates[ one * N ], &point_coordinates[ one * N ] + N,
+                                              &point_coordinates[ two * N ], &point_coordinates[ two * N ] + N );
+    } );
+
+    std::vector< std::uint64_t > edge_offsets;
+    std::vector< std::pair< std::uint64_t, double > > edges;
+    edge_offsets.reserve ( n + 1 );
+    edge_offsets.push_back ( 0 );
+    for ( size_type i = 0; i < n; ++i )
+    {
+        std::size_t first = edges.size();
+        graph.for_each_adjacent ( original[i], [&] ( size_type neighbour, ues::math::numeric_type weight )
+        {
+            edges.push_back ( { renumbered[ neighbour ], weight } );
+        } );
+        std::sort ( edges.begin() + first, edges.end() );
+        edge_offsets.push_back ( edges.size() );
+    }
+    std::vector< std::uint64_t > edge_neighbours ( edges.size() );
+    std::vector< double > edge_weights ( edges.size() );
+    for ( std::size_t i = 0; i < edges.size(); ++i )
+    {
+        edge_neighbours[i] = edges[i].first;
+        edge_weights[i] = edges[i].second;
+    }
+
+    // Renumber the occlusions, keeping the rows sorted by target.
+    occlusion_table renumbered_occlusions;
+    if ( occlusions != nullptr && numbering != ORIGINAL_NUMBERING )
+    {
+        renumbered_occlusions.offsets.reserve ( n + 1 );
+        renumbered_occlusions.offsets.push_back ( 0 );
+        std::vector< std::pair< std::uint64_t, std::uint64_t > > row;
+        for ( size_type i = 0; i < n; ++i )
+        {
+            row.clear();
+            for ( std::uint64_t o = occlusions->offsets[ original[i] ]; o < occlusions->offsets[ original[i] + 1 ]; ++o )
+            {
+                row.push_back ( { renumbered[ occlusions->targets[o] ], occlusions->segments[o] } );
+            }
+            std::sort ( row.begin(), row.end() );
+            for ( const std::pair< std::uint64_t, std::uint64_t > & occlusion : row )
+            {
+                renumbered_occlusions.targets.push_back ( occlusion.first );
+                renumbered_occlusions.segments.push_back ( occlusion.second );
+            }
+            renumbered_occlusions.offsets.push_back ( renumbered_occlusions.targets.size() );
+        }
+        for ( const std::pair< std::uint64_t, std::uint64_t > & s : occlusions->segment_endpoints )
+        {
+            renumbered_occlusions.segment_endpoints.push_back ( { renumbered[ s.first ], renumbered[ s.second ] } );
+        }
+        occlusions = &renumbered_occlusions;
+    }
+
+    // Lay out the sections one after another.
+    file_header h = {};
+    h.magic = FORMAT_MAGIC;
+    h.version = FORMAT_VERSION;
+    h.dimension = N;
+    h.number_of_points = n;
+    h.number_of_edges = edges.size();
+
+    std::uint64_t position = sizeof ( file_header );
+    auto place = [&position] ( std::uint64_t count )
+    {
+        std::uint64_t offset = position;
+        position += count * VALUE_SIZE;
+        return offset;
+    };
+    h.coordinates = place ( point_coordinates.size() );
+    h.point_order = place ( order.size() );
+    h.offsets = place ( edge_offsets.size() );
+    h.neighbours = place ( edge_neighbours.size() );
+    h.weights = place ( edge_weights.size() );
+    if ( occlusions != nullptr )
+    {
+        h.number_of_occlusions = occlusions->targets.size();
+        h.number_of_segments = occlusions->segment_endpoints.size();
+        h.occlusion_offsets = place ( occlusions->offsets.size() );
+        h.occlusion_targets = place ( occlusions->targets.size() );
+        h.occlusion_segments = place ( occlusions->segments.size() );
+        h.segment_endpoints = place ( 2 * occlusions->segment_endpoints.size() );
+    }
+    if ( numbering != ORIGINAL_NUMBERING )
+    {
+        h.original_indices = place ( original.size() );
+    }
+    h.total_size = position;
+
+    write_binary ( out, h );
+    write_binary ( out, point_coordinates.data(), point_coordinates.size() );
+    write_binary ( out, order.data(), order.size() );
+    write_binary ( out, edge_offsets.data(), edge_offsets.size() );
+    write_binary ( out, edge_neighbours.data(), edge_neighbours.size() );
+    write_binary ( out, edge_weights.data(), edge_weights.size() );
+    if ( occlusions != nullptr )
+    {
+        write_binary ( out, occlusions->offsets.data(), occlusions->offsets.size() );
+        write_binary ( out, occlusions->targets.data(), occlusions->targets.size() );
+        write_binary ( out, occlusions->segments.data(), occlusions->segments.size() );
+        for ( const std::pair< std::uint64_t, std::uint64_t > & s : occlusions->segment_endpoints )
+        {
+            write_binary ( out, s.first );
+            write_binary ( out, s.second );
+        }
+    }
+    if ( numbering != ORIGINAL_NUMBERING )
+    {
+        write_binary ( out, original.data(), original.size() );
+    }
+}
+
+
+template<unsigned short N>
+typename mapped_visibility_graph<N>::size_type mapped_visibility_graph<N>::size() const noexcept
+{
+    return header->number_of_points;
+}
+
+
+template<unsigned short N>
+bool mapped_visibility_graph<N>::is_renumbered() const noexcept
+{
+    return original_indices != nullptr;
+}
+
+
+template<unsigned short N>
+typename mapped_visibility_graph<N>::size_type mapped_visibility_graph<N>::original_index ( size_type point_index ) const
+{
+    if ( point_index >= size() )
+        throw ues::exc::exception ( "Point index out of the visibility graph", UES_CONTEXT );
+
+    return is_renumbered() ? original_indices[ point_index ] : point_index;
+}
+
+
+template<unsigned short N>
+typename mapped_visibility_graph<N>::size_type mapped_visibility_graph<N>::index_of_original ( size_type original_index ) const
+{
+    if ( original_index >= size() )
+        throw ues::exc::exception ( "Point index out of the visibility graph", UES_CONTEXT );
+
+    return is_renumbered() ? renumbered_indices[ original_index ] : original_index;
+}
+
+
+template<unsigned short N>
+bool mapped_visibility_graph<N>::has_occlusions() const noexcept
+{
+    return occlusion_offsets != nullptr;
+}
+
+
+template<unsigned short N>
+std::size_t mapped_visibility_graph<N>::number_of_segments() const noexcept
+{
+    return has_occlusions() ? header->number_of_segments : 0;
+}
+
+
+template<unsigned short N>
+std::pair< typename mapped_visibility_graph<N>::size_type, typename mapped_visibility_graph<N>::size_type >
+mapped_visibility_graph<N>::get_segment ( std::size_t segment ) const
+{
+    if ( segment >= number_of_segments() )
+        throw ues::exc::exception ( "Segment not found in visibility graph", UES_CONTEXT );
+
+    return { segment_endpoints[ 2 * segment ], segment_endpoints[ 2 * segment + 1 ] };
+}
+
+
+template<unsigned short N>
+bool mapped_visibility_graph<N>::check_occlusion_segment ( const ues::geom::point<N> & origin,
+                                                           const ues::geom::point<N> & target,
+                                                           std::size_t & occluding_segment ) const
+{
+    if ( !has_occlusions() )
+        throw ues::exc::exception ( "Visibility graph was saved without occlusion data", UES_CONTEXT );
+
+    const size_type origin_index = point_to_index ( origin );
+    const size_type target_index = point_to_index ( target );
+
+    const std::uint64_t * first = occlusion_targets + occlusion_offsets[ origin_index ];
+    const std::uint64_t * last = occlusion_targets + occlusion_offsets[ origin_index + 1 ];
+    const std::uint64_t * it = std::lower_bound ( first, last, target_index );
+    if ( it != last && *it == target_index )
+    {
+        occluding_segment = occlusion_segments[ it - occlusion_targets ];
+        return true;
+    }
+    return false;
+}
+
+
+template<unsigned short N>
+void mapped_visibility_graph<N>::describe ( std::ostream & out ) const noexcept
+{
+    out << "Points:\tIndex\tCoordinates\n";
+    for ( size_type i = 0; i < size(); ++i )
+    {
+        out << '\t' << i << '\t' << points[i] << '\n';
+    }
+    out << "Edges:\tIndex\tNeighbours\n";
+    for ( size_type i = 0; i < size(); ++i )
+    {
+        out << '\t' << i << '\t';
+        for ( std::uint64_t e = offsets[i]; e < offsets[i + 1]; ++e )
+        {
+            out << neighbours[e] << " (" << weights[e] << ") ";
+        }
+        out << '\n';
+    }
+}
+
+
+template<unsigned short N>
+typename mapped_visibility_graph<N>::size_type mapped_visibility_graph<N>::point_to_index ( const ues::geom::point<N> & point ) const
+{
+    return index_of ( point );
+}
+
+
+template<unsigned short N>
+typename mapped_visibility_graph<N>::size_type mapped_visibility_graph<N>::index_of ( const ues::geom::point<N> & point ) const
+{
+    const std::uint64_t * last = point_order + size();
+    const std::uint64_t * it = std::lower_bound ( point_order, last, point, [this] ( std::uint64_t index, const ues::geom::point<N> & p )
+    {
+        return coordinates_less<N> ( coordinates + index * N, p );
+    } );
+    if ( it != last && coordinates_equal<N> ( coordinates + *it * N, point ) )
+    {
+        return *it;
+    }
+
+    std::ostringstream error;
+    error << "Point " << point << " not found in visibility graph";
+    throw ues::exc::exception ( error.str(), UES_CONTEXT );
+}
+
+
+template<unsigned short N>
+const ues::geom::point<N> & mapped_visibility_graph<N>::index_to_point ( size_type point_index ) const
+{
+    return point_at ( point_index );
+}
+
+
+template<unsigned short N>
+bool mapped_visibility_graph<N>::check_visibility ( size_type point1_index,
+                                                    size_type point2_index,
+                                                    ues::math::numeric_type & distance ) const
+{
+    if ( point1_index == point2_index )
+    {
+        distance = 0;
+        return true;
+    }
+
+    const std::uint64_t * first = neighbours + offsets[ point1_index ];
+    const std::uint64_t * last = neighbours + offsets[ point1_index + 1 ];
+    const std::uint64_t * it = std::lower_bound ( first, last, point2_index );
+    if ( it != last && *it == point2_index )
+    {
+        distance = weights[ it - neighbours ];
+        return true;
+    }
+    return false;
+}
+
+
+template<unsigned short N>
+void mapped_visibility_graph<N>::visit_adjacents ( size_type point_index, edge_visitor & visitor ) const
+{
+    for_each_neighbour ( point_index, [&visitor] ( size_type neighbour_index, ues::math::numeric_type weight )
+    {
+        visitor.visit ( neighbour_index, weight );
+    } );
+}
+
+
+template<unsigned short N>
+void mapped_visibility_graph<N>::prefetch_adjacents ( size_type point_index ) const noexcept
+{
+    // The offsets are contiguous, so reading the first one is cheap compared with loading the
+    // edges it locates, which are the memory for_each_neighbour reads.
+    const std::uint64_t first_edge = offsets[ point_index ];
+    UES_PREFETCH ( neighbours + first_edge );
+    UES_PREFETCH ( weights + first_edge );
+}
+
+
+// Instantiate the templates in this translation unit, just once.
+template class ues::pf::mapped_visibility_graph<2>;
+template class ues::pf::mapped_visibility_graph<3>;
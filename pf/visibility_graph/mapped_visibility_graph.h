@@ -0,0 +1,216 @@
+/*
+ * Copyright 2015-2017 Guillermo Frontera <guillermo.frontera@upm.es>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#ifndef UES_PF_MAPPED_VISIBILITY_GRAPH_H
+#define UES_PF_MAPPED_VISIBILITY_GRAPH_H
+
+#include <cstdint>
+#include <memory>
+#include <ostream>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <pf/visibility_graph/visibility_graph.h>
+
+namespace ues
+{
+namespace pf
+{
+
+/** The mapped_visibility_graph class searches a visibility graph that was computed beforehand and
+ * saved in a binary file, reading the edges in place from the file contents, usually mapped in
+ * memory. The layout starts with a fixed header followed by a sequence of sections, addressed by
+ * their offset from the beginning of the file, so it does not depend on where it is mapped:
+ *  - The coordinates of the points.
+ *  - The indices of the points sorted by their coordinates, to find points by binary search.
+ *  - The edges in compressed sparse row form: the offset of the first edge of every point, and
+ *    the neighbour and weight of every edge, sorted by neighbour.
+ *  - Optionally, the occluding segments of the pairs of points, in the same form, and the
+ *    endpoints of every segment.
+ *  - Optionally, the index that every point had in the graph that was saved, if the points
+ *    were renumbered.
+ * All the values are 8 bytes wide and stored in the byte order of the machine that saved them. */
+template<unsigned short N>
+class mapped_visibility_graph : public visibility_graph<N>
+{
+public:
+    typedef typename visibility_graph<N>::size_type size_type; /**< Type used for point indices. */
+
+    /** Occluding segments of a graph, in compressed sparse row form: the pairs of points of
+     * \a targets and \a segments between offsets[i] and offsets[i + 1] belong to the i-th point,
+     * sorted by target. The segments are given by the indices of their two endpoints. */
+    struct occlusion_table
+    {
+        std::vector< std::uint64_t > offsets;
+        std::vector< std::uint64_t > targets;
+        std::vector< std::uint64_t > segments;
+        std::vector< std::pair< std::uint64_t, std::uint64_t > > segment_endpoints;
+    };
+
+    /** Orders in which the points can be numbered when a graph is saved. */
+    enum point_numbering
+    {
+        /** The points keep the indices they have in the saved graph. */
+        ORIGINAL_NUMBERING,
+        /** The points are numbered along a Morton (Z-order) curve over their coordinates, so
+         * points close in space are close in memory and searches miss the cache less. */
+        SPATIAL_NUMBERING
+    };
+
+    static const std::uint32_t FORMAT_MAGIC;
+    static const std::uint32_t FORMAT_VERSION;
+
+    /** Uses the binary graph stored in the first \a size bytes of \a data, which must be aligned
+     * to 8 bytes and remain unchanged while the graph is used. Only the header, the bounds of the
+     * sections and the first and last offsets of the lists are checked, so the edges are not
+     * read; call validate() for data that may be corrupted. */
+    mapped_visibility_graph ( std::shared_ptr<const void> data, std::size_t size );
+
+    /** Checks every offset, neighbour and occlusion of the graph, which queries use without
+     * further checks, in time linear in its size. Throws if the data is corrupted. */
+    void validate() const;
+
+    /** Maps the binary graph saved in the file \a file_name in read-only memory. */
+    static std::shared_ptr< mapped_visibility_graph<N> > map_file ( const std::string & file_name );
+
+    /** Writes the binary layout of \a graph to \a out, including the \a occlusions if any, with
+     * the points numbered in the given order. The occlusions refer to the indices of \a graph. */
+    static void save ( const visibility_graph<N> & graph,
+                       std::ostream & out,
+                       const occlusion_table * occlusions = nullptr,
+                       point_numbering numbering = ORIGINAL_NUMBERING );
+
+    /** Returns the number of points in the graph. */
+    size_type size() const noexcept override;
+
+    /** Returns true if the points were renumbered when the graph was saved. */
+    bool is_renumbered() const noexcept;
+
+    /** Returns the index that the point of index \a point_index had in the saved graph. */
+    size_type original_index ( size_type point_index ) const;
+
+    /** Returns the index of the point that had index \a original_index in the saved graph. */
+    size_type index_of_original ( size_type original_index ) const;
+
+    /** Returns true if the graph includes the occluding segments of its points. */
+    bool has_occlusions() const noexcept;
+
+    /** Returns the number of segments in the occlusion data. */
+    std::size_t number_of_segments() const noexcept;
+
+    /** Returns the indices of the endpoints of the segment of index \a segment. */
+    std::pair< size_type, size_type > get_segment ( std::size_t segment ) const;
+
+    /** Returns true if some segment occludes the vision between points \a origin and \a target,
+     * which is then returned in \a occluding_segment. */
+    bool check_occlusion_segment ( const ues::geom::point<N> & origin,
+                                   const ues::geom::point<N> & target,
+                                   std::size_t & occluding_segment ) const;
+
+    /** Prints the points and edges of the graph to the \a out parameter. */
+    void describe ( std::ostream & out ) const noexcept override;
+
+    /** \name Non-virtual access, for searches that know the type of the graph */
+    /** \{ */
+    /** Returns the index assigned to a point. */
+    size_type index_of ( const ues::geom::point<N> & point ) const;
+    /** Returns the point assigned to an index. */
+    inline const ues::geom::point<N> & point_at ( size_type point_index ) const noexcept;
+    /** Calls \a fn ( neighbour_index, weight ) for every point visible from the point of index
+     * \a point_index. */
+    template<class F>
+    inline void for_each_neighbour ( size_type point_index, F && fn ) const;
+    /** Calls \a fn ( target_index, segment ) for every point whose vision from the point of index
+     * \a point_index is occluded by a segment. The graph must have occlusions. */
+    template<class F>
+    inline void for_each_occlusion ( size_type point_index, F && fn ) const;
+    /** \} */
+
+    /** Reintroduce hidden overloads. */
+    using visibility_graph<N>::check_visibility;
+
+    typedef typename visibility_graph<N>::edge_visitor edge_visitor;
+
+    size_type point_to_index ( const ues::geom::point<N> & point ) const override;
+    const ues::geom::point<N> & index_to_point ( size_type point_index ) const override;
+
+    bool check_visibility ( size_type point1_index,
+                            size_type point2_index,
+                            ues::math::numeric_type & distance ) const override;
+
+    void visit_adjacents ( size_type point_index, edge_visitor & visitor ) const override;
+
+    void prefetch_adjacents ( size_type point_index ) const noexcept override;
+
+private:
+    struct file_header;
+
+    std::shared_ptr<const void> data;
+    const file_header * header;
+    const double * coordinates;
+    const std::uint64_t * point_order;
+    const std::uint64_t * offsets;
+    const std::uint64_t * neighbours;
+    const double * weights;
+    const std::uint64_t * occlusion_offsets;
+    const std::uint64_t * occlusion_targets;
+    const std::uint64_t * occlusion_segments;
+    const std::uint64_t * segment_endpoints;
+    const std::uint64_t * original_indices;
+    /** Inverse of the original indices, if the points were renumbered. */
+    std::vector< size_type > renumbered_indices;
+    /** The points are built when the graph is opened, since they cannot be read in place. */
+    std::vector< ues::geom::point<N> > points;
+};
+
+
+// Template implementation.
+
+
+template<unsigned short N>
+const ues::geom::point<N> & mapped_visibility_graph<N>::point_at ( size_type point_index ) const noexcept
+{
+    return points[ point_index ];
+}
+
+
+template<unsigned short N>
+template<class F>
+void mapped_visibility_graph<N>::for_each_neighbour ( size_type point_index, F && fn ) const
+{
+    for ( std::uint64_t e = offsets[ point_index ]; e < offsets[ point_index + 1 ]; ++e )
+    {
+        fn ( neighbours[e], weights[e] );
+    }
+}
+
+
+template<unsigned short N>
+template<class F>
+void mapped_visibility_graph<N>::for_each_occlusion ( size_type point_index, F && fn ) const
+{
+    for ( std::uint64_t o = occlusion_offsets[ point_index ]; o < occlusion_offsets[ point_index + 1 ]; ++o )
+    {
+        fn ( occlusion_targets[o], occlusion_segments[o] );
+    }
+}
+
+}
+}
+
+#endif // UES_PF_MAPPED_VISIBILITY_GRAPH_H
@@ -0,0 +1,89 @@
+/*
+ * Copyright 2015-2017 Guillermo Frontera <guillermo.frontera@upm.es>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#ifndef UES_PF_MORTON_ORDER_H
+#define UES_PF_MORTON_ORDER_H
+
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+#include <utility>
+#include <vector>
+
+namespace ues
+{
+namespace pf
+{
+
+/** Returns the indices of the points of \a coordinates, which holds N coordinates per point, in
+ * the order of a Morton (Z-order) curve: the coordinates are scaled to integers within their
+ * bounding box, whose bits are interleaved. Points close in space get close positions. */
+template<unsigned short N>
+inline std::vector< std::uint64_t > morton_order ( const std::vector< double > & coordinates );
+
+
+// Template implementation.
+
+
+template<unsigned short N>
+std::vector< std::uint64_t > morton_order ( const std::vector< double > & coordinates )
+{
+    const std::size_t n = coordinates.size() / N;
+    const unsigned int bits = 64 / N;
+    const double cells = static_cast<double> ( ( std::uint64_t ( 1 ) << bits ) - 1 );
+
+    double minimum[N], scale[N];
+    for ( unsigned short j = 0; j < N; ++j )
+    {
+        double maximum = -std::numeric_limits<double>::infinity();
+        minimum[j] = std::numeric_limits<double>::infinity();
+        for ( std::size_t i = 0; i < n; ++i )
+        {
+            minimum[j] = std::min ( minimum[j], coordinates[ i * N + j ] );
+            maximum = std::max ( maximum, coordinates[ i * N + j ] );
+        }
+        scale[j] = maximum > minimum[j] ? cells / ( maximum - minimum[j] ) : 0;
+    }
+
+    std::vector< std::pair< std::uint64_t, std::uint64_t > > keys ( n );
+    for ( std::size_t i = 0; i < n; ++i )
+    {
+        std::uint64_t key = 0;
+        for ( unsigned short j = 0; j < N; ++j )
+        {
+            std::uint64_t cell = static_cast<std::uint64_t> ( ( coordinates[ i * N + j ] - minimum[j] ) * scale[j] );
+            for ( unsigned int b = 0; b < bits; ++b )
+            {
+                key |= ( ( cell >> b ) & 1 ) << ( b * N + j );
+            }
+        }
+        keys[i] = { key, i };
+    }
+    std::sort ( keys.begin(), keys.end() );
+
+    std::vector< std::uint64_t > result ( n );
+    for ( std::size_t i = 0; i < n; ++i )
+    {
+        result[i] = keys[i].second;
+    }
+    return result;
+}
+
+}
+}
+
+#endif // UES_PF_MORTON_ORDER_H
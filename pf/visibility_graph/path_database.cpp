@@ -0,0 +1,453 @@
+/*
+ * Copyright 2015-2017 Guillermo Frontera <guillermo.frontera@upm.es>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include "path_database.h"
+
+#include <algorithm>
+#include <functional>
+#include <limits>
+#include <queue>
+
+#include <exc/exception.h>
+#include <log/logger.h>
+#include <misc/binary_io.h>
+#include <pf/visibility_graph/morton_order.h>
+
+using namespace ues::pf;
+
+const std::string component_name = "Path Database";
+
+namespace
+{
+
+/** Identifier of the binary format, and its current version. */
+const std::uint32_t FORMAT_MAGIC = 0x44504555; // "UEPD"
+const std::uint32_t FORMAT_VERSION = 1;
+
+/** Min-priority queue of (distance, point index) pairs. */
+typedef std::pair< ues::math::numeric_type, std::size_t > queue_entry;
+typedef std::priority_queue< queue_entry, std::vector< queue_entry >, std::greater< queue_entry > > distance_queue;
+
+/** The first_move_search struct holds the memory used by a worker to compute the first moves
+ * from a point, so it is reused across points. */
+struct first_move_search
+{
+    std::vector< ues::math::numeric_type > distances;
+    std::vector< std::uint32_t > moves;
+    distance_queue frontier;
+};
+
+}
+
+
+template<unsigned short N>
+const std::uint32_t path_database<N>::NO_MOVE = std::numeric_limits<std::uint32_t>::max();
+
+
+template<unsigned short N>
+path_database<N>::path_database() noexcept
+{
+}
+
+
+template<unsigned short N>
+path_database<N>::path_database ( const visibility_graph<N> & graph, unsigned int number_of_threads )
+{
+    ues::misc::thread_pool pool ( number_of_threads );
+    build ( graph, pool );
+}
+
+
+template<unsigned short N>
+path_database<N>::path_database ( const visibility_graph<N> & graph, ues::misc::thread_pool & pool )
+{
+    build ( graph, pool );
+}
+
+
+template<unsigned short N>
+void path_database<N>::build ( const visibility_graph<N> & graph, ues::misc::thread_pool & pool )
+{
+    const size_type n = graph.size();
+    if ( n >= NO_MOVE )
+        throw ues::exc::exception ( "Visibility graph too large for a path database", UES_CONTEXT );
+
+    points.reserve ( n );
+    for ( size_type i = 0; i < n; ++i )
+    {
+        points.push_back ( graph.index_to_point ( i ) );
+        point_indices.insert ( { points.back(), i } );
+    }
+
+    // Number the points along a Morton curve: the points in the same region of space are
+    // usually reached through the same neighbour of a point, so they share their first moves.
+    std::vector< double > coordinates;
+    coordinates.reserve ( n * N );
+    for ( const ues::geom::point<N> & p : points )
+    {
+        for ( unsigned short j = 0; j < N; ++j )
+        {
+            coordinates.push_back ( p.get ( j ) );
+        }
+    }
+    std::vector< std::uint64_t > ranked_points = morton_order<N> ( coordinates );
+    ranks.resize ( n );
+    for ( size_type i = 0; i < n; ++i )
+    {
+        ranks[ ranked_points[i] ] = i;
+    }
+
+    // Every point runs its own search, and the graph is only read, so the points are
+    // distributed among the workers of the pool.
+    std::vector< first_move_search > searches ( pool.size() );
+    std::vector< run_vector > source_runs ( n );
+
+    pool.run ( n, [&] ( std::size_t source, unsigned int worker )
+    {
+        first_move_search & s = searches[worker];
+        s.distances.assign ( n, std::numeric_limits<ues::math::numeric_type>::infinity() );
+        s.moves.assign ( n, NO_MOVE );
+
+        s.distances[source] = 0;
+        s.frontier.push ( { 0, source } );
+        while ( !s.frontier.empty() )
+        {
+            queue_entry entry = s.frontier.top();
+            s.frontier.pop();
+            if ( entry.first > s.distances[entry.second] )
+                continue;
+
+            graph.for_each_adjacent ( entry.second, [&] ( size_type neighbour, ues::math::numeric_type weight )
+            {
+                ues::math::numeric_type distance = entry.first + weight;
+                if ( distance < s.distances[neighbour] )
+                {
+                    s.distances[neighbour] = distance;
+                    s.moves[neighbour] = ( entry.second == source ) ? neighbour : s.moves[entry.second];
+                    s.frontier.push ( { distance, neighbour } );
+                }
+            } );
+        }
+
+        // The move towards the source itself is never used, so it joins any run.
+        run_vector & result = source_runs[source];
+        for ( std::uint32_t rank = 0; rank < n; ++rank )
+        {
+            std::uint32_t move = s.moves[ ranked_points[rank] ];
+            if ( ranked_points[rank] == source )
+            {
+                if ( rank != 0 )
+                    continue;
+                move = ( n > 1 ) ? s.moves[ ranked_points[1] ] : NO_MOVE;
+            }
+            if ( result.empty() || result.back().move != move )
+                result.push_back ( { rank, move } );
+        }
+        result.shrink_to_fit();
+    } );
+
+    offsets.reserve ( n + 1 );
+    offsets.push_back ( 0 );
+    for ( run_vector & r : source_runs )
+    {
+        runs.insert ( runs.end(), r.begin(), r.end() );
+        offsets.push_back ( runs.size() );
+        run_vector().swap ( r );
+    }
+
+    ues::log::logger lg;
+    if ( lg.min_level() <= ues::log::DEBUG_LVL )
+    {
+        ues::log::event e ( ues::log::DEBUG_LVL, component_name, "Built path database" );
+        e.message() << n << " points, " << runs.size() << " runs of first moves\n";
+        lg.record ( std::move ( e ) );
+    }
+}
+
+
+template<unsigned short N>
+typename path_database<N>::size_type path_database<N>::size() const noexcept
+{
+    return points.size();
+}
+
+
+template<unsigned short N>
+typename path_database<N>::size_type path_database<N>::number_of_runs() const noexcept
+{
+    return runs.size();
+}
+
+
+template<unsigned short N>
+path<N> path_database<N>::find_path ( const ues::geom::point<N> & origin,
+                                      const ues::geom::point<N> & target ) const
+{
+    const size_type origin_index = point_to_index ( origin );
+    const size_type target_index = point_to_index ( target );
+
+    index_vector indices { origin_index };
+    ues::math::numeric_type length;
+    if ( !walk ( origin_index, target_index, std::numeric_limits<ues::math::numeric_type>::infinity(), length, &indices ) )
+        throw ues::exc::exception ( "Unable to find a path between points", UES_CONTEXT );
+
+    path<N> result;
+    result.reserve ( indices.size() );
+    for ( size_type i : indices )
+    {
+        result.push_back ( points[i] );
+    }
+    return result;
+}
+
+
+template<unsigned short N>
+path<N> path_database<N>::find_path ( const point_visibility<N> & obstacles,
+                                      const ues::geom::point<N> & origin,
+                                      const ues::geom::point<N> & target ) const
+{
+    const bool free_origin = point_indices.find ( origin ) == point_indices.end();
+    const bool free_target = point_indices.find ( target ) == point_indices.end();
+
+    // The walks only go through the database, so the direct segment between two free points
+    // is checked first.
+    if ( free_origin && free_target && obstacles.check_visibility ( origin, target ) )
+        return path<N> { origin, target };
+
+    const attachment_vector origin_attachments = attach ( obstacles, origin );
+    const attachment_vector target_attachments = attach ( obstacles, target );
+
+    // Every combination of attached points is walked, unless the straight line between them
+    // already makes it longer than the best one found. Walks are abandoned once they exceed it.
+    ues::math::numeric_type best_length = std::numeric_limits<ues::math::numeric_type>::infinity();
+    const attachment * best_origin = nullptr;
+    const attachment * best_target = nullptr;
+    for ( const attachment & first : origin_attachments )
+    {
+        for ( const attachment & last : target_attachments )
+        {
+            const ues::math::numeric_type ends = first.second + last.second;
+            if ( ends + points[first.first].distance_to ( points[last.first] ) >= best_length )
+                continue;
+
+            ues::math::numeric_type length;
+            if ( walk ( first.first, last.first, best_length - ends, length ) && ends + length < best_length )
+            {
+                best_length = ends + length;
+                best_origin = &first;
+                best_target = &last;
+            }
+        }
+    }
+
+    if ( best_origin == nullptr )
+        throw ues::exc::exception ( "Unable to find a path between points", UES_CONTEXT );
+
+    index_vector indices { best_origin->first };
+    ues::math::numeric_type length;
+    walk ( best_origin->first, best_target->first, std::numeric_limits<ues::math::numeric_type>::infinity(), length, &indices );
+
+    path<N> result;
+    result.reserve ( indices.size() + 2 );
+    if ( free_origin )
+        result.push_back ( origin );
+    for ( size_type i : indices )
+    {
+        result.push_back ( points[i] );
+    }
+    if ( free_target )
+        result.push_back ( target );
+    return result;
+}
+
+
+template<unsigned short N>
+typename path_database<N>::attachment_vector path_database<N>::attach ( const point_visibility<N> & obstacles,
+                                                                        const ues::geom::point<N> & point ) const
+{
+    typename point_map::const_iterator it = point_indices.find ( point );
+    if ( it != point_indices.end() )
+        return { { it->second, 0 } };
+
+    // Vertices of the obstacles that are not in the database, if any, are skipped.
+    typename point_visibility<N>::point_vector visible;
+    obstacles.visible_vertices ( point, visible );
+    attachment_vector result;
+    for ( const ues::geom::point<N> & v : visible )
+    {
+        it = point_indices.find ( v );
+        if ( it != point_indices.end() )
+            result.push_back ( { it->second, point.distance_to ( v ) } );
+    }
+    return result;
+}
+
+
+template<unsigned short N>
+bool path_database<N>::walk ( size_type from,
+                              size_type to,
+                              ues::math::numeric_type max_length,
+                              ues::math::numeric_type & length,
+                              index_vector * indices ) const
+{
+    // A shortest path visits every point at most once, so longer walks mean a corrupted table.
+    length = 0;
+    for ( size_type steps = 0; from != to; ++steps )
+    {
+        std::uint32_t next = first_move ( from, to );
+        if ( next == NO_MOVE )
+            return false;
+        if ( steps == points.size() || next >= points.size() )
+            throw ues::exc::exception ( "Corrupted path database", UES_CONTEXT );
+
+        length += points[from].distance_to ( points[next] );
+        if ( length > max_length )
+            return false;
+
+        if ( indices != nullptr )
+            indices->push_back ( next );
+        from = next;
+    }
+    return true;
+}
+
+
+template<unsigned short N>
+typename path_database<N>::size_type path_database<N>::point_to_index ( const ues::geom::point<N> & point ) const
+{
+    auto it = point_indices.find ( point );
+    if ( it != point_indices.end() )
+    {
+        return it->second;
+    }
+    throw ues::exc::exception ( "Point not found in path database", UES_CONTEXT );
+}
+
+
+template<unsigned short N>
+void path_database<N>::save ( std::ostream & out ) const
+{
+    using ues::misc::write_binary;
+
+    write_binary ( out, FORMAT_MAGIC );
+    write_binary ( out, FORMAT_VERSION );
+    write_binary ( out, static_cast<std::uint32_t> ( N ) );
+
+    std::vector< double > coordinates;
+    coordinates.reserve ( points.size() * N );
+    for ( const ues::geom::point<N> & p : points )
+    {
+        for ( unsigned short i = 0; i < N; ++i )
+        {
+            coordinates.push_back ( p.get ( i ) );
+        }
+    }
+    write_binary ( out, coordinates );
+    write_binary ( out, ranks );
+
+    std::vector< std::uint64_t > run_offsets ( offsets.begin(), offsets.end() );
+    std::vector< std::uint32_t > first_ranks, moves;
+    first_ranks.reserve ( runs.size() );
+    moves.reserve ( runs.size() );
+    for ( const run & r : runs )
+    {
+        first_ranks.push_back ( r.first_rank );
+        moves.push_back ( r.move );
+    }
+    write_binary ( out, run_offsets );
+    write_binary ( out, first_ranks );
+    write_binary ( out, moves );
+}
+
+
+template<unsigned short N>
+path_database<N> path_database<N>::load ( std::istream & in )
+{
+    using ues::misc::read_binary;
+
+    std::uint32_t magic, version, dimension;
+    read_binary ( in, magic );
+    read_binary ( in, version );
+    read_binary ( in, dimension );
+    if ( magic != FORMAT_MAGIC || version != FORMAT_VERSION || dimension != N )
+        throw ues::exc::exception ( "Unsupported path database format", UES_CONTEXT );
+
+    path_database<N> result;
+
+    std::vector< double > coordinates;
+    read_binary ( in, coordinates );
+    if ( coordinates.size() % N != 0 )
+        throw ues::exc::exception ( "Corrupted path database", UES_CONTEXT );
+    for ( std::size_t i = 0; i < coordinates.size(); i += N )
+    {
+        ues::geom::point<N> p;
+        for ( unsigned short j = 0; j < N; ++j )
+        {
+            p.set ( j, coordinates[i + j] );
+        }
+        result.point_indices.insert ( { p, result.points.size() } );
+        result.points.push_back ( std::move ( p ) );
+    }
+    const size_type n = result.points.size();
+
+    read_binary ( in, result.ranks );
+    if ( result.ranks.size() != n )
+        throw ues::exc::exception ( "Corrupted path database", UES_CONTEXT );
+    std::vector< bool > ranked ( n, false );
+    for ( std::uint32_t rank : result.ranks )
+    {
+        if ( rank >= n || ranked[rank] )
+            throw ues::exc::exception ( "Corrupted path database", UES_CONTEXT );
+        ranked[rank] = true;
+    }
+
+    std::vector< std::uint64_t > run_offsets;
+    std::vector< std::uint32_t > first_ranks, moves;
+    read_binary ( in, run_offsets );
+    read_binary ( in, first_ranks );
+    read_binary ( in, moves );
+    if ( run_offsets.size() != n + 1 || run_offsets.front() != 0 || run_offsets.back() != first_ranks.size() ||
+            moves.size() != first_ranks.size() )
+        throw ues::exc::exception ( "Corrupted path database", UES_CONTEXT );
+
+    // Every point must have runs, starting at rank zero and in increasing order of rank.
+    for ( size_type i = 0; i < n; ++i )
+    {
+        if ( run_offsets[i + 1] <= run_offsets[i] || first_ranks[ run_offsets[i] ] != 0 )
+            throw ues::exc::exception ( "Corrupted path database", UES_CONTEXT );
+        for ( std::uint64_t r = run_offsets[i]; r < run_offsets[i + 1]; ++r )
+        {
+            if ( ( r > run_offsets[i] && first_ranks[r] <= first_ranks[r - 1] ) || first_ranks[r] >= n ||
+                    ( moves[r] >= n && moves[r] != NO_MOVE ) )
+                throw ues::exc::exception ( "Corrupted path database", UES_CONTEXT );
+        }
+    }
+
+    result.offsets.assign ( run_offsets.begin(), run_offsets.end() );
+    result.runs.reserve ( first_ranks.size() );
+    for ( std::size_t i = 0; i < first_ranks.size(); ++i )
+    {
+        result.runs.push_back ( { first_ranks[i], moves[i] } );
+    }
+
+    return result;
+}
+
+
+// Instantiate the templates in this translation unit, just once.
+template class ues::pf::path_database<2>;
+template class ues::pf::path_database<3>;
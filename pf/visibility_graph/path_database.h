@@ -0,0 +1,167 @@
+/*
+ * Copyright 2015-2017 Guillermo Frontera <guillermo.frontera@upm.es>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#ifndef UES_PF_PATH_DATABASE_H
+#define UES_PF_PATH_DATABASE_H
+
+#include <cstdint>
+#include <istream>
+#include <ostream>
+#include <unordered_map>
+#include <vector>
+
+#include <misc/thread_pool.h>
+#include <pf/path.h>
+#include <pf/visibility_graph/point_visibility.h>
+#include <pf/visibility_graph/visibility_graph.h>
+
+namespace ues
+{
+namespace pf
+{
+
+/** The path_database class stores, for every pair of points of a visibility graph that is not
+ * going to change, the first point of a shortest path between them (compressed path database).
+ * Paths are found by following first moves, without any search. The points are numbered along
+ * a Morton curve, so the first moves from a point towards consecutive points are usually the
+ * same, and every point stores them compressed in runs. */
+template<unsigned short N>
+class path_database
+{
+public:
+    typedef typename visibility_graph<N>::size_type size_type; /**< Type used for point indices. */
+
+    /** \name Constructor methods */
+    /** \{ */
+
+    /** Builds the database of a \a graph, running a search from every point with
+     * \a number_of_threads threads (or as many as hardware threads if zero). */
+    path_database ( const visibility_graph<N> & graph, unsigned int number_of_threads = 0 );
+
+    /** Builds the database of a \a graph, running the searches in the threads of a \a pool. */
+    path_database ( const visibility_graph<N> & graph, ues::misc::thread_pool & pool );
+
+    /** \} */
+
+    /** Returns the number of points in the database. */
+    size_type size() const noexcept;
+
+    /** Returns the number of runs of first moves stored, out of the size() * size() pairs. */
+    size_type number_of_runs() const noexcept;
+
+    /** Finds the shortest path between two points of the graph. */
+    path<N> find_path ( const ues::geom::point<N> & origin,
+                        const ues::geom::point<N> & target ) const;
+
+    /** Finds the shortest path between two points among the \a obstacles the graph was built
+     * from. Points that are not in the database are attached to the points of it they see. */
+    path<N> find_path ( const point_visibility<N> & obstacles,
+                        const ues::geom::point<N> & origin,
+                        const ues::geom::point<N> & target ) const;
+
+    /** Writes the database to \a out in a binary format. */
+    void save ( std::ostream & out ) const;
+
+    /** Reads a database written with save. */
+    static path_database load ( std::istream & in );
+
+private:
+    /** The run type holds the first move from a point towards all the points from rank
+     * \a first_rank up to the first rank of the next run. */
+    struct run
+    {
+        std::uint32_t first_rank;
+        std::uint32_t move;
+    };
+
+    /** A point of the database visible from a point outside of it, together with the
+     * distance between both points. */
+    typedef std::pair< size_type, ues::math::numeric_type > attachment;
+    typedef std::vector< attachment > attachment_vector;
+
+    typedef std::vector< run > run_vector;
+    typedef std::vector< size_type > offset_vector;
+    typedef std::vector< ues::geom::point<N> > point_vector;
+    typedef std::unordered_map< ues::geom::point<N>, size_type > point_map;
+    typedef std::vector< size_type > index_vector;
+
+    /** Move stored for the points that cannot be reached. */
+    static const std::uint32_t NO_MOVE;
+
+    point_vector points;
+    point_map point_indices;
+    /** Position of every point along the Morton curve. */
+    std::vector< std::uint32_t > ranks;
+    /** Runs of every point, stored contiguously. The runs of point i are in the range
+     * [offsets[i], offsets[i + 1]). */
+    offset_vector offsets;
+    run_vector runs;
+
+    /** Constructor used when loading a database. */
+    path_database() noexcept;
+
+    /** Numbers the points of the \a graph and computes their first moves. */
+    void build ( const visibility_graph<N> & graph, ues::misc::thread_pool & pool );
+
+    /** Returns the point index of a point of the graph. */
+    size_type point_to_index ( const ues::geom::point<N> & point ) const;
+
+    /** Returns the points of the database a \a point is attached to: itself if it belongs to
+     * the database, or the ones it sees among the \a obstacles otherwise. */
+    attachment_vector attach ( const point_visibility<N> & obstacles,
+                               const ues::geom::point<N> & point ) const;
+
+    /** Returns the point that follows \a from in a shortest path towards \a to, or NO_MOVE. */
+    inline std::uint32_t first_move ( size_type from, size_type to ) const noexcept;
+
+    /** Follows the first moves from \a from to \a to, giving up if the length of the path
+     * exceeds \a max_length. Returns true and the \a length of the path, and appends its points
+     * after \a from to \a indices if given, if \a to is reached in time. */
+    bool walk ( size_type from,
+                size_type to,
+                ues::math::numeric_type max_length,
+                ues::math::numeric_type & length,
+                index_vector * indices = nullptr ) const;
+};
+
+
+// Template implementation.
+
+
+template<unsigned short N>
+std::uint32_t path_database<N>::first_move ( size_type from, size_type to ) const noexcept
+{
+    // The run that covers the target is the last one starting at or before its rank. The first
+    // run of every point starts at rank zero.
+    const run * first = runs.data() + offsets[from];
+    const run * last = runs.data() + offsets[from + 1];
+    const std::uint32_t rank = ranks[to];
+    while ( last - first > 1 )
+    {
+        const run * middle = first + ( last - first ) / 2;
+        if ( middle->first_rank <= rank )
+            first = middle;
+        else
+            last = middle;
+    }
+    return first->move;
+}
+
+}
+}
+
+#endif // UES_PF_PATH_DATABASE_H
@@ -0,0 +1,52 @@
+/*
+ * Copyright 2015-2017 Guillermo Frontera <guillermo.frontera@upm.es>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+#ifndef UES_PF_POINT_VISIBILITY_H
+#define UES_PF_POINT_VISIBILITY_H
+
+#include <vector>
+
+#include <geom/point.h>
+
+namespace ues
+{
+namespace pf
+{
+
+/** The point_visibility class computes visibility among some obstacles from points that need
+ * not be vertices of them, so points outside a preprocessed graph can be attached to it. */
+template<unsigned short N>
+class point_visibility
+{
+public:
+    typedef std::vector< ues::geom::point<N> > point_vector;
+
+    /** Destructor method. */
+    virtual ~point_visibility() noexcept = default;
+
+    /** Fills \a visible with the vertices of the obstacles visible from \a viewpoint. */
+    virtual void visible_vertices ( const ues::geom::point<N> & viewpoint,
+                                    point_vector & visible ) const = 0;
+
+    /** Checks whether \a point1 and \a point2 see each other among the obstacles. */
+    virtual bool check_visibility ( const ues::geom::point<N> & point1,
+                                    const ues::geom::point<N> & point2 ) const = 0;
+};
+
+}
+}
+
+#endif // UES_PF_POINT_VISIBILITY_H
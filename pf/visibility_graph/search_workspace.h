@@ -0,0 +1,115 @@
+/*
+ * Copyright 2015-2017 Guillermo Frontera <guillermo.frontera@upm.es>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#ifndef UES_PF_SEARCH_WORKSPACE_H
+#define UES_PF_SEARCH_WORKSPACE_H
+
+#include <unordered_set>
+#include <unordered_map>
+#include <vector>
+
+#include <boost/heap/fibonacci_heap.hpp>
+
+#include <pf/search_statistics.h>
+#include <pf/visibility_graph/visibility_graph.h>
+
+namespace ues
+{
+namespace pf
+{
+
+/** The search_workspace contains the data structures used by a single graph search. Reusing
+ * a workspace across queries avoids reallocating them, and giving each thread its own
+ * workspace allows several searches to run concurrently over the same graph. */
+template<unsigned short N>
+struct search_workspace
+{
+    typedef typename visibility_graph<N>::size_type size_type; /**< Type used for point indices. */
+
+    /** The state type contains a point index and the estimated cost of such point.*/
+    struct state
+    {
+        size_type point_index;
+        ues::math::numeric_type accumulated_cost;
+        ues::math::numeric_type estimated_cost;
+    };
+
+    /** The lazy_state type contains a point index, the index of the point it is reached from
+     * and the estimated cost of such point. The edge between both points is not validated
+     * until the state is extracted from the queue. */
+    struct lazy_state
+    {
+        size_type point_index;
+        size_type parent_index;
+        ues::math::numeric_type accumulated_cost;
+        ues::math::numeric_type estimated_cost;
+    };
+
+    /** The state_comparator class contains the required comparator method so the
+     * states are sorted in the desired order in the priority queue. */
+    struct state_comparator
+    {
+        template<class S>
+        bool operator() ( const S & one, const S & two ) const noexcept
+        {
+            return one.estimated_cost > two.estimated_cost;
+        }
+    };
+
+    /** The priority_queue stores and keeps a sorted list of state objects. */
+    typedef boost::heap::fibonacci_heap< state, boost::heap::compare< state_comparator > > priority_queue;
+    /** Binary heap of lazy states, ordered with the state_comparator. A point may have several
+     * entries, one per candidate edge that reaches it. */
+    typedef std::vector< lazy_state > lazy_priority_queue;
+    /** The index_set contains all the points whose cost has already been computed. */
+    typedef std::unordered_set< size_type > index_set;
+    /** Stores the handles that allow modifying the states of the priority queue. */
+    typedef std::unordered_map< size_type, typename priority_queue::handle_type > handle_storage;
+    /** Stores the point from which current point has been reached. */
+    typedef std::vector< size_type > parent_point;
+
+    priority_queue frontier;
+    lazy_priority_queue lazy_frontier;
+    handle_storage handles;
+    index_set explored;
+    parent_point parents;
+    /** Statistics of the last search run with the workspace. */
+    search_statistics statistics;
+
+    /** Prepares the workspace for a new search over a graph with \a graph_size points. */
+    inline void reset ( size_type graph_size );
+};
+
+
+// Template implementation.
+
+
+template<unsigned short N>
+void search_workspace<N>::reset ( size_type graph_size )
+{
+    frontier.clear();
+    lazy_frontier.clear();
+    handles.clear();
+    explored.clear();
+    parents.resize ( graph_size );
+    statistics = search_statistics();
+}
+
+}
+}
+
+#endif // UES_PF_SEARCH_WORKSPACE_H
@@ -0,0 +1,204 @@
+/*
+ * Copyright 2015-2017 Guillermo Frontera <guillermo.frontera@upm.es>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#ifndef UES_PF_STATIC_GRAPH_PATHFINDER_H
+#define UES_PF_STATIC_GRAPH_PATHFINDER_H
+
+#include <memory>
+
+#include <exc/exception.h>
+
+#include <pf/ellipse_bound.h>
+#include <pf/path.h>
+#include <pf/visibility_graph/graph_pathfinder.h>
+#include <pf/visibility_graph/graph_search.h>
+#include <pf/visibility_graph/landmark_heuristic.h>
+#include <pf/visibility_graph/search_workspace.h>
+
+namespace ues
+{
+namespace pf
+{
+
+/** The static_graph_pathfinder runs the same searches as graph_pathfinder, with the same
+ * graph_search, but it is bound at compile time to the concrete type of the graph, so the
+ * accesses to the graph in the innermost loop can be inlined instead of going through the
+ * virtual interface. The Graph type must provide:
+ *  - size_type size() const, the number of points of the graph.
+ *  - size_type index_of ( const ues::geom::point<N> & ) const, throwing if the point is missing.
+ *  - const ues::geom::point<N> & point_at ( size_type ) const.
+ *  - void for_each_neighbour ( size_type, F && fn ) const, calling fn ( neighbour, weight ).
+ * The vg2d and vg3d visibility graphs and mapped_visibility_graph meet these requirements. As
+ * their edges are cheap to check, lazy evaluation uses every neighbour as a valid candidate. */
+template<unsigned short N, class Graph>
+class static_graph_pathfinder
+{
+public:
+    typedef typename search_workspace<N>::size_type size_type; /**< Type used for point indices. */
+    typedef typename graph_pathfinder<N>::edge_evaluation edge_evaluation;
+
+    /** Constructor method receiving a visibility graph. */
+    static_graph_pathfinder ( std::shared_ptr< const Graph > graph );
+
+    /** Returns the strategy used to evaluate the edges of the graph. */
+    edge_evaluation get_edge_evaluation() const noexcept;
+
+    /** Changes the strategy used to evaluate the edges of the graph. */
+    void set_edge_evaluation ( edge_evaluation evaluation ) noexcept;
+
+    /** Combines the straight-line distance heuristic with the lower bounds of the \a landmarks,
+     * which must have been computed for the same graph. A null pointer restores the
+     * straight-line distance alone. */
+    void set_landmark_heuristic ( std::shared_ptr< const landmark_heuristic<N> > landmarks );
+
+    /** Returns the weight applied to the heuristic. */
+    ues::math::numeric_type get_heuristic_weight() const noexcept;
+
+    /** Changes the weight applied to the heuristic (weighted A*), which must not be lower
+     * than 1. */
+    void set_heuristic_weight ( ues::math::numeric_type weight );
+
+    /** Finds a path between two points using the provided visibility graph. */
+    path<N> find_path ( const ues::geom::point<N> & origin,
+                        const ues::geom::point<N> & target ) const;
+
+    /** Finds a path between two points using the provided visibility graph and the buffers
+     * of \a workspace. Searches with different workspaces may run concurrently. */
+    path<N> find_path ( const ues::geom::point<N> & origin,
+                        const ues::geom::point<N> & target,
+                        search_workspace<N> & workspace ) const;
+
+    /** Finds a path like the other overloads, discarding the points that cannot be on a path
+     * within the \a bound, which must have been built for the same origin and target. */
+    path<N> find_path ( const ues::geom::point<N> & origin,
+                        const ues::geom::point<N> & target,
+                        search_workspace<N> & workspace,
+                        const ellipse_bound<N> & bound ) const;
+
+private:
+    /** Exposes the non-virtual members of the Graph with the names used by graph_search. */
+    class graph_view
+    {
+    public:
+        graph_view ( const Graph & graph ) noexcept : graph ( graph ) {}
+        size_type size() const noexcept { return graph.size(); }
+        size_type point_to_index ( const ues::geom::point<N> & point ) const { return graph.index_of ( point ); }
+        const ues::geom::point<N> & index_to_point ( size_type point_index ) const noexcept { return graph.point_at ( point_index ); }
+        template<class F>
+        void for_each_adjacent ( size_type point_index, F && fn ) const { graph.for_each_neighbour ( point_index, fn ); }
+        template<class F>
+        void for_each_candidate_adjacent ( size_type point_index, F && fn ) const { graph.for_each_neighbour ( point_index, fn ); }
+        bool validate_candidate ( size_type, size_type ) const noexcept { return true; }
+    private:
+        const Graph & graph;
+    };
+
+    std::shared_ptr< const Graph > graph;
+    edge_evaluation evaluation;
+    std::shared_ptr< const landmark_heuristic<N> > landmarks;
+    ues::math::numeric_type heuristic_weight;
+};
+
+
+// Template implementation.
+
+
+template<unsigned short N, class Graph>
+static_graph_pathfinder<N, Graph>::static_graph_pathfinder ( std::shared_ptr< const Graph > graph )
+    : graph ( std::move ( graph ) ),
+      evaluation ( graph_pathfinder<N>::EAGER_EVALUATION ),
+      heuristic_weight ( 1 )
+{
+    if ( this->graph.get() == nullptr )
+        throw ues::exc::exception ( "Provided graph cannot be null", UES_CONTEXT );
+}
+
+
+template<unsigned short N, class Graph>
+typename static_graph_pathfinder<N, Graph>::edge_evaluation static_graph_pathfinder<N, Graph>::get_edge_evaluation() const noexcept
+{
+    return evaluation;
+}
+
+
+template<unsigned short N, class Graph>
+void static_graph_pathfinder<N, Graph>::set_edge_evaluation ( edge_evaluation evaluation ) noexcept
+{
+    this->evaluation = evaluation;
+}
+
+
+template<unsigned short N, class Graph>
+void static_graph_pathfinder<N, Graph>::set_landmark_heuristic ( std::shared_ptr< const landmark_heuristic<N> > landmarks )
+{
+    if ( landmarks && landmarks->size() != graph->size() )
+        throw ues::exc::exception ( "Landmarks were computed for a different graph", UES_CONTEXT );
+
+    this->landmarks = std::move ( landmarks );
+}
+
+
+template<unsigned short N, class Graph>
+ues::math::numeric_type static_graph_pathfinder<N, Graph>::get_heuristic_weight() const noexcept
+{
+    return heuristic_weight;
+}
+
+
+template<unsigned short N, class Graph>
+void static_graph_pathfinder<N, Graph>::set_heuristic_weight ( ues::math::numeric_type weight )
+{
+    if ( weight < 1 )
+        throw ues::exc::exception ( "Heuristic weight cannot be lower than 1", UES_CONTEXT );
+
+    heuristic_weight = weight;
+}
+
+
+template<unsigned short N, class Graph>
+path<N> static_graph_pathfinder<N, Graph>::find_path ( const ues::geom::point<N> & origin,
+                                                       const ues::geom::point<N> & target ) const
+{
+    search_workspace<N> workspace;
+    return find_path ( origin, target, workspace );
+}
+
+
+template<unsigned short N, class Graph>
+path<N> static_graph_pathfinder<N, Graph>::find_path ( const ues::geom::point<N> & origin,
+                                                       const ues::geom::point<N> & target,
+                                                       search_workspace<N> & workspace ) const
+{
+    return find_path ( origin, target, workspace, ellipse_bound<N> ( origin, target ) );
+}
+
+
+template<unsigned short N, class Graph>
+path<N> static_graph_pathfinder<N, Graph>::find_path ( const ues::geom::point<N> & origin,
+                                                       const ues::geom::point<N> & target,
+                                                       search_workspace<N> & workspace,
+                                                       const ellipse_bound<N> & bound ) const
+{
+    const graph_view view ( *graph );
+    const graph_search< N, graph_view > search ( view, landmarks.get(), heuristic_weight );
+    return search.find_path ( origin, target, workspace, bound, evaluation == graph_pathfinder<N>::LAZY_EVALUATION );
+}
+
+}
+}
+
+#endif // UES_PF_STATIC_GRAPH_PATHFINDER_H
@@ -25,9 +25,6 @@ namespace ues
 namespace pf
 {
 
-template<unsigned short N>
-class graph_pathfinder; /* Forward declaration. */
-
 template<unsigned short N>
 class visibility_graph
 {
@@ -49,10 +46,16 @@ public:
 
     /** Prints the visibility matrix to the \a out parameter. */
     virtual void describe ( std::ostream & out ) const noexcept = 0;
-protected:
-    friend class graph_pathfinder<N>;
 
-    typedef std::vector< size_type > point_index_vector;
+    /** The edge_visitor receives the points adjacent to a point, together with the cost of the
+     * edges that lead to them. */
+    class edge_visitor
+    {
+    public:
+        virtual void visit ( size_type neighbour_index, ues::math::numeric_type weight ) = 0;
+    protected:
+        ~edge_visitor() = default;
+    };
 
     /** Returns the index assigned to a point. */
     virtual size_type point_to_index ( const ues::geom::point<N> & point ) const = 0;
@@ -66,9 +69,48 @@ protected:
                                     size_type point2_index,
                                     ues::math::numeric_type & distance ) const = 0;
 
-    /** Returns a vector containing all the point indices corresponding to points that are
-     * visible from the point of index \a point_index. */
-    virtual point_index_vector adjacents ( size_type point_index ) const = 0;
+    /** Calls the \a visitor for every point visible from the point of index \a point_index,
+     * without allocating any memory. */
+    virtual void visit_adjacents ( size_type point_index, edge_visitor & visitor ) const = 0;
+
+    /** Calls the \a visitor for every point that may be visible from the point of index
+     * \a point_index, with the cost the edge would have if it were valid. Candidate edges must
+     * be checked with validate_candidate before being used. Graphs whose edges are expensive to
+     * check should report cheap candidates here. By default, the adjacent points are reported. */
+    virtual void visit_candidate_adjacents ( size_type point_index, edge_visitor & visitor ) const;
+
+    /** Returns true if the candidate edge between the points of indices \a point1_index and
+     * \a point2_index is valid. By default, all the candidate edges are valid. */
+    virtual bool validate_candidate ( size_type point1_index, size_type point2_index ) const;
+
+    /** Hints the graph that the points adjacent to the point of index \a point_index will be
+     * visited soon, so it can prefetch the memory involved. By default, it does nothing. */
+    virtual void prefetch_adjacents ( size_type point_index ) const noexcept;
+
+    /** Calls \a fn ( neighbour_index, weight ) for every point visible from the point of index
+     * \a point_index. */
+    template<class F>
+    inline void for_each_adjacent ( size_type point_index, F && fn ) const;
+
+    /** Calls \a fn ( neighbour_index, weight ) for every candidate adjacent to the point of index
+     * \a point_index. */
+    template<class F>
+    inline void for_each_candidate_adjacent ( size_type point_index, F && fn ) const;
+
+private:
+    /** Adapts any callable object to the edge_visitor interface. */
+    template<class F>
+    class function_edge_visitor final : public edge_visitor
+    {
+    public:
+        function_edge_visitor ( F & fn ) noexcept : fn ( fn ) {}
+        void visit ( size_type neighbour_index, ues::math::numeric_type weight ) override
+        {
+            fn ( neighbour_index, weight );
+        }
+    private:
+        F & fn;
+    };
 };
 
 
@@ -92,6 +134,44 @@ bool visibility_graph<N>::check_visibility ( const ues::geom::point<N> & point1,
 }
 
 
+template<unsigned short N>
+template<class F>
+void visibility_graph<N>::for_each_adjacent ( size_type point_index, F && fn ) const
+{
+    function_edge_visitor< typename std::remove_reference<F>::type > visitor ( fn );
+    visit_adjacents ( point_index, visitor );
+}
+
+
+template<unsigned short N>
+template<class F>
+void visibility_graph<N>::for_each_candidate_adjacent ( size_type point_index, F && fn ) const
+{
+    function_edge_visitor< typename std::remove_reference<F>::type > visitor ( fn );
+    visit_candidate_adjacents ( point_index, visitor );
+}
+
+
+template<unsigned short N>
+void visibility_graph<N>::visit_candidate_adjacents ( size_type point_index, edge_visitor & visitor ) const
+{
+    visit_adjacents ( point_index, visitor );
+}
+
+
+template<unsigned short N>
+bool visibility_graph<N>::validate_candidate ( size_type, size_type ) const
+{
+    return true;
+}
+
+
+template<unsigned short N>
+void visibility_graph<N>::prefetch_adjacents ( size_type ) const noexcept
+{
+}
+
+
 /** Output stream operator. */
 template<unsigned short N>
 std::ostream & operator<< ( std::ostream & out, const ues::pf::visibility_graph<N> & graph ) noexcept
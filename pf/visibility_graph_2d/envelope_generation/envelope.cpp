@@ -17,7 +17,7 @@
 
 #include "envelope.h"
 
-#include <cmath>
+#include <cassert>
 #include <limits>
 
 #include <log/logger.h>
@@ -27,45 +27,27 @@ using namespace ues::pf::vg2d;
 const std::string component_name = "Envelope";
 
 
-envelope::envelope ( point_rank rank_count ) noexcept
-    : sdl ( { { NULL_SEGMENT_INDEX, std::numeric_limits<point_rank>::max() } } ),
-      right_zeros ( 1 << ( static_cast< unsigned int > ( std::ceil ( std::log2 ( rank_count ) ) ) + 1 ) ),
-      random_access ( std::ceil ( std::log2 ( rank_count ) ) + 1, sdl.end() ),
-      present_ranks_vector ( 0 )
+envelope::envelope() noexcept
+    : present_groups ( 0 )
 {
-    random_access.push_back ( sdl.begin() );
-
-    point_rank exponential = 1;
-    point_rank power = 0;
-    while ( exponential <= right_zeros.size() )
-    {
-        point_rank next_exponential = exponential << 1;
-        for ( point_rank i = exponential; i <= right_zeros.size(); i += next_exponential )
-        {
-            right_zeros[i - 1] = power;
-        }
-        ++power;
-        exponential = next_exponential;
-    }
+    nodes[SENTINEL_NODE].data = { NULL_SEGMENT_INDEX, std::numeric_limits<point_rank>::max() };
+    clear();
 }
 
 
 envelope::iterator
 envelope::shortest_as_long_as ( const segment_data & s ) noexcept
 {
-    // Mask the present_ranks_vector so that only segments as long as
+    // Mask the present groups so that only segments as long as
     // the one provided are shown.
-    point_rank index = ~ ( ( 1 << right_zeros[ s.rank ] ) - 1 );
-    index &= present_ranks_vector;
-    if ( index )
+    const std::uint64_t longer_groups = present_groups & ( ~std::uint64_t ( 0 ) << group ( s.rank ) );
+    if ( longer_groups )
     {
-        unsigned int pos = right_zeros[ index - 1 ];
-        assert ( random_access.at ( pos ) != sdl.end() );
-        return random_access[pos];
+        return iterator ( &nodes[ 2 + ues::misc::count_trailing_zeros ( longer_groups ) ] );
     }
     else
     {
-        return random_access.back();
+        return iterator ( &nodes[SENTINEL_NODE] );
     }
 }
 
@@ -73,14 +55,14 @@ envelope::shortest_as_long_as ( const segment_data & s ) noexcept
 envelope::iterator
 envelope::pred ( iterator it ) const
 {
-    return --it;
+    return iterator ( const_cast< node * > ( &nodes[ it.current->prev ] ) );
 }
 
 
 envelope::iterator
 envelope::head() noexcept
 {
-    return sdl.begin();
+    return iterator ( &nodes[ nodes[END_NODE].next ] );
 }
 
 
@@ -88,25 +70,30 @@ void envelope::insert ( segment_data s, iterator it )
 {
     ues::log::logger lg;
 
-    if ( it == sdl.end() || it->segment != NULL_SEGMENT_INDEX )
+    // The new segment goes after the given one, or before the sentinel.
+    node_index next = it.current - nodes.data();
+    if ( next == END_NODE || it->segment != NULL_SEGMENT_INDEX )
     {
-        ++it;
+        next = nodes[next].next;
     }
 
-    unsigned int rz = right_zeros.at ( s.rank );
-    assert ( ! ( present_ranks_vector & ( 1 << rz ) ) );
-    present_ranks_vector |= 1 << rz;
-    sdl.insert ( it, std::move ( s ) );
-    random_access[rz] = --it;
+    const unsigned int g = group ( s.rank );
+    assert ( ! ( present_groups & ( std::uint64_t ( 1 ) << g ) ) );
+    present_groups |= std::uint64_t ( 1 ) << g;
+
+    const node_index current = 2 + g;
+    nodes[current] = { std::move ( s ), nodes[next].prev, next };
+    nodes[ nodes[next].prev ].next = current;
+    nodes[next].prev = current;
 
     if ( lg.min_level() <= ues::log::TRACE_LVL )
     {
         ues::log::event e ( ues::log::TRACE_LVL, component_name, "Contents of envelope after insertion" );
-        if ( !sdl.empty() )
+        for ( node_index i = nodes[END_NODE].next; i != SENTINEL_NODE; i = nodes[i].next )
         {
-            std::for_each ( sdl.begin(), sdl.end(), [&e] ( const segment_data & sd ) { if ( sd.segment != NULL_SEGMENT_INDEX ) e.message() << "( " << sd.segment << ", " << sd.rank << " ) "; } );
-            e.message() << '\n';
+            e.message() << "( " << nodes[i].data.segment << ", " << nodes[i].data.rank << " ) ";
         }
+        e.message() << '\n';
         lg.record ( std::move ( e ) );
     }
 
@@ -117,20 +104,20 @@ void envelope::erase ( iterator it )
 {
     ues::log::logger lg;
 
-    unsigned int rz = right_zeros.at ( it->rank );
-    assert ( present_ranks_vector & ( 1 << rz ) );
-    present_ranks_vector &= ~ ( 1 << rz );
-    sdl.erase ( it );
-    random_access[rz] = sdl.end();
+    const unsigned int g = group ( it->rank );
+    assert ( present_groups & ( std::uint64_t ( 1 ) << g ) );
+    present_groups &= ~ ( std::uint64_t ( 1 ) << g );
+    nodes[ it.current->prev ].next = it.current->next;
+    nodes[ it.current->next ].prev = it.current->prev;
 
     if ( lg.min_level() <= ues::log::TRACE_LVL )
     {
         ues::log::event e ( ues::log::TRACE_LVL, component_name, "Contents of envelope after deletion" );
-        if ( !sdl.empty() )
+        for ( node_index i = nodes[END_NODE].next; i != SENTINEL_NODE; i = nodes[i].next )
         {
-            std::for_each ( sdl.begin(), sdl.end(), [&e] ( const segment_data & sd ) { if ( sd.segment != NULL_SEGMENT_INDEX ) e.message() << "( " << sd.segment << ", " << sd.rank << " ) "; } );
-            e.message() << '\n';
+            e.message() << "( " << nodes[i].data.segment << ", " << nodes[i].data.rank << " ) ";
         }
+        e.message() << '\n';
         lg.record ( std::move ( e ) );
     }
 
@@ -139,13 +126,22 @@ void envelope::erase ( iterator it )
 
 envelope::iterator envelope::end() noexcept
 {
-    return sdl.end();
+    return iterator ( &nodes[END_NODE] );
 }
 
 
 bool envelope::empty() const noexcept
 {
-    return sdl.front().segment == NULL_SEGMENT_INDEX;
+    return nodes[END_NODE].next == SENTINEL_NODE;
+}
+
+
+void envelope::clear() noexcept
+{
+    nodes[END_NODE] = { { NULL_SEGMENT_INDEX, 0 }, SENTINEL_NODE, SENTINEL_NODE };
+    nodes[SENTINEL_NODE].prev = END_NODE;
+    nodes[SENTINEL_NODE].next = END_NODE;
+    present_groups = 0;
 }
 
 
@@ -18,8 +18,12 @@
 #ifndef UES_PF_VG2D_ENVELOPE_H
 #define UES_PF_VG2D_ENVELOPE_H
 
-#include <list>
+#include <array>
+#include <cassert>
+#include <cstdint>
+#include <limits>
 
+#include <misc/bits.h>
 #include <pf/visibility_graph_2d/util/definitions.h>
 
 namespace ues
@@ -29,20 +33,49 @@ namespace pf
 namespace vg2d
 {
 
+/** The envelope class keeps the segments nearest to the origin, sorted from the shortest to the
+ * longest, and finds the shortest segment as long as any other in constant time. Segments are
+ * grouped by the number of trailing zeros of their rank plus one, and at most one segment of each
+ * group is in the envelope, so the segments are kept in a fixed array of linked nodes, one per
+ * group, and the groups present in a bitset. Ranks of any size fit, and no memory is allocated. */
 class envelope
 {
 public:
-    /** Constructor method giving the maximum possible rank. */
-    envelope ( point_rank rank_count ) noexcept;
+    /** Constructor method of an empty envelope. */
+    envelope() noexcept;
     /** Destructor method. */
     virtual ~envelope() noexcept = default;
 
     /** Contains the index of the segment and the rank of the last of its points. */
     struct segment_data { segment_index segment; point_rank rank; };
-    /** Contains segment data for a series of points. */
-    typedef std::list< segment_data > segment_data_list;
-    /** Iterator to move around a segment data list. */
-    typedef segment_data_list::iterator iterator; //< FIXME Use const_iterator when libstdc++ implementation supports it.
+
+private:
+    /** Index of a node in the node array. */
+    typedef unsigned int node_index;
+    /** Node of the circular list of segments, linked to its neighbours by their index. */
+    struct node { segment_data data; node_index prev; node_index next; };
+
+public:
+    /** Iterator to move around the segments of an envelope. It remains valid until its
+     * segment is erased, or the envelope is cleared or destroyed. */
+    class iterator
+    {
+    public:
+        iterator() noexcept = default;
+
+        segment_data & operator* () const noexcept { return current->data; }
+        segment_data * operator-> () const noexcept { return &current->data; }
+
+        bool operator== ( const iterator & other ) const noexcept { return current == other.current; }
+        bool operator!= ( const iterator & other ) const noexcept { return current != other.current; }
+
+    private:
+        friend class envelope;
+
+        iterator ( node * current ) noexcept : current ( current ) {}
+
+        node * current;
+    };
 
     virtual iterator head() noexcept;
     virtual iterator end() noexcept;
@@ -55,17 +88,40 @@ public:
 
     virtual bool empty() const noexcept;
 
-protected:
-
-    segment_data_list sdl;
+    /** Removes all the segments, so the envelope can be used for another origin. */
+    virtual void clear() noexcept;
 
-    std::vector< unsigned int > right_zeros;
-    std::vector< segment_data_list::iterator > random_access;
-    point_rank present_ranks_vector;
+protected:
+    /** Number of groups of ranks, one per possible number of trailing zeros. */
+    static const unsigned int GROUPS = std::numeric_limits< point_rank >::digits;
+    /** Node before the first segment and after the last one. */
+    static const node_index END_NODE = 0;
+    /** Node after all the segments, longer than any of them. */
+    static const node_index SENTINEL_NODE = 1;
+
+    /** The end node, the sentinel node and the node of every group. */
+    std::array< node, GROUPS + 2 > nodes;
+    /** Bit i is set if a segment of the i-th group is in the envelope. */
+    std::uint64_t present_groups;
+
+    /** Returns the group of the segments whose last point has rank \a rank. */
+    static inline unsigned int group ( point_rank rank ) noexcept;
+
+    static_assert ( GROUPS <= 64, "The groups present must fit in a 64-bit word" );
 };
 
 bool operator== ( const envelope::segment_data &, const envelope::segment_data & ) noexcept;
 
+
+// Inlined methods.
+
+unsigned int envelope::group ( point_rank rank ) noexcept
+{
+    // The rank plus one cannot overflow.
+    assert ( rank < std::numeric_limits<point_rank>::max() );
+    return ues::misc::count_trailing_zeros ( rank + 1 );
+}
+
 }
 }
 }
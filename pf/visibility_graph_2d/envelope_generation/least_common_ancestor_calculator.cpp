@@ -17,74 +17,65 @@
 
 #include "least_common_ancestor_calculator.h"
 
+#include <algorithm>
 #include <cassert>
+#include <cstdint>
+
+#include <misc/bits.h>
 
 using namespace ues::pf::vg2d;
 
 
+namespace
+{
+
+/** Returns a mask with \a n ones to the right. */
+inline std::uint64_t right_ones ( unsigned int n ) noexcept
+{
+    return n < 64 ? ( std::uint64_t ( 1 ) << n ) - 1 : ~std::uint64_t ( 0 );
+}
+
+}
+
+
 least_common_ancestor_calculator::least_common_ancestor_calculator ( integer_type tree_size ) noexcept
 :
-least_significant_one ( tree_size ),
-                      most_significant_one ( tree_size )
+size ( tree_size )
 {
-    // Linear time initialization.
-    integer_type exponential = 1;
-    integer_type power = 0;
-    while ( exponential <= tree_size )
-    {
-        // Save information regarding the most significant bit.
-        integer_type next_exponential = exponential << 1;
-        for ( integer_type i = exponential; i <= tree_size && i < next_exponential; ++i )
-        {
-            most_significant_one[i - 1] = power;
-        }
-
-        for ( integer_type i = exponential; i <= tree_size; i += next_exponential )
-        {
-            least_significant_one[i - 1] = power;
-        }
-
-        // Create a mask with "power" ones to the right.
-        mask.push_back ( exponential - 1 );
-
-        exponential = next_exponential;
-        ++power;
-    }
-
-    // Create a mask with "power" ones to the right.
-    mask.push_back ( exponential - 1 );
 }
 
 
 least_common_ancestor_calculator::integer_type
 least_common_ancestor_calculator::compute ( integer_type x, integer_type y ) const
 {
+    assert ( 0 < x && x <= size );
+    assert ( 0 < y && y <= size );
+
     // Rightmost (least significant) one in x and y.
-    const integer_type x_lso = least_significant_one[x - 1];
-    const integer_type y_lso = least_significant_one[y - 1];
+    const unsigned int x_lso = ues::misc::count_trailing_zeros ( x );
+    const unsigned int y_lso = ues::misc::count_trailing_zeros ( y );
 
     // Leftmost (most significant) bit in which x and y differ.
-    const integer_type most_significant_index = std::min ( x ^ y, static_cast< integer_type > ( most_significant_one.size() ) );
-    const integer_type diff_xy = most_significant_one[ ( most_significant_index > 0 ) ? most_significant_index - 1 : 0 ];
+    const unsigned int diff_xy = ( x != y ) ? 63 - ues::misc::count_leading_zeros ( x ^ y ) : 0;
 
-    const integer_type n_of_bits = std::max ( diff_xy, std::max ( x_lso, y_lso ) );
+    const unsigned int n_of_bits = std::max ( diff_xy, std::max ( x_lso, y_lso ) );
 
-    integer_type result;
+    std::uint64_t result;
     if ( n_of_bits == y_lso )
     {
-        result = ~mask[n_of_bits + 1] & y;
+        result = ~right_ones ( n_of_bits + 1 ) & y;
     }
     else
     {
-        result = ~mask[n_of_bits + 1] & x;
+        result = ~right_ones ( n_of_bits + 1 ) & x;
     }
 
-    result |= mask[n_of_bits + 1] & ~mask[n_of_bits];
+    result |= right_ones ( n_of_bits + 1 ) & ~right_ones ( n_of_bits );
 
     // Two simple assertions to check the result is not
     // out of the range of the expected value.
     assert ( x <= result );
     assert ( result <= y );
 
-    return result;
+    return static_cast< integer_type > ( result );
 }
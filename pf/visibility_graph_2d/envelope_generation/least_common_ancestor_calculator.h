@@ -18,9 +18,6 @@
 #ifndef UES_PF_VG2D_LEAST_COMMON_ANCESTOR_CALCULATOR_H
 #define UES_PF_VG2D_LEAST_COMMON_ANCESTOR_CALCULATOR_H
 
-#include <exception>
-#include <vector>
-
 namespace ues
 {
 namespace pf
@@ -28,6 +25,9 @@ namespace pf
 namespace vg2d
 {
 
+/** The least_common_ancestor_calculator class finds the least common ancestor of two nodes of a
+ * complete binary tree numbered in order, in constant time, with the bit scan instructions of the
+ * processor. */
 class least_common_ancestor_calculator
 {
 public:
@@ -38,9 +38,7 @@ public:
     integer_type compute ( integer_type, integer_type ) const;
 
 private:
-    std::vector< integer_type > least_significant_one;
-    std::vector< integer_type > most_significant_one;
-    std::vector< integer_type > mask;
+    integer_type size;
 };
 
 }
@@ -17,7 +17,6 @@
 
 #include "visibility_problem_solver.h"
 
-#include <unordered_map>
 #include <unordered_set>
 
 #include <log/logger.h>
@@ -34,7 +33,7 @@ namespace
 /** For each rank, contains the segment visible between ranks i and i+1. */
 typedef std::vector< segment_index > visible_segment_vector;
 /** Contains the segment indices to those segments that start or end at a given rank. */
-typedef std::unordered_multimap< point_rank, segment_index > rank_to_segment;
+typedef visibility_problem_solver::rank_to_segment rank_to_segment;
 }
 
 const std::string component_name = "2D Visibility Graph Solver";
@@ -43,12 +42,12 @@ const std::string component_name = "2D Visibility Graph Solver";
 ues::math::numeric_type distance ( const point_index origin,
                         const segment_index target,
                         const ues::math::numeric_type angle,
-                        const point_vector & points,
-                        const segment_vector & segments )
+                        const scenario_overlay & overlay )
 {
-    return ues::geom::point_to_segment_distance ( points[origin],
-                                                  points[segments[target].first],
-                                                  points[segments[target].second],
+    const segment target_segment = overlay.get_segment ( target );
+    return ues::geom::point_to_segment_distance ( overlay.get_point ( origin ),
+                                                  overlay.get_point ( target_segment.first ),
+                                                  overlay.get_point ( target_segment.second ),
                                                   angle + ues::math::pi / 2,
                                                   2e-3 );
 }
@@ -57,8 +56,7 @@ ues::math::numeric_type distance ( const point_index origin,
 segment_index nearest_segment ( const point_index origin,
                                 const segment_index segment1,
                                 const segment_index segment2,
-                                const point_vector & points,
-                                const segment_vector & segments,
+                                const scenario_overlay & overlay,
                                 const angle_vector & angles,
                                 const visibility_problem_solver::segment_rank_vector & segment_ranks )
 {
@@ -87,8 +85,8 @@ segment_index nearest_segment ( const point_index origin,
         throw ues::exc::exception ( "The two segments provided cannot be compared as they do not overlap", UES_CONTEXT );
     }
 
-    ues::math::numeric_type dist_seg1 = distance ( origin, segment1, angles[min_rank], points, segments );
-    ues::math::numeric_type dist_seg2 = distance ( origin, segment2, angles[min_rank], points, segments );
+    ues::math::numeric_type dist_seg1 = distance ( origin, segment1, angles[min_rank], overlay );
+    ues::math::numeric_type dist_seg2 = distance ( origin, segment2, angles[min_rank], overlay );
 
     if ( dist_seg1 + ues::math::epsilon < dist_seg2 )
     {
@@ -118,8 +116,8 @@ segment_index nearest_segment ( const point_index origin,
         {
             // If the segments are connected by one point and overlap at more than
             // that one point, then the nearest one must be found and returned.
-            ues::math::numeric_type dist_seg1 = distance ( origin, segment1, angles[max_rank], points, segments );
-            ues::math::numeric_type dist_seg2 = distance ( origin, segment2, angles[max_rank], points, segments );
+            ues::math::numeric_type dist_seg1 = distance ( origin, segment1, angles[max_rank], overlay );
+            ues::math::numeric_type dist_seg2 = distance ( origin, segment2, angles[max_rank], overlay );
 
             if ( dist_seg1 + ues::math::epsilon < dist_seg2 )
             {
@@ -138,43 +136,68 @@ segment_index nearest_segment ( const point_index origin,
 }
 
 
-rank_to_segment generate_rank_to_segment ( const segment_vector & segments,
-                                           point_index origin,
-                                           visibility_problem_solver::segment_rank_vector segment_ranks )
+void generate_rank_to_segment ( const scenario_overlay & overlay,
+                                point_index origin,
+                                const visibility_problem_solver::segment_rank_vector & segment_ranks,
+                                point_rank rank_count,
+                                rank_to_segment & result )
 {
-    rank_to_segment result;
-
-    // Traverse all segments.
-    for ( segment_vector::size_type i = 0; i < segments.size(); ++i )
+    // Count the segments at every rank. Buffers are reused from a previous call, if any.
+    result.offsets.assign ( rank_count + 1, 0 );
+    for ( segment_index i = 0; i < overlay.get_segment_count(); ++i )
     {
         // Do not include any segment that starts or ends at current point.
-        if ( segments[i].first != origin && segments[i].second != origin )
+        const segment s = overlay.get_segment ( i );
+        if ( s.first != origin && s.second != origin )
         {
-            result.insert ( { segment_ranks[i].min, i } );
-            result.insert ( { segment_ranks[i].max, i } );
+            ++result.offsets[segment_ranks[i].min + 1];
+            ++result.offsets[segment_ranks[i].max + 1];
         }
     }
-    return result;
+
+    // Turn the counts into the offset of every bucket.
+    for ( point_rank k = 0; k < rank_count; ++k )
+    {
+        result.offsets[k + 1] += result.offsets[k];
+    }
+    result.segments.resize ( result.offsets[rank_count] );
+
+    // Place the segments in their buckets, using the offsets of the previous rank as insertion cursors.
+    for ( segment_index i = overlay.get_segment_count(); i-- > 0; )
+    {
+        const segment s = overlay.get_segment ( i );
+        if ( s.first != origin && s.second != origin )
+        {
+            result.segments[result.offsets[segment_ranks[i].min]++] = i;
+            result.segments[result.offsets[segment_ranks[i].max]++] = i;
+        }
+    }
+
+    // The cursors have moved one bucket forward; shift them back.
+    for ( point_rank k = rank_count; k > 0; --k )
+    {
+        result.offsets[k] = result.offsets[k - 1];
+    }
+    result.offsets[0] = 0;
 }
 
 
-visibility_problem_solver::visible_point_vector
-compute_visible_points ( const point_vector & points,
-                         const segment_vector & segments,
-                         const point_index origin,
-                         const point_index_vector & sorted_points,
-                         const rank_vector & ranks,
-                         const angle_vector & angles,
-                         const visible_segment_vector & visible_segments )
+void compute_visible_points ( const scenario_overlay & overlay,
+                              const point_index origin,
+                              const point_index_vector & sorted_points,
+                              const rank_vector & ranks,
+                              const angle_vector & angles,
+                              const visible_segment_vector & visible_segments,
+                              visibility_problem_solver::visible_point_vector & visible_points )
 {
-    // Initialize the vector to all false.
-    visibility_problem_solver::visible_point_vector visible_points ( points.size(), { false, NULL_SEGMENT_INDEX } );
+    // Initialize the vector to all false, reusing its memory.
+    visible_points.assign ( overlay.get_point_count(), { false, NULL_SEGMENT_INDEX } );
 
     // Any point is visible from itself (right??).
     visible_points[origin].visible = true;
 
     // Get the coordinates of the origin point.
-    const ues::geom::point<2> & origin_point = points[origin];
+    const ues::geom::point<2> & origin_point = overlay.get_point ( origin );
 
     point_index_vector::size_type i = 0;
     for ( point_rank rank = 0; rank < angles.size() - 1; ++rank )
@@ -188,7 +211,7 @@ compute_visible_points ( const point_vector & points,
             const segment_index & prev_segment = visible_segments[ ( rank + visible_segments.size() - 1 ) % ( visible_segments.size() ) ];
             if ( prev_segment != NULL_SEGMENT_INDEX )
             {
-                segment_distance = distance ( origin, prev_segment, angles[rank], points, segments );
+                segment_distance = distance ( origin, prev_segment, angles[rank], overlay );
                 segment = prev_segment;
             }
 
@@ -197,7 +220,7 @@ compute_visible_points ( const point_vector & points,
             const segment_index & next_segment = visible_segments[rank];
             if ( next_segment != NULL_SEGMENT_INDEX && ( prev_segment == NULL_SEGMENT_INDEX || next_segment != prev_segment ) )
             {
-                ues::math::numeric_type next_segment_distance = distance ( origin, next_segment, angles[rank], points, segments );
+                ues::math::numeric_type next_segment_distance = distance ( origin, next_segment, angles[rank], overlay );
                 if ( next_segment_distance < segment_distance )
                 {
                     segment_distance = next_segment_distance;
@@ -217,7 +240,7 @@ compute_visible_points ( const point_vector & points,
             {
                 point_index current_point = sorted_points[i];
                 nearest_points.insert ( current_point );
-                nearest_point_distance = origin_point.distance_to ( points[current_point] );
+                nearest_point_distance = origin_point.distance_to ( overlay.get_point ( current_point ) );
 
                 // Also, if the segment is closer than current point, then set the occluding segment.
                 if ( nearest_point_distance >= segment_distance )
@@ -233,7 +256,7 @@ compute_visible_points ( const point_vector & points,
                 // Get another point with current rank.
                 point_index current_point = sorted_points[i];
                 // Check if it is closer (or at least as close) to the origin as the current nearest points.
-                ues::math::numeric_type current_point_distance = origin_point.distance_to ( points[current_point] );
+                ues::math::numeric_type current_point_distance = origin_point.distance_to ( overlay.get_point ( current_point ) );
                 if ( nearest_point_distance > current_point_distance )
                 {
                     // Found a closer point. Former nearest points are no longer valid.
@@ -255,8 +278,8 @@ compute_visible_points ( const point_vector & points,
             }
 
             if ( nearest_point_distance < segment_distance ||
-                    ( segment != NULL_SEGMENT_INDEX && ( nearest_points.find ( segments[segment].first ) != nearest_points.end() ||
-                                                         nearest_points.find ( segments[segment].second ) != nearest_points.end() ) ) )
+                    ( segment != NULL_SEGMENT_INDEX && ( nearest_points.find ( overlay.get_segment ( segment ).first ) != nearest_points.end() ||
+                                                         nearest_points.find ( overlay.get_segment ( segment ).second ) != nearest_points.end() ) ) )
             {
                 for ( point_index nearest_point : nearest_points )
                 {
@@ -265,13 +288,10 @@ compute_visible_points ( const point_vector & points,
             }
         }
     }
-
-    return visible_points;
 }
 
 
-visible_segment_vector generate_envelope ( const point_vector & points,
-                                           const segment_vector & segments,
+visible_segment_vector generate_envelope ( const scenario_overlay & overlay,
                                            const angle_vector & angles,
                                            const point_index origin,
                                            const rank_to_segment & rts,
@@ -282,7 +302,7 @@ visible_segment_vector generate_envelope ( const point_vector & points,
     visible_segment_vector visible_segments ( angles.size() - 1, NULL_SEGMENT_INDEX );
 
     // Generate an empty envelope to use in the algorithm.
-    envelope env ( angles.size() );
+    envelope env;
 
     // Traverse all the ranks.
     for ( point_rank cur_k = 0; cur_k < angles.size(); ++cur_k )
@@ -294,10 +314,9 @@ visible_segment_vector generate_envelope ( const point_vector & points,
         }
 
         // Get all the segments that start or end at this rank.
-        auto segs = rts.equal_range ( cur_k );
-        for ( auto it = segs.first; it != segs.second; ++it )
+        for ( auto i = rts.offsets[cur_k]; i < rts.offsets[cur_k + 1]; ++i )
         {
-            segment_index current_segment = it->second;
+            segment_index current_segment = rts.segments[i];
 
             // Consider only segments with length greater than zero.
             if ( segment_ranks[current_segment].min < segment_ranks[current_segment].max )
@@ -314,7 +333,7 @@ visible_segment_vector generate_envelope ( const point_vector & points,
                     segment_index nearest = seg_data_new.segment;
                     if ( seg_data_longer->segment != NULL_SEGMENT_INDEX )
                     {
-                        nearest = nearest_segment ( origin, seg_data_new.segment, seg_data_longer->segment, points, segments, angles, segment_ranks );
+                        nearest = nearest_segment ( origin, seg_data_new.segment, seg_data_longer->segment, overlay, angles, segment_ranks );
                     }
 
                     // If no segment is longer than the new one, or the longer segment is farther, then
@@ -335,7 +354,7 @@ visible_segment_vector generate_envelope ( const point_vector & points,
                         // Delete shorter segments that are hidden behind the new one.
                         if ( seg_data_prev != env.end() )
                         {
-                            nearest = nearest_segment ( origin, seg_data_new.segment, seg_data_prev->segment, points, segments, angles, segment_ranks );
+                            nearest = nearest_segment ( origin, seg_data_new.segment, seg_data_prev->segment, overlay, angles, segment_ranks );
                             while ( seg_data_prev != env.end() && nearest == seg_data_new.segment )
                             {
                                 auto seg_data_aux = env.pred ( seg_data_prev );
@@ -343,7 +362,7 @@ visible_segment_vector generate_envelope ( const point_vector & points,
                                 seg_data_prev = seg_data_aux;
                                 if ( seg_data_aux != env.end() )
                                 {
-                                    nearest = nearest_segment ( origin, seg_data_new.segment, seg_data_prev->segment, points, segments, angles, segment_ranks );
+                                    nearest = nearest_segment ( origin, seg_data_new.segment, seg_data_prev->segment, overlay, angles, segment_ranks );
                                 }
                             }
                         }
@@ -367,12 +386,12 @@ visible_segment_vector generate_envelope ( const point_vector & points,
 }
 
 
-visible_segment_vector generate_left_envelope ( const point_vector & points,
-                                                const segment_vector & segments,
+visible_segment_vector generate_left_envelope ( const scenario_overlay & overlay,
                                                 const angle_vector & angles,
                                                 const point_index origin,
                                                 const visibility_problem_solver::segment_rank_vector & segment_ranks,
-                                                const least_common_ancestor_calculator & lca )
+                                                const least_common_ancestor_calculator & lca,
+                                                rank_to_segment & rts )
 {
     rank_vector actual_rank ( angles.size() );
     for ( rank_vector::size_type i = 0; i < actual_rank.size(); ++i )
@@ -386,18 +405,18 @@ visible_segment_vector generate_left_envelope ( const point_vector & points,
         left_segment_ranks[i].max = lca.compute ( segment_ranks[i].min + 1, segment_ranks[i].max + 1 ) - 1;
     }
 
-    rank_to_segment rts = generate_rank_to_segment ( segments, origin, left_segment_ranks );
+    generate_rank_to_segment ( overlay, origin, left_segment_ranks, angles.size(), rts );
 
-    return generate_envelope ( points, segments, angles, origin, rts, left_segment_ranks, actual_rank );
+    return generate_envelope ( overlay, angles, origin, rts, left_segment_ranks, actual_rank );
 }
 
 
-visible_segment_vector generate_right_envelope ( const point_vector & points,
-                                                 const segment_vector & segments,
+visible_segment_vector generate_right_envelope ( const scenario_overlay & overlay,
                                                  const angle_vector & angles,
                                                  const point_index origin,
                                                  const visibility_problem_solver::segment_rank_vector & segment_ranks,
-                                                 const least_common_ancestor_calculator & lca )
+                                                 const least_common_ancestor_calculator & lca,
+                                                 rank_to_segment & rts )
 {
     point_rank max_rank = angles.size() - 1;
     angle_vector reversed_angles ( angles.rbegin(), angles.rend() );
@@ -413,16 +432,15 @@ visible_segment_vector generate_right_envelope ( const point_vector & points,
         right_segment_ranks[i].max = max_rank - ( lca.compute ( segment_ranks[i].min + 1, segment_ranks[i].max + 1 ) - 1 );
     }
 
-    rank_to_segment rts = generate_rank_to_segment ( segments, origin, right_segment_ranks );
+    generate_rank_to_segment ( overlay, origin, right_segment_ranks, angles.size(), rts );
 
-    visible_segment_vector visible_segments = generate_envelope ( points, segments, reversed_angles, origin, rts, right_segment_ranks, actual_rank );
+    visible_segment_vector visible_segments = generate_envelope ( overlay, reversed_angles, origin, rts, right_segment_ranks, actual_rank );
 
     return visible_segment_vector ( visible_segments.rbegin(), visible_segments.rend() );
 }
 
 
-visible_segment_vector merge_visible_segments ( const point_vector & points,
-                                                const segment_vector & segments,
+visible_segment_vector merge_visible_segments ( const scenario_overlay & overlay,
                                                 const angle_vector & angles,
                                                 const point_index origin,
                                                 const visible_segment_vector & visible_segments_left,
@@ -432,19 +450,19 @@ visible_segment_vector merge_visible_segments ( const point_vector & points,
     visible_segment_vector visible_segments ( visible_segments_left.size() );
     for ( visible_segment_vector::size_type i = 0; i < visible_segments.size(); ++i )
     {
-        visible_segments[i] = nearest_segment ( origin, visible_segments_left[i], visible_segments_right[i], points, segments, angles, segment_ranks );
+        visible_segments[i] = nearest_segment ( origin, visible_segments_left[i], visible_segments_right[i], overlay, angles, segment_ranks );
     }
     return visible_segments;
 }
 
 
-void visibility_problem_solver::solve_visibility ( const point_vector & points,
-                                                   const segment_vector & segments,
+void visibility_problem_solver::solve_visibility ( const scenario_overlay & overlay,
                                                    const angle_vector & angles,
                                                    const point_index origin,
                                                    const point_index_vector & sorted_points,
                                                    const rank_vector & ranks,
                                                    const segment_rank_vector & segment_ranks,
+                                                   rank_to_segment & rts,
                                                    visible_point_vector & visible_points )
 {
     ues::log::logger lg;
@@ -458,14 +476,14 @@ void visibility_problem_solver::solve_visibility ( const point_vector & points,
     least_common_ancestor_calculator lca ( angles.size() );
 
     // Compute visible segments for each rank using left and right envelope.
-    visible_segment_vector visible_segments_left = generate_left_envelope ( points, segments, angles, origin, segment_ranks, lca );
-    visible_segment_vector visible_segments_right = generate_right_envelope ( points, segments, angles, origin, segment_ranks, lca );
+    visible_segment_vector visible_segments_left = generate_left_envelope ( overlay, angles, origin, segment_ranks, lca, rts );
+    visible_segment_vector visible_segments_right = generate_right_envelope ( overlay, angles, origin, segment_ranks, lca, rts );
 
     // Compute actual visible segments from the right and left visible segments.
-    visible_segment_vector visible_segments = merge_visible_segments ( points, segments, angles, origin, visible_segments_left, visible_segments_right, segment_ranks );
+    visible_segment_vector visible_segments = merge_visible_segments ( overlay, angles, origin, visible_segments_left, visible_segments_right, segment_ranks );
 
     // Complete the point visibility info with the information computed in the previous stage.
-    visible_points = compute_visible_points ( points, segments, origin, sorted_points, ranks, angles, visible_segments );
+    compute_visible_points ( overlay, origin, sorted_points, ranks, angles, visible_segments, visible_points );
 
     if ( lg.min_level() <= ues::log::TRACE_LVL )
     {
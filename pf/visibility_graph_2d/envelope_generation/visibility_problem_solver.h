@@ -20,7 +20,7 @@
 
 #include <vector>
 
-#include <pf/visibility_graph_2d/util/definitions.h>
+#include <pf/visibility_graph_2d/util/scenario_overlay.h>
 
 namespace ues
 {
@@ -46,13 +46,28 @@ public:
     /** For each point_index, contains visibility info from a given point. */
     typedef std::vector< point_visibility_info > visible_point_vector;
 
-    static void solve_visibility ( const point_vector & points,
-                                   const segment_vector & segments,
+    /** Contains the indices of the segments that start or end at every rank, bucketed by rank.
+     * The segments of rank k are those in positions [offsets[k], offsets[k+1]) of \a segments.
+     * Its buffers are reused by every call to solve_visibility that receives it. */
+    struct rank_to_segment
+    {
+        std::vector< segment_index_vector::size_type > offsets;
+        segment_index_vector segments;
+
+        /** Removes all the segments, keeping the memory of the buffers. */
+        void clear() noexcept { offsets.clear(); segments.clear(); }
+    };
+
+    /** Computes the visibility from the point of index \a origin of \a overlay, whose segments
+     * must not cross the positive y-axis from the origin. The segments of every rank are bucketed
+     * in \a rts. */
+    static void solve_visibility ( const scenario_overlay & overlay,
                                    const angle_vector & angles,
                                    const point_index origin,
                                    const point_index_vector & sorted_points,
                                    const rank_vector & ranks,
                                    const segment_rank_vector & segment_ranks,
+                                   rank_to_segment & rts,
                                    visible_point_vector & visible_points );
 
 };
@@ -17,7 +17,9 @@
 
 #include "planar_graph.h"
 
+#include <algorithm>
 #include <cassert>
+#include <cmath>
 #include <unordered_set>
 
 using namespace ues::pf::vg2d;
@@ -32,8 +34,60 @@ planar_graph::planar_graph ( ues::math::numeric_type epsilon ) noexcept
 }
 
 
+planar_graph::planar_graph ( std::vector< line_2d > new_lines,
+                             ues::misc::thread_pool * pool,
+                             bool store_crossings,
+                             ues::math::numeric_type epsilon )
+    : epsilon ( std::move ( epsilon ) )
+{
+    vertices.push_back ( { ues::geom::point<2>(), 0 } );
+
+    slopes.reserve ( new_lines.size() );
+    intercepts.reserve ( new_lines.size() );
+    for ( line_2d & l : new_lines )
+    {
+        slopes.push_back ( l.get_x1() );
+        intercepts.push_back ( l.get_x0() );
+        lines.push_back ( { std::move ( l ) } );
+    }
+
+    if ( !store_crossings || lines.size() <= 1 )
+    {
+        return;
+    }
+
+    const std::size_t row_size = lines.size() - 1;
+    crossings.resize ( lines.size() * row_size );
+
+    // Every worker sorts the crossings of a line at a time, in its own buffer.
+    std::vector< crossing_buffer > buffers ( pool ? pool->size() : 1 );
+    auto sort_line = [&] ( std::size_t line_index, unsigned int worker )
+    {
+        sort_crossings ( line_index, buffers[worker] );
+        std::transform ( buffers[worker].begin(), buffers[worker].end(), crossings.begin() + line_index * row_size,
+                         [] ( const crossing & c ) { return c.second; } );
+    };
+    if ( pool )
+    {
+        pool->run ( lines.size(), sort_line );
+    }
+    else
+    {
+        for ( line line_index = 0; line_index < lines.size(); ++line_index )
+        {
+            sort_line ( line_index, 0 );
+        }
+    }
+}
+
+
 void planar_graph::add_line ( line_2d new_line )
 {
+    if ( has_only_crossings() )
+    {
+        throw ues::exc::exception ( "Lines cannot be added to a graph that only contains its crossings", UES_CONTEXT );
+    }
+
     line line_index = lines.size();
     lines.push_back ( { std::move ( new_line ) } );
 
@@ -95,6 +149,63 @@ void planar_graph::add_line ( line_2d new_line )
 }
 
 
+void planar_graph::sort_crossings ( planar_graph::line line_index, crossing_buffer & buffer ) const
+{
+    const ues::math::numeric_type slope = slopes[line_index];
+    const ues::math::numeric_type intercept = intercepts[line_index];
+
+    // Sort the other lines by the x coordinate of their intersection point, computed as in
+    // edge_line_intersection().
+    buffer.clear();
+    for ( line other = 0; other < lines.size(); ++other )
+    {
+        if ( other == line_index )
+        {
+            continue;
+        }
+        if ( slopes[other] == slope )
+        {
+            if ( intercepts[other] == intercept )
+            {
+                throw ues::exc::exception ( "The edge is contained in the line and no intersection point can be computed", UES_CONTEXT );
+            }
+            throw ues::exc::exception ( "Parallel lines are not supported", UES_CONTEXT );
+        }
+        buffer.push_back ( { - ( intercepts[other] - intercept ) / ( slopes[other] - slope ), other } );
+    }
+    std::sort ( buffer.begin(), buffer.end() );
+
+    // Intersection points closer than epsilon are the same vertex. Around a vertex, edges are
+    // sorted counterclockwise, so lines are found from the incoming edge of the line to the
+    // outgoing one: first those with a greater slope, then those with a lower slope, each of them
+    // in increasing slope.
+    const ues::math::numeric_type x_epsilon = epsilon / std::sqrt ( 1 + slope * slope );
+    auto vertex_begin = buffer.begin();
+    while ( vertex_begin != buffer.end() )
+    {
+        auto vertex_end = vertex_begin + 1;
+        while ( vertex_end != buffer.end() && vertex_end->first - ( vertex_end - 1 )->first < x_epsilon )
+        {
+            ++vertex_end;
+        }
+        if ( vertex_end - vertex_begin > 1 )
+        {
+            std::sort ( vertex_begin, vertex_end, [this, slope] ( const crossing & a, const crossing & b )
+            {
+                const bool a_greater = slopes[a.second] > slope;
+                const bool b_greater = slopes[b.second] > slope;
+                if ( a_greater != b_greater )
+                {
+                    return a_greater;
+                }
+                return slopes[a.second] < slopes[b.second];
+            } );
+        }
+        vertex_begin = vertex_end;
+    }
+}
+
+
 void planar_graph::follow_line ( planar_graph::edge edge_index, planar_graph::vertex vertex_index, planar_graph::line line_index )
 {
     // First, compute toward what direction we expecto to find next intersections. If the
@@ -406,20 +517,6 @@ void planar_graph::update_edges ( planar_graph::edge new_edge_index, planar_grap
 }
 
 
-planar_graph::edge planar_graph::get_next_edge ( planar_graph::edge edge_index, planar_graph::vertex vertex_index ) const
-{
-    const edge_info & ei = edges[edge_index];
-
-    assert ( ei.head_vertex == vertex_index || ei.tail_vertex == vertex_index );
-
-    if ( ei.head_vertex == vertex_index )
-        return ei.next_edge;
-    else
-        return ei.prev_edge;
-
-}
-
-
 ues::math::numeric_type planar_graph::compute_alpha ( planar_graph::edge edge_index, planar_graph::vertex vertex_index ) const
 {
     const edge_info & ei = edges[edge_index];
@@ -468,6 +565,11 @@ std::vector< planar_graph::edge > planar_graph::get_edges_of_line ( planar_graph
 
     assert ( line_index < lines.size() );
 
+    if ( has_only_crossings() )
+    {
+        throw ues::exc::exception ( "The graph only contains the crossings of its lines, not its edges", UES_CONTEXT );
+    }
+
     vertex vertex_index = 0;
     do
     {
@@ -489,31 +591,11 @@ std::vector< planar_graph::edge > planar_graph::get_edges_of_line ( planar_graph
 std::vector< planar_graph::line > planar_graph::get_sorted_lines ( planar_graph::line line_index ) const
 {
     std::vector< line > result;
-    std::unordered_set< line > added_lines;
-
-    assert ( line_index < lines.size() );
+    result.reserve ( lines.size() - 1 );
+    crossing_buffer buffer;
+    for_each_sorted_line ( line_index, buffer, [&result] ( line l ) { result.push_back ( l ); } );
 
-    std::vector< edge > edge_index_list = get_edges_of_line ( line_index );
-
-    auto it = edge_index_list.begin();
-    while ( it != edge_index_list.end() && ( it + 1 ) != edge_index_list.end() )
-    {
-        edge edge_index = *it;
-        edge final_edge_index = * ( it + 1 );
-        vertex vertex_index = edges.at ( edge_index ).head_vertex;
-
-        while ( edge_index != final_edge_index )
-        {
-            line current_edge_line = edges.at ( edge_index ).line_index;
-            if ( current_edge_line != line_index )
-            {
-                added_lines.insert ( current_edge_line );
-                result.push_back ( current_edge_line );
-            }
-            edge_index = get_next_edge ( edge_index, vertex_index );
-        }
-        ++it;
-    }
+    std::unordered_set< line > added_lines ( result.begin(), result.end() );
 
     if ( result.size() != lines.size() - 1 )
     {
@@ -577,7 +659,18 @@ void planar_graph::update_edge_references ( planar_graph::edge edge_index, plana
 
 void planar_graph::describe ( std::ostream & out ) const noexcept
 {
-    if ( edges.size() == 0 )
+    if ( has_only_crossings() )
+    {
+        out << "Lines:" << '\n';
+        for ( line line_index = 0; line_index < lines.size(); line_index++ )
+        {
+            out << "(" << line_index << ") " << lines[line_index].geometric_info << " crosses lines ";
+            crossing_buffer buffer;
+            for_each_sorted_line ( line_index, buffer, [&out] ( line l ) { out << l << " "; } );
+            out << '\n';
+        }
+    }
+    else if ( edges.size() == 0 )
     {
         out << "Empty graph (no edges)";
     }
@@ -18,10 +18,12 @@
 #ifndef UES_PF_VG2D_PLANAR_GRAPH_H
 #define UES_PF_VG2D_PLANAR_GRAPH_H
 
+#include <cassert>
 #include <vector>
 
 #include <exc/exception.h>
 #include <geom/point.h>
+#include <misc/thread_pool.h>
 
 #include "line_2d.h"
 
@@ -39,13 +41,37 @@ public:
     typedef unsigned int vertex;
     typedef unsigned int line;
 
+    /** The x coordinate of the point where a line is crossed, and the line that crosses it. */
+    typedef std::pair< ues::math::numeric_type, line > crossing;
+    /** Working memory to compute the crossings of a line, with one element per line. */
+    typedef std::vector< crossing > crossing_buffer;
+
     /** Default constructor */
     planar_graph( ues::math::numeric_type epsilon = ues::math::epsilon ) noexcept;
 
+    /** Creates the graph of all the given lines at once. Instead of the edges and vertices, only
+     * the order in which every line crosses the other lines is kept, which is what
+     * get_sorted_lines() returns. If \a store_crossings is set, the crossings of all the lines
+     * are computed, independently and in parallel if a \a pool is given, and take quadratic
+     * memory. Otherwise, the crossings of a line are computed every time they are requested, in
+     * O(n log n) time, and the graph takes linear memory. Lines cannot be added to the resulting
+     * graph. */
+    planar_graph ( std::vector< line_2d > lines,
+                   ues::misc::thread_pool * pool,
+                   bool store_crossings = true,
+                   ues::math::numeric_type epsilon = ues::math::epsilon );
+
     /** Adds a line to the graph, inserting all the vertices
      * and edges necessary to keep the graph planar. */
     void add_line ( line_2d );
 
+    /** Returns true if the graph only contains the order in which lines cross each other, but
+     * not its edges and vertices. */
+    inline bool has_only_crossings() const noexcept;
+
+    /** Returns true if the crossings of every line are stored, or the graph has edges. */
+    inline bool stores_crossings() const noexcept;
+
     /** \name Getter methods */
     /** \{ */
 
@@ -65,6 +91,13 @@ public:
      * included in the list, sorted by the x coordinate of the intersection point. */
     std::vector< line > get_sorted_lines( line line_index ) const;
 
+    /** Calls \a fn with every line crossed by the given line, in the same order as
+     * get_sorted_lines() returns them. Unlike get_sorted_lines(), the lines are not checked to be
+     * all different, nor to be all the lines of the graph. If the crossings are not stored, they
+     * are computed in \a buffer; otherwise, no memory is allocated. */
+    template < typename Function >
+    inline void for_each_sorted_line ( line line_index, crossing_buffer & buffer, Function fn ) const;
+
     /** Returns a textual description of the planar graph through the \a out parameter. */
     void describe(std::ostream& out) const noexcept;
 
@@ -128,6 +161,14 @@ private:
 
     std::vector< line_info > lines;
 
+    /** For graphs created from all their lines at once, the slope and y-intercept of every
+     * line. */
+    std::vector< ues::math::numeric_type > slopes, intercepts;
+
+    /** For graphs created from all their lines at once, the lines crossed by every line, in
+     * order, if they are stored. Every line has a row of lines.size() - 1 lines. */
+    std::vector< line > crossings;
+
     /** \} */
 
     /** The precision of the generated graph. */
@@ -143,6 +184,10 @@ private:
      * of the vertex matching the coordinates given by the new vertex is returned. */
     vertex split_edge ( edge edge_index, geom::point<2> new_vertex );
 
+    /** Computes in \a buffer the crossings of the line of index \a line_index, sorted as they
+     * would be found along its edges, for graphs created from all their lines at once. */
+    void sort_crossings ( line line_index, crossing_buffer & buffer ) const;
+
     /** Follows an edge and adds all the new edges of a recently added line.  */
     void follow_line ( edge edge_index, vertex vertex_index, line line_index );
 
@@ -154,7 +199,7 @@ private:
 
     /** Returns the next edge found in counterclockwise direction from the provided
      * edge around the provided vertex. */
-    edge get_next_edge ( edge edge_index, vertex vertex_index ) const;
+    inline edge get_next_edge ( edge edge_index, vertex vertex_index ) const;
 
     /** Computes the angle of an edge from one of its vertices. Returns a value in the range of
      * [-pi, pi] (in radians). */
@@ -190,6 +235,86 @@ const line_2d & planar_graph::get_line ( planar_graph::line line_index ) const
 }
 
 
+bool planar_graph::has_only_crossings() const noexcept
+{
+    return edges.empty() && !lines.empty();
+}
+
+
+bool planar_graph::stores_crossings() const noexcept
+{
+    return !has_only_crossings() || lines.size() <= 1 || !crossings.empty();
+}
+
+
+template < typename Function >
+void planar_graph::for_each_sorted_line ( planar_graph::line line_index, crossing_buffer & buffer, Function fn ) const
+{
+    assert ( line_index < lines.size() );
+
+    if ( !stores_crossings() )
+    {
+        sort_crossings ( line_index, buffer );
+        for ( const crossing & c : buffer )
+        {
+            fn ( c.second );
+        }
+        return;
+    }
+
+    if ( has_only_crossings() )
+    {
+        const line row_size = lines.size() - 1;
+        const line * row = crossings.data() + line_index * static_cast< std::size_t > ( row_size );
+        for ( line i = 0; i < row_size; ++i )
+        {
+            fn ( row[i] );
+        }
+        return;
+    }
+
+    // Find the first edge of the line, which starts at the vertex at infinity.
+    edge edge_index = vertices[0].header_index;
+    while ( edges[edge_index].line_index != line_index || edges[edge_index].tail_vertex != 0 )
+    {
+        edge_index = get_next_edge ( edge_index, 0 );
+    }
+
+    // At the end of every edge of the line, the edges between it and the next edge of the line
+    // are those of the lines crossed at that vertex.
+    vertex vertex_index = edges[edge_index].head_vertex;
+    while ( vertex_index != 0 )
+    {
+        do
+        {
+            const line current_edge_line = edges[edge_index].line_index;
+            if ( current_edge_line != line_index )
+            {
+                fn ( current_edge_line );
+            }
+            edge_index = get_next_edge ( edge_index, vertex_index );
+        }
+        while ( edges[edge_index].line_index != line_index || edges[edge_index].tail_vertex != vertex_index );
+
+        vertex_index = edges[edge_index].head_vertex;
+    }
+}
+
+
+planar_graph::edge planar_graph::get_next_edge ( planar_graph::edge edge_index, planar_graph::vertex vertex_index ) const
+{
+    const edge_info & ei = edges[edge_index];
+
+    assert ( ei.head_vertex == vertex_index || ei.tail_vertex == vertex_index );
+
+    if ( ei.head_vertex == vertex_index )
+        return ei.next_edge;
+    else
+        return ei.prev_edge;
+
+}
+
+
 }
 }
 }
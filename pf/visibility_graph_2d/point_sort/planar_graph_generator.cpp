@@ -122,6 +122,24 @@ planar_graph planar_graph_generator::generate_planar_graph ( const point_vector
 }
 
 
+planar_graph planar_graph_generator::generate_planar_graph ( const point_vector & points,
+                                                            ues::misc::thread_pool * pool,
+                                                            bool store_crossings,
+                                                            const ues::math::numeric_type & epsilon )
+{
+    ues::log::logger lg;
+
+    point_vector rotated_points = remove_extrinsic_degeneracy ( points, lg, epsilon );
+    std::vector< line_2d > lines;
+    lines.reserve ( rotated_points.size() );
+    for ( const ues::geom::point<2> & point : rotated_points )
+    {
+        lines.push_back ( transform ( point ) );
+    }
+    return planar_graph ( std::move ( lines ), pool, store_crossings, epsilon );
+}
+
+
 line_2d planar_graph_generator::transform ( const ues::geom::point<2> & p ) noexcept
 {
     return line_2d ( -p.get_x(), p.get_y() );
@@ -38,6 +38,15 @@ public:
     /** Generates a planar graph from a vector of points. */
     static planar_graph generate_planar_graph ( const point_vector & points, const ues::math::numeric_type & epsilon = ues::math::epsilon );
 
+    /** Generates a planar graph from a vector of points, with only the order in which its lines
+     * cross each other. The sorted lines are the same as in the graph generated by adding the
+     * lines one by one. If \a store_crossings is set, they are all sorted in advance, in parallel
+     * if a \a pool is given; otherwise, they are sorted when requested. */
+    static planar_graph generate_planar_graph ( const point_vector & points,
+                                                ues::misc::thread_pool * pool,
+                                                bool store_crossings = true,
+                                                const ues::math::numeric_type & epsilon = ues::math::epsilon );
+
     /** Computes the transform of the given point to its corresponding line using the principles of
      * geometric duality */
     static line_2d transform ( const ues::geom::point<2> & pt ) noexcept;
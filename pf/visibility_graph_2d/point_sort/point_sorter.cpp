@@ -17,8 +17,9 @@
 
 #include "point_sorter.h"
 
-#include <list>
+#include <algorithm>
 
+#include <exc/exception.h>
 #include <log/logger.h>
 
 #include "planar_graph_generator.h"
@@ -28,9 +29,22 @@ using namespace ues::pf::vg2d;
 const std::string component_name = "Point Sorter";
 
 
-point_sorter::point_sorter ( shared_point_vector points )
+const std::size_t point_sorter::DEFAULT_MEMORY_BUDGET = 256 << 20;
+
+
+/** Returns true if the crossings of the lines of \a number_of_points points fit in
+ * \a memory_budget bytes. */
+bool crossings_fit ( std::size_t number_of_points, std::size_t memory_budget ) noexcept
+{
+    return number_of_points <= 1 ||
+           number_of_points - 1 <= memory_budget / sizeof ( planar_graph::line ) / number_of_points;
+}
+
+
+point_sorter::point_sorter ( shared_point_vector points, ues::misc::thread_pool * pool, std::size_t memory_budget )
     : points ( std::move ( points ) ),
-      graph ( planar_graph_generator::generate_planar_graph ( *this->points ) )
+      graph ( planar_graph_generator::generate_planar_graph ( *this->points, pool,
+                                                              crossings_fit ( this->points->size(), memory_budget ) ) )
 {
     ues::log::logger lg;
     if ( lg.min_level() <= ues::log::TRACE_LVL )
@@ -39,54 +53,75 @@ point_sorter::point_sorter ( shared_point_vector points )
         e.message() << graph << '\n';
         lg.record ( std::move ( e ) );
     }
+
+    dual_x.reserve ( this->points->size() );
+    for ( point_index i = 0; i < this->points->size(); ++i )
+    {
+        dual_x.push_back ( planar_graph_generator::transform ( graph.get_line ( i ) ).get_x() );
+    }
 }
 
 
 point_index_vector point_sorter::get_sorted_list_of_points ( point_index origin_point_index ) const
 {
-    ues::log::logger lg;
+    point_index_vector result;
+    planar_graph::crossing_buffer buffer;
+    get_sorted_list_of_points ( origin_point_index, result, buffer );
+    return result;
+}
 
-    // The origin_point corresponds with a line in the graph
-    const ues::geom::point<2> origin_point = planar_graph_generator::transform ( graph.get_line ( origin_point_index ) );
 
-    auto line_index_list = graph.get_sorted_lines ( origin_point_index );
+void point_sorter::get_sorted_list_of_points ( point_index origin_point_index,
+                                               point_index_vector & sorted_points,
+                                               planar_graph::crossing_buffer & buffer ) const
+{
+    ues::log::logger lg;
 
-    // See if the points corresponding to the line are to the right or left of the origin point
-    // and add them to the corresponding list.
-    std::list< point_index > right_side, left_side;
+    const point_vector & pv = *points;
+    sorted_points.resize ( pv.size() - 1 );
 
-    for ( planar_graph::line line_index : line_index_list )
+    // The lines crossed by the line of the origin point are visited in order. Those whose points
+    // are to the left of the origin point are written from the start of the buffer, and those to
+    // the right from the end of the buffer, backwards.
+    const ues::math::numeric_type origin_x = dual_x[origin_point_index];
+    point_index_vector::iterator left_end = sorted_points.begin();
+    point_index_vector::iterator right_begin = sorted_points.end();
+    graph.for_each_sorted_line ( origin_point_index, buffer, [&] ( planar_graph::line line_index )
     {
-        const ues::geom::point<2> other_point = planar_graph_generator::transform ( graph.get_line ( line_index ) );
-
-        if ( origin_point.get_x() > other_point.get_x() )
+        if ( left_end == right_begin )
         {
-            right_side.push_back ( line_index );
+            throw ues::exc::exception ( "Sorting points resulted in more points than expected", UES_CONTEXT );
+        }
+        if ( origin_x > dual_x[line_index] )
+        {
+            *--right_begin = line_index;
         }
         else
         {
-            left_side.push_back ( line_index );
+            *left_end++ = line_index;
         }
+    } );
+    if ( left_end != right_begin )
+    {
+        throw ues::exc::exception ( "Sorting points resulted in less points than expected", UES_CONTEXT );
     }
+    std::reverse ( right_begin, sorted_points.end() );
 
-    while ( !left_side.empty() && ( *points ) [left_side.front()].get_x() > ( *points ) [origin_point_index].get_x() )
+    // The points at the start of the left side that are actually to the right of the origin
+    // point are moved after the right side.
+    point_index_vector::iterator left_begin = sorted_points.begin();
+    while ( left_begin != left_end && pv[*left_begin].get_x() > pv[origin_point_index].get_x() )
     {
-        point_index moved_point = left_side.front();
-        left_side.pop_front();
-        right_side.push_back ( moved_point );
+        ++left_begin;
     }
-
-    // Merge both lists by appending the right side at the end of the left side.
-    left_side.insert ( left_side.end(), right_side.begin(), right_side.end() );
+    std::rotate ( sorted_points.begin(), left_begin, sorted_points.end() );
 
     if ( lg.min_level() <= ues::log::TRACE_LVL )
     {
         ues::log::event e ( ues::log::TRACE_LVL, component_name, "Finished sorting points" );
         e.message() << "Sorted point indices: ";
-        std::for_each ( left_side.begin(), left_side.end(), [&e] ( const point_index p ) { e.message() << p << ", "; } );
+        std::for_each ( sorted_points.begin(), sorted_points.end(), [&e] ( const point_index p ) { e.message() << p << ", "; } );
         e.message() << '\n';
         lg.record ( std::move ( e ) );
     }
-
-    return point_index_vector ( left_side.begin(), left_side.end() );
 }
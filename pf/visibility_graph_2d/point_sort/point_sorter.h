@@ -31,17 +31,37 @@ namespace vg2d
 class point_sorter
 {
 public:
-    /** Constructor method. */
-    point_sorter ( shared_point_vector points );
+    /** Default memory budget of the order in which the lines of the planar graph cross each
+     * other, in bytes. */
+    static const std::size_t DEFAULT_MEMORY_BUDGET;
+
+    /** Constructor method. If the order in which every line of the planar graph crosses the
+     * others fits in \a memory_budget bytes, it is computed in advance, in parallel if a \a pool
+     * is given, and sorting points takes linear time. Otherwise, the sorter only takes linear
+     * memory, and sorting points takes O(n log n) time. */
+    point_sorter ( shared_point_vector points,
+                   ues::misc::thread_pool * pool = nullptr,
+                   std::size_t memory_budget = DEFAULT_MEMORY_BUDGET );
 
     /** Returns a vector of point indices, in the order they are found scanning from the
      * origin point in counter-clockwise order starting at the positive y-axis position. */
     point_index_vector get_sorted_list_of_points ( point_index origin_point ) const;
 
+    /** Writes the sorted list of points of get_sorted_list_of_points() into \a sorted_points,
+     * replacing its contents, using \a buffer as working memory if the crossings of the lines
+     * are not stored. No memory is allocated if the capacity of both is enough for all the
+     * points. */
+    void get_sorted_list_of_points ( point_index origin_point,
+                                     point_index_vector & sorted_points,
+                                     planar_graph::crossing_buffer & buffer ) const;
+
 private:
     shared_point_vector points;
     planar_graph graph;
 
+    /** For every point, the x coordinate of the point dual to its line in the graph. */
+    std::vector< ues::math::numeric_type > dual_x;
+
 };
 
 }
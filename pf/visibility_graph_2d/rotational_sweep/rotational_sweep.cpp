@@ -0,0 +1,512 @@
+/*
+ * Copyright 2015-2017 Guillermo Frontera <guillermo.frontera@upm.es>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include "rotational_sweep.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <set>
+
+#include <exc/exception.h>
+
+using namespace ues::pf::vg2d;
+
+namespace
+{
+
+/** Relative tolerance of the geometric comparisons of the sweep. */
+const ues::math::numeric_type tolerance = 1e-9;
+
+const std::size_t NO_POINT = std::numeric_limits<std::size_t>::max();
+
+/** Returns the cross product of the vectors ( \a ax, \a ay ) and ( \a bx, \a by ). */
+inline ues::math::numeric_type cross ( ues::math::numeric_type ax, ues::math::numeric_type ay,
+                                       ues::math::numeric_type bx, ues::math::numeric_type by ) noexcept
+{
+    return ax * by - ay * bx;
+}
+
+/** The sweep_ray struct holds the current direction of the ray, so the segments it crosses
+ * can be ordered by their distance along it. Distances are measured in multiples of the
+ * direction, so the point that defines it is at distance one. */
+struct sweep_ray
+{
+    const point_vector * points;
+    const segment_vector * segments;
+    ues::math::numeric_type x, y;
+    ues::math::numeric_type dx, dy;
+
+    /** Returns the distance along the ray at which it crosses the segment of index \a s. */
+    ues::math::numeric_type distance ( segment_index s ) const noexcept
+    {
+        const ues::geom::point<2> & a = ( *points ) [ ( *segments ) [s].first ];
+        const ues::geom::point<2> & b = ( *points ) [ ( *segments ) [s].second ];
+        const ues::math::numeric_type ex = b.get_x() - a.get_x(), ey = b.get_y() - a.get_y();
+        const ues::math::numeric_type denominator = cross ( dx, dy, ex, ey );
+        if ( std::abs ( denominator ) <= tolerance * std::hypot ( dx, dy ) * std::hypot ( ex, ey ) )
+        {
+            // The segment is almost parallel to the ray: use its closest end.
+            const ues::math::numeric_type length = dx * dx + dy * dy;
+            return std::min ( ( ( a.get_x() - x ) * dx + ( a.get_y() - y ) * dy ) / length,
+                              ( ( b.get_x() - x ) * dx + ( b.get_y() - y ) * dy ) / length );
+        }
+        return cross ( a.get_x() - x, a.get_y() - y, ex, ey ) / denominator;
+    }
+
+    /** Returns the end of the segment of index \a s farther counter-clockwise. */
+    const ues::geom::point<2> & leading_end ( segment_index s ) const noexcept
+    {
+        const ues::geom::point<2> & a = ( *points ) [ ( *segments ) [s].first ];
+        const ues::geom::point<2> & b = ( *points ) [ ( *segments ) [s].second ];
+        return cross ( dx, dy, a.get_x() - x, a.get_y() - y ) >= cross ( dx, dy, b.get_x() - x, b.get_y() - y ) ? a : b;
+    }
+};
+
+/** Orders the segments crossed by the ray by their distance. Segments crossed at the same
+ * point are ordered by which of them is closer just after the ray. The order of the segments
+ * does not change while the ray rotates, as long as they do not cross each other. */
+class segment_order
+{
+public:
+    segment_order ( const sweep_ray & ray ) noexcept : ray ( &ray ) {}
+
+    bool operator() ( segment_index a, segment_index b ) const noexcept
+    {
+        if ( a == b )
+            return false;
+
+        const ues::math::numeric_type ta = ray->distance ( a ), tb = ray->distance ( b );
+        const ues::math::numeric_type margin = tolerance * std::max<ues::math::numeric_type> ( 1, std::max ( std::abs ( ta ), std::abs ( tb ) ) );
+        if ( ta < tb - margin )
+            return true;
+        if ( tb < ta - margin )
+            return false;
+
+        // The segment a is closer if the other one is on the far side of it.
+        const ues::math::numeric_type qx = ray->x + ta * ray->dx, qy = ray->y + ta * ray->dy;
+        const ues::geom::point<2> & a_end = ray->leading_end ( a );
+        const ues::geom::point<2> & b_end = ray->leading_end ( b );
+        const ues::math::numeric_type viewpoint_side = cross ( a_end.get_x() - qx, a_end.get_y() - qy, ray->x - qx, ray->y - qy );
+        const ues::math::numeric_type other_side = cross ( a_end.get_x() - qx, a_end.get_y() - qy, b_end.get_x() - qx, b_end.get_y() - qy );
+        if ( viewpoint_side * other_side < 0 )
+            return true;
+        if ( viewpoint_side * other_side > 0 )
+            return false;
+        return a < b;
+    }
+
+private:
+    const sweep_ray * ray;
+};
+
+}
+
+
+rotational_sweep::rotational_sweep ( const scenario & current_scenario )
+    : points ( current_scenario.get_shared_points() ),
+      segments ( current_scenario.get_shared_segments() ),
+      point_segments ( points->size() ),
+      point_corners ( points->size() )
+{
+    for ( segment_index s = 0; s < segments->size(); ++s )
+    {
+        point_segments[ ( *segments ) [s].first ].push_back ( s );
+        point_segments[ ( *segments ) [s].second ].push_back ( s );
+    }
+
+    for ( const polygon & po : current_scenario.get_polygons() )
+    {
+        // Degenerate polygons have no inside.
+        if ( po.size() < 3 )
+            continue;
+
+        // Every pair of consecutive segments meets at a point of the polygon.
+        std::vector< corner > corners;
+        std::vector< point_index > centers;
+        for ( segment_index i = 0; i < po.size(); ++i )
+        {
+            const segment & current = ( *segments ) [ po[i] ];
+            const segment & next = ( *segments ) [ po[ ( i + 1 ) % po.size() ] ];
+            point_index center;
+            if ( current.first == next.first || current.first == next.second )
+                center = current.first;
+            else if ( current.second == next.first || current.second == next.second )
+                center = current.second;
+            else
+                throw ues::exc::exception ( "Two consecutive segments in a polygon don't share any common point.", UES_CONTEXT );
+
+            corners.push_back ( { current.first == center ? current.second : current.first,
+                                  next.first == center ? next.second : next.first } );
+            centers.push_back ( center );
+        }
+
+        // The inside of clockwise polygons is to the right of their sides, so the corners of
+        // counter-clockwise ones are reversed.
+        ues::math::numeric_type area = 0;
+        for ( std::size_t i = 0; i < centers.size(); ++i )
+        {
+            const ues::geom::point<2> & a = ( *points ) [ centers[i] ];
+            const ues::geom::point<2> & b = ( *points ) [ centers[ ( i + 1 ) % centers.size() ] ];
+            area += cross ( a.get_x(), a.get_y(), b.get_x(), b.get_y() );
+        }
+        for ( std::size_t i = 0; i < centers.size(); ++i )
+        {
+            if ( area > 0 )
+                std::swap ( corners[i].previous, corners[i].next );
+            point_corners[ centers[i] ].push_back ( corners[i] );
+        }
+    }
+}
+
+
+void rotational_sweep::compute_visibility ( const ues::geom::point<2> & viewpoint,
+                                            const point_vector & extra_points,
+                                            std::vector< bool > & visible ) const
+{
+    sweep ( viewpoint, extra_points, false, visible, nullptr );
+}
+
+
+void rotational_sweep::compute_visibility ( point_index viewpoint,
+                                            std::vector< bool > & visible,
+                                            segment_index_vector & occluding ) const
+{
+    sweep ( ( *points ) [viewpoint], point_vector(), true, visible, &occluding );
+}
+
+
+void rotational_sweep::visible_vertices ( const ues::geom::point<2> & viewpoint,
+                                          point_vector & visible ) const
+{
+    std::vector< bool > visible_points;
+    sweep ( viewpoint, point_vector(), false, visible_points, nullptr );
+    visible.clear();
+    for ( point_index i = 0; i < visible_points.size(); ++i )
+    {
+        if ( visible_points[i] )
+            visible.push_back ( ( *points ) [i] );
+    }
+}
+
+
+bool rotational_sweep::check_visibility ( const ues::geom::point<2> & point1,
+                                          const ues::geom::point<2> & point2 ) const
+{
+    if ( point1 == point2 )
+        return true;
+
+    // A single pair does not need the whole sweep: the view is blocked by any segment that the
+    // line between both points crosses strictly, and by the polygons it enters through one of
+    // their corners, including those of both points.
+    const point_vector & scenario_points = *points;
+    const ues::math::numeric_type dx = point2.get_x() - point1.get_x(), dy = point2.get_y() - point1.get_y();
+    const ues::math::numeric_type length = std::hypot ( dx, dy );
+
+    // Returns the side of \a p with respect to the line between both points: positive to the
+    // left, negative to the right, and zero when it is on the line.
+    auto side = [&] ( const ues::geom::point<2> & p ) -> int
+    {
+        const ues::math::numeric_type px = p.get_x() - point1.get_x(), py = p.get_y() - point1.get_y();
+        const ues::math::numeric_type c = cross ( dx, dy, px, py );
+        const ues::math::numeric_type margin = tolerance * length * std::hypot ( px, py );
+        return c > margin ? 1 : ( c < -margin ? -1 : 0 );
+    };
+
+    for ( point_index i = 0; i < scenario_points.size(); ++i )
+    {
+        const ues::geom::point<2> & p = scenario_points[i];
+        if ( p == point1 || p == point2 )
+        {
+            if ( enters_polygon ( i, p == point1 ? point2 : point1 ) )
+                return false;
+        }
+        else if ( side ( p ) == 0 )
+        {
+            const ues::math::numeric_type t = ( ( p.get_x() - point1.get_x() ) * dx + ( p.get_y() - point1.get_y() ) * dy ) / ( length * length );
+            if ( t > 0 && t < 1 && ( enters_polygon ( i, point2 ) || enters_polygon ( i, point1 ) ) )
+                return false;
+        }
+    }
+
+    for ( const segment & se : *segments )
+    {
+        const ues::geom::point<2> & a = scenario_points[se.first];
+        const ues::geom::point<2> & b = scenario_points[se.second];
+        // Segments that end at either point, or whose ends are on the line, never cross it
+        // strictly.
+        if ( a == point1 || a == point2 || b == point1 || b == point2 || side ( a ) * side ( b ) >= 0 )
+            continue;
+
+        // Returns the side of \a p with respect to the segment, as above.
+        const ues::math::numeric_type ex = b.get_x() - a.get_x(), ey = b.get_y() - a.get_y();
+        auto segment_side = [&] ( const ues::geom::point<2> & p ) -> int
+        {
+            const ues::math::numeric_type px = p.get_x() - a.get_x(), py = p.get_y() - a.get_y();
+            const ues::math::numeric_type c = cross ( ex, ey, px, py );
+            const ues::math::numeric_type margin = tolerance * std::hypot ( ex, ey ) * std::hypot ( px, py );
+            return c > margin ? 1 : ( c < -margin ? -1 : 0 );
+        };
+        if ( segment_side ( point1 ) * segment_side ( point2 ) < 0 )
+            return false;
+    }
+    return true;
+}
+
+
+void rotational_sweep::sweep ( const ues::geom::point<2> & viewpoint,
+                               const point_vector & extra_points,
+                               bool points_occlude,
+                               std::vector< bool > & visible,
+                               segment_index_vector * occluding ) const
+{
+    const point_vector & scenario_points = *points;
+    const std::size_t n = scenario_points.size();
+    auto position = [&] ( std::size_t i ) -> const ues::geom::point<2> &
+    {
+        return i < n ? scenario_points[i] : extra_points[i - n];
+    };
+
+    visible.assign ( n + extra_points.size(), false );
+    if ( occluding )
+        occluding->assign ( visible.size(), NULL_SEGMENT_INDEX );
+
+    // Sort the points by their angle around the viewpoint, and then by their distance.
+    std::size_t own_point = NO_POINT;
+    std::vector< std::pair< std::pair< ues::math::numeric_type, ues::math::numeric_type >, std::size_t > > events;
+    events.reserve ( visible.size() );
+    for ( std::size_t i = 0; i < visible.size(); ++i )
+    {
+        const ues::geom::point<2> & p = position ( i );
+        if ( p == viewpoint )
+        {
+            if ( i < n )
+                own_point = i;
+            continue;
+        }
+        const ues::math::numeric_type dx = p.get_x() - viewpoint.get_x(), dy = p.get_y() - viewpoint.get_y();
+        ues::math::numeric_type angle = std::atan2 ( dy, dx );
+        if ( angle < 0 )
+            angle += 2 * ues::math::pi;
+        events.push_back ( { { angle, dx * dx + dy * dy }, i } );
+    }
+    std::sort ( events.begin(), events.end() );
+
+    // Points in the same direction may get slightly different angles, so every run of them is
+    // sorted again by their distance.
+    auto same_direction = [&] ( std::size_t a, std::size_t b )
+    {
+        const ues::math::numeric_type ax = position ( a ).get_x() - viewpoint.get_x(), ay = position ( a ).get_y() - viewpoint.get_y();
+        const ues::math::numeric_type bx = position ( b ).get_x() - viewpoint.get_x(), by = position ( b ).get_y() - viewpoint.get_y();
+        return std::abs ( cross ( ax, ay, bx, by ) ) <= tolerance * std::hypot ( ax, ay ) * std::hypot ( bx, by ) && ax * bx + ay * by > 0;
+    };
+    for ( std::size_t first = 0; first < events.size(); )
+    {
+        std::size_t last = first + 1;
+        while ( last < events.size() && same_direction ( events[last - 1].second, events[last].second ) )
+            ++last;
+        if ( last - first > 1 )
+        {
+            std::sort ( events.begin() + first, events.begin() + last, [] ( const decltype ( events ) ::value_type & a, const decltype ( events ) ::value_type & b )
+            {
+                return a.first.second < b.first.second || ( a.first.second == b.first.second && a.second < b.second );
+            } );
+        }
+        first = last;
+    }
+
+    // The ray starts pointing towards the positive x-axis, crossing the segments that have an
+    // end at each side of it. Segments that end at the viewpoint never hide anything.
+    sweep_ray ray { points.get(), segments.get(), viewpoint.get_x(), viewpoint.get_y(), 1, 0 };
+    typedef std::set< segment_index, segment_order > segment_set;
+    segment_set crossed ( ( segment_order ( ray ) ) );
+    std::vector< segment_set::iterator > handles ( segments->size(), crossed.end() );
+
+    auto ends_at_viewpoint = [&] ( const segment & s )
+    {
+        return own_point != NO_POINT && ( s.first == own_point || s.second == own_point );
+    };
+
+    for ( segment_index s = 0; s < segments->size(); ++s )
+    {
+        const segment & se = ( *segments ) [s];
+        if ( ends_at_viewpoint ( se ) )
+            continue;
+
+        const ues::geom::point<2> & a = scenario_points[se.first];
+        const ues::geom::point<2> & b = scenario_points[se.second];
+        const ues::math::numeric_type ya = a.get_y() - viewpoint.get_y(), yb = b.get_y() - viewpoint.get_y();
+        if ( ( ya > 0 && yb < 0 ) || ( ya < 0 && yb > 0 ) )
+        {
+            const ues::math::numeric_type x = a.get_x() + ( b.get_x() - a.get_x() ) * ya / ( ya - yb );
+            if ( x > viewpoint.get_x() )
+                handles[s] = crossed.insert ( s ).first;
+        }
+    }
+
+    std::size_t previous = NO_POINT;
+    std::size_t nearest = NO_POINT;
+    for ( const auto & event : events )
+    {
+        const std::size_t i = event.second;
+        const ues::geom::point<2> & p = position ( i );
+        ray.dx = p.get_x() - viewpoint.get_x();
+        ray.dy = p.get_y() - viewpoint.get_y();
+        const ues::math::numeric_type ray_length = std::hypot ( ray.dx, ray.dy );
+
+        // Points in the same direction as the previous one are hidden by it, or by the
+        // segments crossed between both.
+        bool behind_previous = false;
+        ues::math::numeric_type previous_distance = 0;
+        if ( previous != NO_POINT )
+        {
+            const ues::math::numeric_type px = position ( previous ).get_x() - viewpoint.get_x();
+            const ues::math::numeric_type py = position ( previous ).get_y() - viewpoint.get_y();
+            behind_previous = std::abs ( cross ( px, py, ray.dx, ray.dy ) ) <= tolerance * std::hypot ( px, py ) * ray_length &&
+                              px * ray.dx + py * ray.dy > 0;
+            previous_distance = ( px * ray.dx + py * ray.dy ) / ( ray_length * ray_length );
+        }
+
+        if ( !behind_previous )
+            nearest = i;
+
+        // When points occlude, the polygons of the point are not checked, as in the visibility
+        // graph generator: free points inside a polygon see its corners.
+        bool is_visible;
+        if ( ( own_point != NO_POINT && enters_polygon ( own_point, p ) ) || ( !points_occlude && i < n && enters_polygon ( i, viewpoint ) ) )
+        {
+            is_visible = false;
+        }
+        else if ( !behind_previous )
+        {
+            is_visible = crossed.empty() || ray.distance ( *crossed.begin() ) >= 1 - tolerance;
+        }
+        else if ( points_occlude && previous_distance < 1 - tolerance )
+        {
+            is_visible = false;
+        }
+        else if ( !visible[previous] || previous_distance >= 1 - tolerance )
+        {
+            is_visible = visible[previous];
+        }
+        else if ( previous < n && enters_polygon ( previous, p ) )
+        {
+            is_visible = false;
+        }
+        else
+        {
+            is_visible = true;
+            for ( segment_set::const_iterator it = crossed.begin(); it != crossed.end(); ++it )
+            {
+                const ues::math::numeric_type distance = ray.distance ( *it );
+                if ( distance >= 1 - tolerance )
+                    break;
+                if ( distance > previous_distance + tolerance )
+                {
+                    is_visible = false;
+                    break;
+                }
+            }
+        }
+        visible[i] = is_visible;
+        if ( occluding && !is_visible )
+        {
+            // The closest segment is either the first one crossed, or one that ends at the
+            // nearest point in the same direction without running along the ray, so the ray
+            // meets it at that point.
+            const ues::math::numeric_type closest_distance = crossed.empty() ? 1 : ray.distance ( *crossed.begin() );
+            if ( closest_distance < 1 - tolerance )
+                ( *occluding ) [i] = *crossed.begin();
+            if ( nearest != i && nearest < n )
+            {
+                const ues::math::numeric_type nx = scenario_points[nearest].get_x() - viewpoint.get_x();
+                const ues::math::numeric_type ny = scenario_points[nearest].get_y() - viewpoint.get_y();
+                if ( ( nx * ray.dx + ny * ray.dy ) / ( ray_length * ray_length ) < closest_distance - tolerance )
+                {
+                    for ( segment_index s : point_segments[nearest] )
+                    {
+                        const segment & se = ( *segments ) [s];
+                        const ues::geom::point<2> & other = scenario_points[ se.first == nearest ? se.second : se.first ];
+                        const ues::math::numeric_type ox = other.get_x() - viewpoint.get_x(), oy = other.get_y() - viewpoint.get_y();
+                        if ( !ends_at_viewpoint ( se ) &&
+                             std::abs ( cross ( ray.dx, ray.dy, ox, oy ) ) > tolerance * ray_length * std::hypot ( ox, oy ) )
+                        {
+                            ( *occluding ) [i] = s;
+                            break;
+                        }
+                    }
+                }
+            }
+        }
+
+        // The segments of the point already swept are no longer crossed, and the ones still
+        // to sweep start being crossed.
+        if ( i < n )
+        {
+            for ( unsigned int pass = 0; pass < 2; ++pass )
+            {
+                for ( segment_index s : point_segments[i] )
+                {
+                    const segment & se = ( *segments ) [s];
+                    if ( ends_at_viewpoint ( se ) )
+                        continue;
+
+                    const ues::geom::point<2> & other = scenario_points[ se.first == i ? se.second : se.first ];
+                    const ues::math::numeric_type ox = other.get_x() - viewpoint.get_x(), oy = other.get_y() - viewpoint.get_y();
+                    const ues::math::numeric_type side = cross ( ray.dx, ray.dy, ox, oy );
+                    const ues::math::numeric_type margin = tolerance * ray_length * std::hypot ( ox, oy );
+                    if ( pass == 0 && side < -margin && handles[s] != crossed.end() )
+                    {
+                        crossed.erase ( handles[s] );
+                        handles[s] = crossed.end();
+                    }
+                    else if ( pass == 1 && side > margin && handles[s] == crossed.end() )
+                    {
+                        handles[s] = crossed.insert ( s ).first;
+                    }
+                }
+            }
+        }
+
+        previous = i;
+    }
+}
+
+
+bool rotational_sweep::enters_polygon ( point_index corner_point, const ues::geom::point<2> & towards ) const
+{
+    const ues::geom::point<2> & center = ( *points ) [corner_point];
+    const ues::math::numeric_type tx = towards.get_x() - center.get_x(), ty = towards.get_y() - center.get_y();
+    const ues::math::numeric_type towards_length = std::hypot ( tx, ty );
+
+    for ( const corner & c : point_corners[corner_point] )
+    {
+        const ues::geom::point<2> & previous = ( *points ) [c.previous];
+        const ues::geom::point<2> & next = ( *points ) [c.next];
+        const ues::math::numeric_type ix = center.get_x() - previous.get_x(), iy = center.get_y() - previous.get_y();
+        const ues::math::numeric_type ox = next.get_x() - center.get_x(), oy = next.get_y() - center.get_y();
+
+        // The inside is to the right of both sides. At convex corners, it is to the right of
+        // both of them, and at reflex corners, to the right of any of them.
+        const bool right_of_incoming = cross ( ix, iy, tx, ty ) < -tolerance * std::hypot ( ix, iy ) * towards_length;
+        const bool right_of_outgoing = cross ( ox, oy, tx, ty ) < -tolerance * std::hypot ( ox, oy ) * towards_length;
+        const bool convex = cross ( ix, iy, ox, oy ) < 0;
+        if ( convex ? ( right_of_incoming && right_of_outgoing ) : ( right_of_incoming || right_of_outgoing ) )
+            return true;
+    }
+    return false;
+}
@@ -0,0 +1,104 @@
+/*
+ * Copyright 2015-2017 Guillermo Frontera <guillermo.frontera@upm.es>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#ifndef UES_PF_VG2D_ROTATIONAL_SWEEP_H
+#define UES_PF_VG2D_ROTATIONAL_SWEEP_H
+
+#include <vector>
+
+#include <pf/visibility_graph/point_visibility.h>
+#include <pf/visibility_graph_2d/util/scenario.h>
+
+namespace ues
+{
+namespace pf
+{
+namespace vg2d
+{
+
+/** The rotational_sweep class computes the points of a scenario visible from any single point in
+ * O(n log n) time (Lee's algorithm): the points are sorted by their angle around the viewpoint,
+ * and a ray sweeping them keeps the segments it crosses ordered by their distance. Only the
+ * closest segment can hide a point. Polygons may be clockwise or counter-clockwise. */
+class rotational_sweep : public ues::pf::point_visibility<2>
+{
+public:
+    /** Precomputes the segments and polygon corners of every point of the scenario. */
+    rotational_sweep ( const scenario & current_scenario );
+
+    /** Computes which points are visible from \a viewpoint. The result holds the points of the
+     * scenario followed by the \a extra_points, which do not belong to any polygon. Points at
+     * the position of the viewpoint are not visible. The viewpoint may be a point of the
+     * scenario, in which case its own polygons are taken into account. */
+    void compute_visibility ( const ues::geom::point<2> & viewpoint,
+                              const point_vector & extra_points,
+                              std::vector< bool > & visible ) const;
+
+    /** Computes which points of the scenario are visible from its point of index \a viewpoint, as
+     * the visibility graph generator does: a point also hides the points behind it in the same
+     * direction, and free points inside a polygon see its corners. For every hidden point,
+     * \a occluding holds the closest segment in its direction that is nearer than the point, or
+     * NULL_SEGMENT_INDEX if there is none. */
+    void compute_visibility ( point_index viewpoint,
+                              std::vector< bool > & visible,
+                              segment_index_vector & occluding ) const;
+
+    /** Fills \a visible with the points of the scenario visible from \a viewpoint. */
+    void visible_vertices ( const ues::geom::point<2> & viewpoint,
+                            point_vector & visible ) const override;
+
+    /** Checks whether \a point1 and \a point2 see each other among the segments of the
+     * scenario. */
+    bool check_visibility ( const ues::geom::point<2> & point1,
+                            const ues::geom::point<2> & point2 ) const override;
+
+private:
+    /** The corner struct describes the two sides of a polygon that meet at a point, ordered so
+     * the inside of the polygon is to their right: from \a previous to the point, and from the
+     * point to \a next. */
+    struct corner
+    {
+        point_index previous;
+        point_index next;
+    };
+
+    shared_point_vector points;
+    shared_segment_vector segments;
+    /** Segments that end at every point. */
+    std::vector< segment_index_vector > point_segments;
+    /** Corners of the polygons at every point. */
+    std::vector< std::vector< corner > > point_corners;
+
+    /** Returns true if the direction from the point of index \a corner_point towards \a towards
+     * goes inside any polygon the point belongs to. */
+    bool enters_polygon ( point_index corner_point, const ues::geom::point<2> & towards ) const;
+
+    /** Sweeps the points of the scenario and \a extra_points around \a viewpoint. If
+     * \a points_occlude is set, points hide the ones behind them. The occluding segments are
+     * only computed if \a occluding is not null. */
+    void sweep ( const ues::geom::point<2> & viewpoint,
+                 const point_vector & extra_points,
+                 bool points_occlude,
+                 std::vector< bool > & visible,
+                 segment_index_vector * occluding ) const;
+};
+
+}
+}
+}
+
+#endif // UES_PF_VG2D_ROTATIONAL_SWEEP_H
@@ -126,25 +126,62 @@ bool polygon_self_occlusion::check_occluding_segment ( point_index origin_index,
         ues::math::numeric_type angle = points->at ( origin_index ).angle_to ( points->at ( target_index ) );
         for ( const occlusion_angles & oa : occlusion_info[origin_index] )
         {
-            // Two different cases here, depending on whether the right and left point angles go through the X-axis (angle pi) or not.
-            if ( oa.right <= oa.left )
+            if ( inside_polygon ( oa, angle ) )
             {
-                if ( oa.right < angle && angle < oa.left )
-                {
-                    occluding_segment_index = oa.occluding_index;
-                    return true;
-                }
-            }
-            else
-            {
-                if ( oa.right < angle || angle < oa.left )
-                {
-                    occluding_segment_index = oa.occluding_index;
-                    return true;
-                }
+                occluding_segment_index = oa.occluding_index;
+                return true;
             }
         }
     }
 
     return false;
 }
+
+
+bool polygon_self_occlusion::check_tangent ( point_index origin_index,
+                                             point_index target_index ) const
+{
+    if ( origin_index == target_index || occlusion_info[origin_index].empty() )
+    {
+        return true;
+    }
+
+    // The line is tangent if its prolongation beyond the origin does not enter the polygon either.
+    ues::math::numeric_type opposite_angle = points->at ( origin_index ).angle_to ( points->at ( target_index ) ) + ues::math::pi;
+    if ( opposite_angle > ues::math::pi )
+    {
+        opposite_angle -= 2 * ues::math::pi;
+    }
+
+    for ( const occlusion_angles & oa : occlusion_info[origin_index] )
+    {
+        // Paths never turn around reflex vertices.
+        ues::math::numeric_type interior_angle = oa.left - oa.right;
+        if ( interior_angle < 0 )
+        {
+            interior_angle += 2 * ues::math::pi;
+        }
+        if ( interior_angle > ues::math::pi + ues::math::epsilon || inside_polygon ( oa, opposite_angle, ues::math::epsilon ) )
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+
+bool polygon_self_occlusion::inside_polygon ( const occlusion_angles & oa,
+                                              ues::math::numeric_type angle,
+                                              ues::math::numeric_type margin )
+{
+    // Two different cases here, depending on whether the right and left point angles go through the X-axis (angle pi) or not.
+    if ( oa.right <= oa.left )
+    {
+        return oa.right + margin < angle && angle < oa.left - margin;
+    }
+    else
+    {
+        return oa.right + margin < angle || angle < oa.left - margin;
+    }
+}
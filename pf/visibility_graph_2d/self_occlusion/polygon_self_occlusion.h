@@ -39,6 +39,13 @@ public:
     bool check_occluding_segment ( point_index origin_index,
                                    point_index target_index,
                                    segment_index & occluding_segment_index ) const;
+
+    /** Returns true if the line from the point of index \a origin_index to the point of index
+     * \a target_index leaves every polygon the origin belongs to on the same side, and all of them
+     * are convex at the origin. Only such edges can be part of a shortest path. Points that do not
+     * belong to any polygon are always tangent. */
+    bool check_tangent ( point_index origin_index,
+                         point_index target_index ) const;
 private:
     /** Given a polygon and one of the points defining its shape, it contains the angles
      * to the next point to the left and to the right. To determine which point is to the
@@ -52,6 +59,12 @@ private:
         segment_index occluding_index;
     };
 
+    /** Returns true if \a angle is inside the polygon whose occlusion angles are \a oa, at
+     * least by \a margin radians. */
+    static bool inside_polygon ( const occlusion_angles & oa,
+                                 ues::math::numeric_type angle,
+                                 ues::math::numeric_type margin = 0 );
+
     /** For a given point, this list contains occlusion angles for every polygon it belongs to. */
     typedef std::list< occlusion_angles > point_occlusion_info;
 
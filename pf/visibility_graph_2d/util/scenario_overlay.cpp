@@ -0,0 +1,59 @@
+#include "scenario_overlay.h"
+
+#include <limits>
+
+using namespace ues::pf::vg2d;
+
+const point_index scenario_overlay::NULL_POINT_INDEX = std::numeric_limits< point_index >::max();
+
+
+scenario_overlay::scenario_overlay ( const scenario & base, const point_map & base_point_indices )
+    : base ( base ),
+      base_point_indices ( base_point_indices ),
+      split_points ( base.get_segments().size(), NULL_POINT_INDEX )
+{
+}
+
+
+point_index scenario_overlay::add_point ( const ues::geom::point<2> & p )
+{
+    point_map::const_iterator it = base_point_indices.find ( p );
+    if ( it != base_point_indices.end() )
+    {
+        return it->second;
+    }
+
+    it = added_point_indices.find ( p );
+    if ( it != added_point_indices.end() )
+    {
+        return it->second;
+    }
+
+    const point_index index = base.get_points().size() + added_points.size();
+    added_points.push_back ( p );
+    added_point_indices.insert ( std::make_pair ( p, index ) );
+    return index;
+}
+
+
+segment_index scenario_overlay::split_segment ( segment_index s, point_index p )
+{
+    added_segments.push_back ( segment ( p, get_segment ( s ).second ) );
+    added_segment_bases.push_back ( s );
+    split_points[s] = p;
+    return base.get_segments().size() + added_segments.size() - 1;
+}
+
+
+void scenario_overlay::clear() noexcept
+{
+    // Only the base segments that were split need to be reset.
+    for ( segment_index s : added_segment_bases )
+    {
+        split_points[s] = NULL_POINT_INDEX;
+    }
+    added_points.clear();
+    added_point_indices.clear();
+    added_segments.clear();
+    added_segment_bases.clear();
+}
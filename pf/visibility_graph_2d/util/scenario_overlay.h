@@ -0,0 +1,130 @@
+#ifndef UES_PF_VG2D_SCENARIO_OVERLAY_H
+#define UES_PF_VG2D_SCENARIO_OVERLAY_H
+
+#include "scenario.h"
+#include "util.h"
+
+namespace ues
+{
+namespace pf
+{
+namespace vg2d
+{
+
+/** The scenario_overlay class is a view of a base scenario in which some segments have been split
+ * in two at a new point. Split points and the second halves of split segments get indices past
+ * those of the base scenario, and the base scenario is neither copied nor modified. The base
+ * scenario and its point map must outlive the overlay. An overlay can be cleared and reused for
+ * a different set of splits without allocating again. */
+class scenario_overlay
+{
+public:
+    /** Creates an overlay without splits on top of \a base. The map \a base_point_indices must
+     * contain the index of every point of \a base, and is used to reuse existing points. */
+    scenario_overlay ( const scenario & base, const point_map & base_point_indices );
+
+    /** Returns the index of a point with the coordinates of \a p, adding it to the overlay if
+     * neither the base scenario nor the overlay contain it. */
+    point_index add_point ( const ues::geom::point<2> & p );
+
+    /** Splits the base segment of index \a s at the point of index \a p. The segment \a s then
+     * ends at \a p, and the index of the new segment from \a p to the former end is returned. */
+    segment_index split_segment ( segment_index s, point_index p );
+
+    /** Removes all the points and splits added to the overlay. */
+    void clear() noexcept;
+
+    /** \name Getter methods */
+    /** \{ */
+    inline const scenario & get_base() const noexcept;
+
+    inline point_index get_point_count() const noexcept;
+    inline segment_index get_segment_count() const noexcept;
+
+    /** Returns the number of points added to the base scenario. */
+    inline point_index get_added_point_count() const noexcept;
+
+    inline const ues::geom::point<2> & get_point ( point_index ) const noexcept;
+    inline segment get_segment ( segment_index ) const noexcept;
+
+    /** Returns the index of the base segment the segment of index \a s is part of. */
+    inline segment_index get_base_segment ( segment_index s ) const noexcept;
+    /** \} */
+
+private:
+    const scenario & base;
+    const point_map & base_point_indices;
+
+    /** Points added to the base scenario, and an index to find them by their coordinates. */
+    point_vector added_points;
+    point_map added_point_indices;
+
+    /** Second halves of split segments, and the base segment each of them comes from. */
+    segment_vector added_segments;
+    segment_index_vector added_segment_bases;
+
+    /** For every base segment, the point at which it has been split, or NULL_POINT_INDEX. */
+    point_index_vector split_points;
+    static const point_index NULL_POINT_INDEX;
+};
+
+// Inlined methods.
+
+const scenario & scenario_overlay::get_base() const noexcept
+{
+    return base;
+}
+
+
+point_index scenario_overlay::get_point_count() const noexcept
+{
+    return base.get_points().size() + added_points.size();
+}
+
+
+segment_index scenario_overlay::get_segment_count() const noexcept
+{
+    return base.get_segments().size() + added_segments.size();
+}
+
+
+point_index scenario_overlay::get_added_point_count() const noexcept
+{
+    return added_points.size();
+}
+
+
+const ues::geom::point<2> & scenario_overlay::get_point ( point_index p ) const noexcept
+{
+    const point_vector & base_points = base.get_points();
+    return p < base_points.size() ? base_points[p] : added_points[p - base_points.size()];
+}
+
+
+segment scenario_overlay::get_segment ( segment_index s ) const noexcept
+{
+    const segment_vector & base_segments = base.get_segments();
+    if ( s < base_segments.size() )
+    {
+        segment result = base_segments[s];
+        if ( split_points[s] != NULL_POINT_INDEX )
+        {
+            result.second = split_points[s];
+        }
+        return result;
+    }
+    return added_segments[s - base_segments.size()];
+}
+
+
+segment_index scenario_overlay::get_base_segment ( segment_index s ) const noexcept
+{
+    const segment_index base_count = base.get_segments().size();
+    return s < base_count ? s : added_segment_bases[s - base_count];
+}
+
+}
+}
+}
+
+#endif // UES_PF_VG2D_SCENARIO_OVERLAY_H
@@ -17,10 +17,13 @@
 
 #include "visibility_graph.h"
 
+#include <algorithm>
 #include <cassert>
 
 #include <exc/exception.h>
 
+#include <pf/visibility_graph/mapped_visibility_graph.h>
+
 using namespace ues::pf::vg2d;
 
 
@@ -126,9 +129,86 @@ void visibility_graph::describe ( std::ostream & out ) const noexcept
 }
 
 
+void visibility_graph::save ( std::ostream & out, ues::pf::mapped_visibility_graph<2>::point_numbering numbering ) const
+{
+    ues::pf::mapped_visibility_graph<2>::occlusion_table occlusions;
+    occlusions.offsets.reserve ( size() + 1 );
+    occlusions.offsets.push_back ( 0 );
+    for ( size_type i = 0; i < size(); ++i )
+    {
+        std::vector< std::pair< std::uint64_t, std::uint64_t > > row ( osv[i].begin(), osv[i].end() );
+        std::sort ( row.begin(), row.end() );
+        for ( const std::pair< std::uint64_t, std::uint64_t > & occlusion : row )
+        {
+            occlusions.targets.push_back ( occlusion.first );
+            occlusions.segments.push_back ( occlusion.second );
+        }
+        occlusions.offsets.push_back ( occlusions.targets.size() );
+    }
+    occlusions.segment_endpoints.assign ( sv->begin(), sv->end() );
+
+    ues::pf::mapped_visibility_graph<2>::save ( *this, out, &occlusions, numbering );
+}
+
+
+std::shared_ptr< visibility_graph > visibility_graph::load ( const ues::pf::mapped_visibility_graph<2> & saved,
+                                                            shared_point_vector pv,
+                                                            shared_segment_vector sv )
+{
+    if ( saved.size() != pv->size() || saved.is_renumbered() || !saved.has_occlusions() || saved.number_of_segments() != sv->size() )
+        throw ues::exc::exception ( "Saved graph does not match the points and segments", UES_CONTEXT );
+
+    for ( point_index i = 0; i < pv->size(); ++i )
+    {
+        if ( saved.point_at ( i ) != (*pv)[i] )
+            throw ues::exc::exception ( "Saved graph does not match the points and segments", UES_CONTEXT );
+    }
+
+    // Every edge is read anyway, so the lists are checked before.
+    saved.validate();
+
+    std::shared_ptr< visibility_graph > result = std::make_shared< visibility_graph > ( std::move ( pv ), std::move ( sv ) );
+    for ( point_index i = 0; i < result->size(); ++i )
+    {
+        // Every edge is saved in both endpoints.
+        saved.for_each_neighbour ( i, [&] ( std::uint64_t j, ues::math::numeric_type distance )
+        {
+            if ( i < j )
+                result->add_visibility ( result->point_at ( i ), result->point_at ( j ), distance );
+        } );
+        saved.for_each_occlusion ( i, [&] ( std::uint64_t j, std::uint64_t segment )
+        {
+            result->add_occlusion_segment ( i, j, segment );
+        } );
+    }
+    return result;
+}
+
+
+std::size_t visibility_graph::memory_size() const noexcept
+{
+    std::size_t result = ues::pf::basic_visibility_graph<2>::memory_size() +
+                         pti.size() * ( sizeof ( point_indices::value_type ) + sizeof ( void * ) ) +
+                         pti.bucket_count() * sizeof ( void * ) +
+                         osv.capacity() * sizeof ( occluding_segments );
+    for ( const occluding_segments & os : osv )
+    {
+        result += os.size() * ( sizeof ( occluding_segments::value_type ) + sizeof ( void * ) ) +
+                  os.bucket_count() * sizeof ( void * );
+    }
+    return result;
+}
+
+
 point_index visibility_graph::point_to_index ( const ues::geom::point<2> & point ) const
 {
-    point_indices::const_iterator pti_it = pti.find ( dynamic_cast< const ues::geom::point<2> & > ( point ) );
+    return index_of ( point );
+}
+
+
+point_index visibility_graph::index_of ( const ues::geom::point<2> & point ) const
+{
+    point_indices::const_iterator pti_it = pti.find ( point );
     if ( pti_it != pti.end() )
     {
         return pti_it->second;
@@ -144,6 +224,6 @@ point_index visibility_graph::point_to_index ( const ues::geom::point<2> & point
 
 const ues::geom::point<2> & visibility_graph::index_to_point ( visibility_graph::size_type point_index ) const
 {
-    return (*this->pv)[point_index];
+    return point_at ( point_index );
 }
 
@@ -19,6 +19,7 @@
 #define UES_PF_VG2D_VISIBILITY_GRAPH_2D_H
 
 #include <pf/visibility_graph/basic_visibility_graph.h>
+#include <pf/visibility_graph/mapped_visibility_graph.h>
 #include <pf/visibility_graph_2d/util/definitions.h>
 
 
@@ -47,6 +48,32 @@ public:
 
     /** Prints the visibility matrix to the \a out parameter. */
     void describe ( std::ostream & out ) const noexcept override;
+
+    /** \name Non-virtual access, for searches that know the type of the graph */
+    /** \{ */
+    /** Returns the index assigned to a point. */
+    size_type index_of ( const ues::geom::point<2> & point ) const;
+    /** Returns the point assigned to an index. */
+    inline const ues::geom::point<2> & point_at ( size_type point_index ) const noexcept;
+    /** \} */
+
+    /** Writes the graph and its occluding segments to \a out, in the binary layout read by
+     * mapped_visibility_graph, with the points numbered in the given order. */
+    void save ( std::ostream & out,
+                ues::pf::mapped_visibility_graph<2>::point_numbering numbering = ues::pf::mapped_visibility_graph<2>::ORIGINAL_NUMBERING ) const;
+
+    /** Builds the graph saved in \a saved, with its original numbering and occluding segments,
+     * over the points \a pv and segments \a sv it was generated from. */
+    static std::shared_ptr< visibility_graph > load ( const ues::pf::mapped_visibility_graph<2> & saved,
+                                                      shared_point_vector pv,
+                                                      shared_segment_vector sv );
+
+    /** Returns an estimate of the bytes of memory used by the graph and its occluding
+     * segments, not including the points and segments it refers to. */
+    std::size_t memory_size() const noexcept;
+
+    size_type point_to_index ( const ues::geom::point<2> & point ) const override;
+    const geom::point<2> & index_to_point ( size_type point_index ) const override;
 private:
     typedef std::unordered_map< ues::geom::point<2>, point_index > point_indices;
     typedef std::unordered_map< point_index, segment_index > occluding_segments;
@@ -57,14 +84,20 @@ private:
     shared_point_vector pv;
     shared_segment_vector sv;
 
-    size_type point_to_index ( const ues::geom::point<2> & point ) const override;
-    const geom::point<2> & index_to_point ( size_type point_index ) const override;
-
     void add_occlusion_segment ( point_index origin, point_index target, segment_index segment );
 
     bool check_occlusion_segment ( point_index origin, point_index target, segment_index & occluding_segment ) const;
 };
 
+
+// Inlined methods.
+
+
+const ues::geom::point<2> & visibility_graph::point_at ( size_type point_index ) const noexcept
+{
+    return (*pv)[point_index];
+}
+
 }
 }
 }
@@ -0,0 +1,477 @@
+/*
+ * Copyright 2015-2017 Guillermo Frontera <guillermo.frontera@upm.es>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include "visibility_graph_cache.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <iterator>
+#include <sstream>
+#include <unordered_set>
+
+#include <exc/exception.h>
+#include <log/logger.h>
+#include <misc/binary_io.h>
+#include <pf/visibility_graph/mapped_visibility_graph.h>
+
+using namespace ues::pf::vg2d;
+
+const std::string component_name = "2D Visibility Graph Cache";
+
+const std::size_t visibility_graph_cache::DEFAULT_MEMORY_BUDGET = 256 << 20;
+
+namespace
+{
+
+/** Identifier of the format of the cached graph files, and its current version. */
+const std::uint32_t FORMAT_MAGIC = 0x43564555; // "UEVC"
+const std::uint32_t FORMAT_VERSION = 2;
+
+/** Name of the file that lists the graphs of a directory. */
+const std::string INDEX_FILE_NAME = "visibility_graphs.index";
+
+/** Appends the raw representation of \a value to \a key. */
+template<class T>
+void append ( std::string & key, const T & value )
+{
+    key.append ( reinterpret_cast<const char *> ( &value ), sizeof ( T ) );
+}
+
+
+/** Returns the canonical representation of the scenario whose graph is generated by
+ * \a generator from the \a segments and \a polygons. */
+std::string scenario_key ( const visibility_graph_generator & generator,
+                           const segment_vector & segments,
+                           const polygon_vector & polygons )
+{
+    const point_vector & points = *generator.get_points();
+
+    std::string key;
+    key.reserve ( 4 * sizeof ( std::uint64_t ) + points.size() * 2 * sizeof ( double ) + segments.size() * 3 * sizeof ( std::uint64_t ) );
+
+    append ( key, static_cast<std::uint64_t> ( generator.get_edge_selection() ) );
+    append ( key, static_cast<std::uint64_t> ( generator.get_algorithm() ) );
+    append ( key, static_cast<std::uint64_t> ( points.size() ) );
+    for ( const ues::geom::point<2> & p : points )
+    {
+        // Adding zero turns negative zeros into zeros, as they are the same coordinate.
+        append ( key, p.get_x() + 0.0 );
+        append ( key, p.get_y() + 0.0 );
+    }
+    append ( key, static_cast<std::uint64_t> ( segments.size() ) );
+    for ( const segment & s : segments )
+    {
+        append ( key, static_cast<std::uint64_t> ( s.first ) );
+        append ( key, static_cast<std::uint64_t> ( s.second ) );
+    }
+    append ( key, static_cast<std::uint64_t> ( polygons.size() ) );
+    for ( const polygon & p : polygons )
+    {
+        append ( key, static_cast<std::uint64_t> ( p.size() ) );
+        for ( segment_index s : p )
+        {
+            append ( key, static_cast<std::uint64_t> ( s ) );
+        }
+    }
+    return key;
+}
+
+
+/** Returns the file of the graph of hash \a hash in \a directory. */
+std::string graph_file_name ( const std::string & directory, std::uint64_t hash )
+{
+    std::ostringstream result;
+    result << directory << '/' << std::hex;
+    result.width ( 16 );
+    result.fill ( '0' );
+    result << hash << ".vgc";
+    return result.str();
+}
+
+
+/** Returns the 64-bit FNV-1a hash of \a key. */
+std::uint64_t hash_key ( const std::string & key ) noexcept
+{
+    std::uint64_t result = 0xcbf29ce484222325ull;
+    for ( char c : key )
+    {
+        result ^= static_cast<unsigned char> ( c );
+        result *= 0x100000001b3ull;
+    }
+    return result;
+}
+
+}
+
+
+visibility_graph_cache::visibility_graph_cache ( std::size_t memory_budget )
+    : stats { 0, 0, 0, 0 },
+      memory_budget ( memory_budget ),
+      memory_size ( 0 ),
+      disk_budget ( 0 ),
+      disk_size ( 0 ),
+      index_changed ( false ),
+      index_version ( 0 ),
+      written_index_version ( 0 )
+{
+}
+
+
+visibility_graph_cache & visibility_graph_cache::get_shared_cache()
+{
+    static visibility_graph_cache shared_cache;
+    return shared_cache;
+}
+
+
+std::shared_ptr< const visibility_graph > visibility_graph_cache::get_visibility_graph ( visibility_graph_generator & generator,
+                                                                                        const shared_segment_vector & segments,
+                                                                                        const shared_polygon_vector & polygons )
+{
+    ues::log::logger lg;
+
+    std::string key = scenario_key ( generator, *segments, *polygons );
+    const std::uint64_t hash = hash_key ( key );
+
+    // Files are read and written without holding the lock, so other threads can use the cache
+    // meanwhile. The directory is copied, as it may be changed in the meantime.
+    std::string current_directory;
+    bool on_disk;
+    {
+        std::lock_guard< std::mutex > lock ( mtx );
+
+        std::unordered_map< std::uint64_t, memory_list::iterator >::iterator memory_it = memory_index.find ( hash );
+        if ( memory_it != memory_index.end() && memory_it->second->key == key )
+        {
+            memory_entries.splice ( memory_entries.begin(), memory_entries, memory_it->second );
+            ++stats.memory_hits;
+            return memory_it->second->graph;
+        }
+
+        current_directory = directory;
+        on_disk = !directory.empty() && disk_index.find ( hash ) != disk_index.end();
+    }
+
+    if ( on_disk )
+    {
+        std::shared_ptr< const visibility_graph > graph;
+        try
+        {
+            graph = read_graph ( graph_file_name ( current_directory, hash ), key, generator.get_points(), segments );
+        }
+        catch ( ues::exc::exception & e )
+        {
+            if ( lg.min_level() <= ues::log::WARNING_LVL )
+            {
+                ues::log::event ev ( ues::log::WARNING_LVL, component_name, "Unable to read cached visibility graph" );
+                ev.message() << e.what() << '\n';
+                lg.record ( std::move ( ev ) );
+            }
+        }
+
+        if ( graph )
+        {
+            // The new order of the directory is only saved when graphs are added or evicted.
+            std::unique_lock< std::mutex > lock ( mtx );
+            std::unordered_map< std::uint64_t, disk_list::iterator >::iterator disk_it = disk_index.find ( hash );
+            if ( directory == current_directory && disk_it != disk_index.end() )
+                disk_entries.splice ( disk_entries.begin(), disk_entries, disk_it->second );
+            ++stats.disk_hits;
+            insert_memory ( hash, std::move ( key ), graph );
+            flush_disk ( lock );
+            return graph;
+        }
+    }
+
+    // Other threads may use the cache while the graph is generated.
+    std::shared_ptr< const visibility_graph > graph = generator.generate_visibility_graph ( segments, polygons );
+
+    std::size_t written_size = 0;
+    if ( !current_directory.empty() )
+    {
+        try
+        {
+            std::lock_guard< std::mutex > io_lock ( io_mtx );
+            written_size = write_graph ( graph_file_name ( current_directory, hash ), key, *graph );
+        }
+        catch ( ues::exc::exception & e )
+        {
+            if ( lg.min_level() <= ues::log::WARNING_LVL )
+            {
+                ues::log::event ev ( ues::log::WARNING_LVL, component_name, "Unable to write cached visibility graph" );
+                ev.message() << e.what() << '\n';
+                lg.record ( std::move ( ev ) );
+            }
+        }
+    }
+
+    std::unique_lock< std::mutex > lock ( mtx );
+    ++stats.misses;
+    if ( written_size > 0 && directory == current_directory )
+        insert_disk ( hash, written_size );
+    insert_memory ( hash, std::move ( key ), graph );
+    flush_disk ( lock );
+    return graph;
+}
+
+
+void visibility_graph_cache::set_memory_budget ( std::size_t memory_budget )
+{
+    std::unique_lock< std::mutex > lock ( mtx );
+    this->memory_budget = memory_budget;
+    evict();
+    flush_disk ( lock );
+}
+
+
+void visibility_graph_cache::set_directory ( const std::string & directory, std::size_t disk_budget )
+{
+    // Reading the index checks every file, so it is done before taking the lock.
+    disk_list entries;
+    if ( !directory.empty() )
+        entries = read_index ( directory );
+
+    std::unique_lock< std::mutex > lock ( mtx );
+    this->directory = directory;
+    this->disk_budget = disk_budget;
+    disk_entries = std::move ( entries );
+    disk_index.clear();
+    disk_size = 0;
+    for ( disk_list::iterator it = disk_entries.begin(); it != disk_entries.end(); ++it )
+    {
+        disk_index[it->hash] = it;
+        disk_size += it->size;
+    }
+    evict();
+    flush_disk ( lock );
+}
+
+
+visibility_graph_cache::counters visibility_graph_cache::get_counters() const
+{
+    std::lock_guard< std::mutex > lock ( mtx );
+    return stats;
+}
+
+
+void visibility_graph_cache::reset_counters()
+{
+    std::lock_guard< std::mutex > lock ( mtx );
+    stats = { 0, 0, 0, 0 };
+}
+
+
+std::size_t visibility_graph_cache::get_memory_size() const
+{
+    std::lock_guard< std::mutex > lock ( mtx );
+    return memory_size;
+}
+
+
+std::size_t visibility_graph_cache::get_disk_size() const
+{
+    std::lock_guard< std::mutex > lock ( mtx );
+    return disk_size;
+}
+
+
+void visibility_graph_cache::clear()
+{
+    std::lock_guard< std::mutex > lock ( mtx );
+    memory_entries.clear();
+    memory_index.clear();
+    memory_size = 0;
+}
+
+
+std::shared_ptr< const visibility_graph > visibility_graph_cache::read_graph ( const std::string & file,
+                                                                              const std::string & key,
+                                                                              const shared_point_vector & points,
+                                                                              const shared_segment_vector & segments )
+{
+    using ues::misc::read_binary;
+
+    std::ifstream in ( file, std::ios::binary );
+    if ( !in )
+        throw ues::exc::exception ( "Unable to open file " + file, UES_CONTEXT );
+
+    std::uint32_t magic, version;
+    read_binary ( in, magic );
+    read_binary ( in, version );
+    if ( magic != FORMAT_MAGIC || version != FORMAT_VERSION )
+        throw ues::exc::exception ( "File " + file + " is not a cached visibility graph", UES_CONTEXT );
+
+    // The file may hold the graph of another scenario with the same hash.
+    std::vector<char> saved_key;
+    read_binary ( in, saved_key );
+    if ( saved_key.size() != key.size() || !std::equal ( saved_key.begin(), saved_key.end(), key.begin() ) )
+        return nullptr;
+
+    // The graph is copied to memory aligned to 8 bytes, as the mapped layout requires.
+    std::uint64_t graph_size;
+    read_binary ( in, graph_size );
+    std::shared_ptr< std::vector< std::uint64_t > > buffer = std::make_shared< std::vector< std::uint64_t > > ( ( graph_size + 7 ) / 8 );
+    in.read ( reinterpret_cast<char *> ( buffer->data() ), graph_size );
+    if ( !in )
+        throw ues::exc::exception ( "File " + file + " is truncated", UES_CONTEXT );
+
+    ues::pf::mapped_visibility_graph<2> saved ( std::shared_ptr<const void> ( buffer, buffer->data() ), graph_size );
+    return visibility_graph::load ( saved, points, segments );
+}
+
+
+std::size_t visibility_graph_cache::write_graph ( const std::string & file, const std::string & key, const visibility_graph & graph )
+{
+    using ues::misc::write_binary;
+
+    std::ostringstream saved_graph;
+    graph.save ( saved_graph );
+    const std::string bytes = saved_graph.str();
+
+    std::ofstream out ( file, std::ios::binary | std::ios::trunc );
+    if ( !out )
+        throw ues::exc::exception ( "Unable to create file " + file, UES_CONTEXT );
+
+    write_binary ( out, FORMAT_MAGIC );
+    write_binary ( out, FORMAT_VERSION );
+    write_binary ( out, static_cast<std::uint64_t> ( key.size() ) );
+    write_binary ( out, key.data(), key.size() );
+    write_binary ( out, static_cast<std::uint64_t> ( bytes.size() ) );
+    write_binary ( out, bytes.data(), bytes.size() );
+    out.close();
+    if ( !out )
+        throw ues::exc::exception ( "Unable to write file " + file, UES_CONTEXT );
+
+    return 2 * sizeof ( std::uint32_t ) + 2 * sizeof ( std::uint64_t ) + key.size() + bytes.size();
+}
+
+
+void visibility_graph_cache::insert_memory ( std::uint64_t hash, std::string key, std::shared_ptr< const visibility_graph > graph )
+{
+    const std::size_t size = graph->memory_size() + key.size();
+    if ( size > memory_budget )
+        return;
+
+    // A graph with the same hash is replaced.
+    std::unordered_map< std::uint64_t, memory_list::iterator >::iterator it = memory_index.find ( hash );
+    if ( it != memory_index.end() )
+    {
+        memory_size -= it->second->size;
+        memory_entries.erase ( it->second );
+        memory_index.erase ( it );
+    }
+
+    memory_entries.push_front ( { hash, std::move ( key ), std::move ( graph ), size } );
+    memory_index[hash] = memory_entries.begin();
+    memory_size += size;
+    evict();
+}
+
+
+void visibility_graph_cache::insert_disk ( std::uint64_t hash, std::size_t size )
+{
+    std::unordered_map< std::uint64_t, disk_list::iterator >::iterator it = disk_index.find ( hash );
+    if ( it != disk_index.end() )
+    {
+        disk_size -= it->second->size;
+        disk_entries.erase ( it->second );
+        disk_index.erase ( it );
+    }
+
+    disk_entries.push_front ( { hash, size } );
+    disk_index[hash] = disk_entries.begin();
+    disk_size += size;
+    index_changed = true;
+    evict();
+}
+
+
+void visibility_graph_cache::evict()
+{
+    while ( memory_size > memory_budget )
+    {
+        memory_size -= memory_entries.back().size;
+        memory_index.erase ( memory_entries.back().hash );
+        memory_entries.pop_back();
+        ++stats.evictions;
+    }
+
+    // The files are removed by flush_disk, once the lock is released.
+    while ( disk_size > disk_budget )
+    {
+        removed_files.push_back ( graph_file_name ( directory, disk_entries.back().hash ) );
+        disk_size -= disk_entries.back().size;
+        disk_index.erase ( disk_entries.back().hash );
+        disk_entries.pop_back();
+        ++stats.evictions;
+        index_changed = true;
+    }
+}
+
+
+void visibility_graph_cache::flush_disk ( std::unique_lock< std::mutex > & lock )
+{
+    std::vector< std::string > files;
+    files.swap ( removed_files );
+    std::ostringstream index;
+    const bool write_index = index_changed && !directory.empty();
+    if ( write_index )
+    {
+        for ( const disk_entry & entry : disk_entries )
+        {
+            index << std::hex << entry.hash << ' ' << std::dec << entry.size << '\n';
+        }
+    }
+    index_changed = false;
+    const std::string index_file = directory + '/' + INDEX_FILE_NAME;
+    const std::uint64_t version = ++index_version;
+    lock.unlock();
+
+    // Several threads may flush at once, so an index is never written over a more recent one.
+    std::lock_guard< std::mutex > io_lock ( io_mtx );
+    for ( const std::string & file : files )
+    {
+        std::remove ( file.c_str() );
+    }
+    if ( write_index && version > written_index_version )
+    {
+        std::ofstream out ( index_file, std::ios::trunc );
+        out << index.str();
+        written_index_version = version;
+    }
+}
+
+
+visibility_graph_cache::disk_list visibility_graph_cache::read_index ( const std::string & directory )
+{
+    std::ifstream in ( directory + '/' + INDEX_FILE_NAME );
+
+    disk_list result;
+    std::unordered_set< std::uint64_t > listed;
+    std::uint64_t hash;
+    std::size_t size;
+    while ( in >> std::hex >> hash >> std::dec >> size )
+    {
+        // Graphs whose files were removed are forgotten.
+        if ( listed.insert ( hash ).second && std::ifstream ( graph_file_name ( directory, hash ) ) )
+        {
+            result.push_back ( { hash, size } );
+        }
+    }
+    return result;
+}
@@ -0,0 +1,175 @@
+/*
+ * Copyright 2015-2017 Guillermo Frontera <guillermo.frontera@upm.es>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#ifndef UES_PF_VG2D_VISIBILITY_GRAPH_CACHE_H
+#define UES_PF_VG2D_VISIBILITY_GRAPH_CACHE_H
+
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include <pf/visibility_graph_2d/util/definitions.h>
+#include <pf/visibility_graph_2d/visibility_graph.h>
+#include <pf/visibility_graph_2d/visibility_graph_generator.h>
+
+namespace ues
+{
+namespace pf
+{
+namespace vg2d
+{
+
+/** The visibility_graph_cache class keeps the visibility graphs already generated, so the same
+ * scenario is not generated twice. Graphs are addressed by the contents of their scenario: the
+ * coordinates of the points, the segments, the polygons and the edges selected. They are kept in
+ * memory, and optionally in a directory so they survive the process, each storage under its own
+ * size budget; the least recently used graphs are evicted first. The cache may be used by
+ * several threads at once. */
+class visibility_graph_cache
+{
+public:
+    /** Number of lookups answered by each storage. */
+    struct counters
+    {
+        std::size_t memory_hits;
+        std::size_t disk_hits;
+        std::size_t misses;
+        std::size_t evictions;
+    };
+
+    /** Default size budget of the memory storage, in bytes. */
+    static const std::size_t DEFAULT_MEMORY_BUDGET;
+
+    /** Constructor method. Graphs are only kept in memory, up to \a memory_budget bytes. */
+    visibility_graph_cache ( std::size_t memory_budget = DEFAULT_MEMORY_BUDGET );
+
+    visibility_graph_cache ( const visibility_graph_cache & ) = delete;
+    visibility_graph_cache & operator= ( const visibility_graph_cache & ) = delete;
+
+    /** Returns the cache shared by the 2D pathfinders. */
+    static visibility_graph_cache & get_shared_cache();
+
+    /** Returns the graph that \a generator generates for the \a segments and \a polygons, which
+     * is generated only if it is not in the cache. The graph must not be modified. */
+    std::shared_ptr< const visibility_graph > get_visibility_graph ( visibility_graph_generator & generator,
+                                                                     const shared_segment_vector & segments,
+                                                                     const shared_polygon_vector & polygons );
+
+    /** Changes the size budget of the memory storage, evicting graphs if needed. A budget of
+     * zero disables it. */
+    void set_memory_budget ( std::size_t memory_budget );
+
+    /** Keeps the graphs in the existing \a directory too, up to \a disk_budget bytes, reusing
+     * those stored by previous processes. An empty directory disables the disk storage. The
+     * directory must not be shared by processes running at the same time. */
+    void set_directory ( const std::string & directory, std::size_t disk_budget );
+
+    /** Returns the number of lookups answered by each storage since the last reset. */
+    counters get_counters() const;
+
+    /** Sets all the counters to zero. */
+    void reset_counters();
+
+    /** Returns the bytes used by the graphs kept in memory. */
+    std::size_t get_memory_size() const;
+
+    /** Returns the bytes used by the graphs kept in the directory. */
+    std::size_t get_disk_size() const;
+
+    /** Removes all the graphs from memory. The graphs in the directory are kept. */
+    void clear();
+
+private:
+    /** A graph kept in memory, with the scenario it was generated for. */
+    struct memory_entry
+    {
+        std::uint64_t hash;
+        std::string key;
+        std::shared_ptr< const visibility_graph > graph;
+        std::size_t size;
+    };
+
+    /** A graph kept in the directory. */
+    struct disk_entry
+    {
+        std::uint64_t hash;
+        std::size_t size;
+    };
+
+    typedef std::list< memory_entry > memory_list;
+    typedef std::list< disk_entry > disk_list;
+
+    mutable std::mutex mtx;
+    /** Serializes the writes and removals of files, which are done without holding mtx. */
+    std::mutex io_mtx;
+    counters stats;
+
+    std::size_t memory_budget;
+    std::size_t memory_size;
+    /** Graphs in memory, from the most to the least recently used. */
+    memory_list memory_entries;
+    std::unordered_map< std::uint64_t, memory_list::iterator > memory_index;
+
+    std::string directory;
+    std::size_t disk_budget;
+    std::size_t disk_size;
+    /** Graphs in the directory, from the most to the least recently used. */
+    disk_list disk_entries;
+    std::unordered_map< std::uint64_t, disk_list::iterator > disk_index;
+    /** Files of the evicted graphs, pending to be removed. */
+    std::vector< std::string > removed_files;
+    /** Whether the graphs of the directory have changed since the index was last written. */
+    bool index_changed;
+    /** Number of flushes, and the one whose index was written last, guarded by io_mtx. */
+    std::uint64_t index_version;
+    std::uint64_t written_index_version;
+
+    /** Reads the graph stored in \a file, if it was stored for the scenario \a key. */
+    static std::shared_ptr< const visibility_graph > read_graph ( const std::string & file,
+                                                                  const std::string & key,
+                                                                  const shared_point_vector & points,
+                                                                  const shared_segment_vector & segments );
+
+    /** Writes the \a graph to \a file, and returns the bytes written. */
+    static std::size_t write_graph ( const std::string & file, const std::string & key, const visibility_graph & graph );
+
+    /** Adds a graph to memory, evicting others if needed. */
+    void insert_memory ( std::uint64_t hash, std::string key, std::shared_ptr< const visibility_graph > graph );
+
+    /** Adds a graph to the directory index, evicting others if needed. */
+    void insert_disk ( std::uint64_t hash, std::size_t size );
+
+    /** Evicts graphs until both storages fit in their budgets. */
+    void evict();
+
+    /** Releases the \a lock, and then removes the files of the evicted graphs and writes the
+     * index of the directory if it has changed. */
+    void flush_disk ( std::unique_lock< std::mutex > & lock );
+
+    /** Reads the index of the \a directory, dropping the graphs whose files are missing. */
+    static disk_list read_index ( const std::string & directory );
+};
+
+}
+}
+}
+
+#endif // UES_PF_VG2D_VISIBILITY_GRAPH_CACHE_H
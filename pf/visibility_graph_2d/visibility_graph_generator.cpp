@@ -17,6 +17,7 @@
 
 #include "visibility_graph_generator.h"
 
+#include <exception>
 #include <unordered_set>
 
 #include <exc/exception.h>
@@ -25,6 +26,8 @@
 #include "envelope_generation/visibility_problem_solver.h"
 #include "self_occlusion/polygon_self_occlusion.h"
 #include "point_sort/point_sorter.h"
+#include "rotational_sweep/rotational_sweep.h"
+#include "util/scenario_overlay.h"
 #include "util/util.h"
 
 using namespace ues::pf::vg2d;
@@ -46,8 +49,9 @@ ues::math::numeric_type compute_angle ( const ues::geom::point<2> & origin, cons
 }
 
 
-/** Computes the rank of every point in the \a sorted_points vector. */
-void compute_rank ( const point_vector & points,
+/** Computes the rank of every point in the \a sorted_points vector. The output vectors are
+ * overwritten, reusing their memory. */
+void compute_rank ( const scenario_overlay & overlay,
                     const point_index_vector & sorted_points,
                     point_index origin,
                     rank_vector & ranks,
@@ -56,9 +60,11 @@ void compute_rank ( const point_vector & points,
                     ues::log::logger & lg,
                     const ues::math::numeric_type & epsilon )
 {
-    const ues::geom::point<2> & origin_point = points.at ( origin );
+    const ues::geom::point<2> & origin_point = overlay.get_point ( origin );
 
-    unsorted_ranks.resize ( points.size() );
+    ranks.clear();
+    unsorted_ranks.assign ( overlay.get_point_count(), 0 );
+    angles.clear();
 
     ues::math::numeric_type last_angle = 0;
     point_rank current_rank = 0;
@@ -68,7 +74,7 @@ void compute_rank ( const point_vector & points,
 
     for ( point_index p : sorted_points )
     {
-        ues::math::numeric_type current_angle = compute_angle ( origin_point, points.at ( p ), epsilon );
+        ues::math::numeric_type current_angle = compute_angle ( origin_point, overlay.get_point ( p ), epsilon );
 
         if ( std::abs ( current_angle ) <= epsilon )
         {
@@ -95,10 +101,10 @@ void compute_rank ( const point_vector & points,
         {
             std::ostringstream error;
             error << "The points are not correctly sorted. Current angle is " << current_angle << " rad, previous angle was " << last_angle << " rad.\n";
-            error << "Provided sorted points (from " << points [origin] << ") were:\n";
+            error << "Provided sorted points (from " << origin_point << ") were:\n";
             for ( point_index ep : sorted_points )
             {
-                error << ep << ". " << points[ep] << " [" << compute_angle ( origin_point, points[ep], epsilon ) << " rad]";
+                error << ep << ". " << overlay.get_point ( ep ) << " [" << compute_angle ( origin_point, overlay.get_point ( ep ), epsilon ) << " rad]";
                 if ( p == ep )
                 {
                     error << " (current)";
@@ -147,45 +153,25 @@ void compute_rank ( const point_vector & points,
 }
 
 
-/** Splits all the segments crossing the positive y-axis. */
-void split_segments ( const scenario & current_scenario,
+/** Splits all the segments crossing the positive y-axis in \a overlay, which must not contain
+ * any split yet. */
+void split_segments ( scenario_overlay & overlay,
                       const point_index_vector & sorted_points,
                       const point_index origin,
-                      scenario & fixed_scenario,
                       point_index_vector & fixed_sorted_points,
-                      segment_index_vector & segment_equivalence,
                       ues::log::logger & lg )
 {
+    const scenario & current_scenario = overlay.get_base();
     const ues::geom::point<2> & origin_point = current_scenario.get_points() [origin];
 
-    point_vector fixed_points = current_scenario.get_points();
-    segment_vector fixed_segments = current_scenario.get_segments();
-    polygon_vector fixed_polygons;
-
-    // Generate a map to be able to check if a point already exists.
-    point_map added_points;
-    for ( point_index i = 0; i < fixed_points.size(); ++i )
-    {
-        added_points.insert ( std::make_pair ( fixed_points[i], i ) );
-    }
-
-    segment_equivalence.resize ( fixed_segments.size() );
-    for ( segment_index_vector::size_type i = 0; i < fixed_segments.size(); ++i )
-    {
-        segment_equivalence[i] = i;
-    }
-
     for ( const polygon & p : current_scenario.get_polygons() )
     {
-        polygon fixed_p;
         for ( const segment_index si : p )
         {
-            // Add the segment to the fixed polygon.
-            fixed_p.push_back ( si );
-
             // Check if the segment crosses the positive y-axis.
-            const ues::geom::point<2> & p1 = current_scenario.get_points() [ fixed_segments[si].first ];
-            const ues::geom::point<2> & p2 = current_scenario.get_points() [ fixed_segments[si].second ];
+            const segment current_segment = overlay.get_segment ( si );
+            const ues::geom::point<2> & p1 = overlay.get_point ( current_segment.first );
+            const ues::geom::point<2> & p2 = overlay.get_point ( current_segment.second );
 
             if ( ( p1.get_x() <= origin_point.get_x() && origin_point.get_x() < p2.get_x() )
                     || ( p2.get_x() <= origin_point.get_x() && origin_point.get_x() < p1.get_x() ) )
@@ -200,53 +186,45 @@ void split_segments ( const scenario & current_scenario,
                     // There is an intersection point.
 
                     // Add new point only if it hasn't been added before.
-                    ues::geom::point<2> intersection_point ( origin_point.get_x(), intersection_y );
-                    point_index intersection_point_index = add_if_not_present ( fixed_points, added_points, std::move ( intersection_point ) );
+                    point_index intersection_point_index = overlay.add_point ( ues::geom::point<2> ( origin_point.get_x(), intersection_y ) );
 
                     // Modify segments.
-                    segment new_segment ( intersection_point_index, fixed_segments[si].second );
-                    fixed_segments[si].second = intersection_point_index;
-                    fixed_segments.push_back ( std::move ( new_segment ) );
-                    segment_equivalence.push_back ( si );
-
-                    // Add new segment to the polygon.
-                    fixed_p.push_back ( fixed_segments.size() - 1 );
-
+                    overlay.split_segment ( si, intersection_point_index );
                 }
             }
         }
-        fixed_polygons.push_back ( std::move ( fixed_p ) );
     }
 
-    // Add the new points at the start of the sorting
-    for ( point_index_vector::size_type i = current_scenario.get_points().size(); i < fixed_points.size(); ++i )
+    // Add the new points at the start of the sorting, then the rest of the points, and then the
+    // new points also at the end of the sorting.
+    const point_index first_added = current_scenario.get_points().size();
+    const point_index end_added = overlay.get_point_count();
+    fixed_sorted_points.clear();
+    fixed_sorted_points.reserve ( sorted_points.size() + 2 * overlay.get_added_point_count() );
+    for ( point_index i = first_added; i < end_added; ++i )
     {
         fixed_sorted_points.push_back ( i );
     }
-    // Add the rest of the ponts
     fixed_sorted_points.insert ( fixed_sorted_points.end(), sorted_points.begin(), sorted_points.end() );
-    // Add the new points also at the end of the sorting
-    for ( point_index_vector::size_type i = current_scenario.get_points().size(); i < fixed_points.size(); ++i )
+    for ( point_index i = first_added; i < end_added; ++i )
     {
         fixed_sorted_points.push_back ( i );
     }
 
-    fixed_scenario = scenario ( std::move ( fixed_points ), std::move ( fixed_segments ), std::move ( fixed_polygons ) );
-
     if ( lg.min_level() <= ues::log::TRACE_LVL )
     {
         ues::log::event e ( ues::log::TRACE_LVL, component_name, "Finished splitting segments" );
         e.message() << "Points: ";
-        std::for_each ( fixed_scenario.get_points().cbegin(), fixed_scenario.get_points().cend(), [&e] ( const ues::geom::point<2> & p ) { e.message() << p << ", "; } );
+        for ( point_index i = 0; i < overlay.get_point_count(); ++i )
+        {
+            e.message() << overlay.get_point ( i ) << ", ";
+        }
         e.message() << '\n' << "Segments: ";
-        std::for_each ( fixed_scenario.get_segments().cbegin(), fixed_scenario.get_segments().cend(), [&e] ( const segment & se ) { e.message() << "( " << se.first << " - " << se.second << " ), "; } );
-        e.message() << '\n' << "Polygons: ";
-        std::for_each ( fixed_scenario.get_polygons().cbegin(), fixed_scenario.get_polygons().cend(), [&e] ( const polygon & po )
+        for ( segment_index i = 0; i < overlay.get_segment_count(); ++i )
         {
-            e.message() << "( ";
-            std::for_each ( po.cbegin(), po.cend(), [&e] ( const segment_index & si ) { e.message() << si << " "; } );
-            e.message() << "), ";
-        } );
+            const segment se = overlay.get_segment ( i );
+            e.message() << "( " << se.first << " - " << se.second << " ), ";
+        }
         e.message() << '\n' << "Sorted point indices: ";
         std::for_each ( fixed_sorted_points.begin(), fixed_sorted_points.end(), [&e] ( const point_index p ) { e.message() << p << ", "; } );
         e.message() << '\n';
@@ -256,17 +234,19 @@ void split_segments ( const scenario & current_scenario,
 }
 
 
-visibility_problem_solver::segment_rank_vector
-generate_segment_ranks ( const segment_vector & segments,
-                         const rank_vector & unsorted_ranks,
-                         const angle_vector & angles,
-                         ues::log::logger & lg )
+void generate_segment_ranks ( const scenario_overlay & overlay,
+                              const rank_vector & unsorted_ranks,
+                              const angle_vector & angles,
+                              visibility_problem_solver::segment_rank_vector & rank_segments,
+                              ues::log::logger & lg )
 {
     const point_rank max_k = angles.size() - 1;
 
-    visibility_problem_solver::segment_rank_vector rank_segments;
-    for ( const segment & s : segments )
+    rank_segments.clear();
+    rank_segments.reserve ( overlay.get_segment_count() );
+    for ( segment_index i = 0; i < overlay.get_segment_count(); ++i )
     {
+        const segment s = overlay.get_segment ( i );
         point_rank rank1 = unsorted_ranks[s.first];
         point_rank rank2 = unsorted_ranks[s.second];
 
@@ -293,40 +273,54 @@ generate_segment_ranks ( const segment_vector & segments,
         e.message() << '\n';
         lg.record ( std::move ( e ) );
     }
-
-    return rank_segments;
 }
 
 
-/** Adds the information contained in the \a visible_segments and \a visible_points to the visibility graph */
+/** The visibility_entry struct records what is known about a pair of points: either they are
+ * visible, or the index of the segment that occludes them. */
+struct visibility_entry
+{
+    point_index destination;
+    bool visible;
+    segment_index segment;
+};
+
+typedef std::vector< visibility_entry > visibility_entry_vector;
+
+
+/** Records the information contained in the \a visible_points in \a entries, to be added to the
+ * visibility graph later. If \a only_bitangents is set, visible points are only connected by
+ * edges tangent to the polygons of both ends. */
 void complete_visibility ( const point_vector & points,
                            const point_index origin,
                            const visibility_problem_solver::visible_point_vector & visible_points,
-                           const segment_index_vector & segment_equivalence,
+                           const scenario_overlay & overlay,
                            const polygon_self_occlusion & polygon_occlusion_info,
-                           visibility_graph & graph )
+                           bool only_bitangents,
+                           visibility_entry_vector & entries )
 {
-    const ues::geom::point<2> & origin_point = points.at ( origin );
-
     for ( point_vector::size_type i = 0; i < points.size(); ++i )
     {
-        const ues::geom::point<2> & destination_point = points.at ( i );
         segment_index self_occluding_segment_index;
         if ( polygon_occlusion_info.check_occluding_segment ( origin, i, self_occluding_segment_index ) )
         {
-            graph.add_occlusion_segment ( origin_point, destination_point, self_occluding_segment_index );
+            entries.push_back ( { i, false, self_occluding_segment_index } );
         }
         else
         {
             if ( visible_points[i].visible )
             {
-                graph.add_visibility ( origin_point, destination_point, origin_point.distance_to ( destination_point ) );
+                if ( only_bitangents && !( polygon_occlusion_info.check_tangent ( origin, i ) && polygon_occlusion_info.check_tangent ( i, origin ) ) )
+                {
+                    continue;
+                }
+                entries.push_back ( { i, true, NULL_SEGMENT_INDEX } );
             }
             else
             {
                 if ( visible_points[i].segment != NULL_SEGMENT_INDEX )
                 {
-                    graph.add_occlusion_segment ( origin_point, destination_point, segment_equivalence[ visible_points[i].segment ] );
+                    entries.push_back ( { i, false, overlay.get_base_segment ( visible_points[i].segment ) } );
                 }
             }
         }
@@ -334,10 +328,182 @@ void complete_visibility ( const point_vector & points,
 }
 
 
+/** The visibility_workspace struct holds the buffers a worker reuses for the visibility of
+ * every point. */
+struct visibility_workspace
+{
+    /** Constructor method. The overlay is that of \a base, whose points are indexed by
+     * \a base_point_indices, and the buffers are empty. */
+    visibility_workspace ( const scenario & base, const point_map & base_point_indices )
+        : overlay ( base, base_point_indices )
+    {
+    }
+
+    /** Overlay of the scenario in which segments are split. */
+    scenario_overlay overlay;
+    /** Other points of the scenario, sorted around the current point. */
+    point_index_vector sorted_points;
+    /** Sorted points, including the points splitting segments. */
+    point_index_vector fixed_sorted_points;
+    /** Working memory of the sorter. */
+    planar_graph::crossing_buffer crossings;
+    /** Visibility computed by the rotational sweep. */
+    std::vector< bool > visible;
+    segment_index_vector occluding;
+    /** Visibility of every point, computed by either algorithm. */
+    visibility_problem_solver::visible_point_vector visible_points;
+    /** Ranks of the sorted points and of every point of the overlay, and angle of every rank. */
+    rank_vector ranks;
+    rank_vector unsorted_ranks;
+    angle_vector angles;
+    /** Ranks of the ends of every segment of the overlay. */
+    visibility_problem_solver::segment_rank_vector segment_ranks;
+    /** Segments of every rank, bucketed by the envelopes. */
+    visibility_problem_solver::rank_to_segment rank_segments;
+};
+
+
+/** Computes the visibility from the point \a point, and records it in \a entries. The splits of
+ * the segments are made in the overlay of \a workspace, which is cleared afterwards. */
+void compute_point_visibility ( visibility_workspace & workspace,
+                                const point_sorter & sorter,
+                                const polygon_self_occlusion & pso,
+                                point_index point,
+                                bool only_bitangents,
+                                visibility_entry_vector & entries,
+                                ues::log::logger & lg )
+{
+    scenario_overlay & overlay = workspace.overlay;
+    const point_vector & points = overlay.get_base().get_points();
+
+    if ( lg.min_level() <= ues::log::TRACE_LVL )
+    {
+        ues::log::event e ( ues::log::TRACE_LVL, component_name, "Generating 2D visibility from point" );
+        e.message() << "Point: " << point << " " << points[point] << '\n';
+        lg.record ( std::move ( e ) );
+    }
+
+    // Get a sorted list of all the other points.
+    point_index_vector & sorted_points = workspace.sorted_points;
+    sorter.get_sorted_list_of_points ( point, sorted_points, workspace.crossings );
+
+    // Split the segments that intersect the positive y-axis from origin point.
+    point_index_vector & fixed_sorted_points = workspace.fixed_sorted_points;
+    split_segments ( overlay, sorted_points, point, fixed_sorted_points, lg );
+
+    // Compute rank of other points.
+    compute_rank ( overlay, fixed_sorted_points, point, workspace.ranks, workspace.unsorted_ranks, workspace.angles, lg, ues::math::epsilon );
+
+    generate_segment_ranks ( overlay, workspace.unsorted_ranks, workspace.angles, workspace.segment_ranks, lg );
+
+    // Compute the visibility for current point.
+    visibility_problem_solver::visible_point_vector & visible_points = workspace.visible_points;
+    visibility_problem_solver::solve_visibility ( overlay,
+                                                  workspace.angles,
+                                                  point,
+                                                  fixed_sorted_points,
+                                                  workspace.ranks,
+                                                  workspace.segment_ranks,
+                                                  workspace.rank_segments,
+                                                  visible_points );
+
+    // Record the envelope information.
+    complete_visibility ( points, point, visible_points, overlay, pso, only_bitangents, entries );
+
+    workspace.rank_segments.clear();
+    overlay.clear();
+}
+
+
+/** Computes the visibility from the point \a point with the rotational sweep \a sweep, and
+ * records it in \a entries. */
+void compute_point_visibility ( visibility_workspace & workspace,
+                                const rotational_sweep & sweep,
+                                const polygon_self_occlusion & pso,
+                                point_index point,
+                                bool only_bitangents,
+                                visibility_entry_vector & entries,
+                                ues::log::logger & lg )
+{
+    const point_vector & points = workspace.overlay.get_base().get_points();
+
+    if ( lg.min_level() <= ues::log::TRACE_LVL )
+    {
+        ues::log::event e ( ues::log::TRACE_LVL, component_name, "Sweeping 2D visibility from point" );
+        e.message() << "Point: " << point << " " << points[point] << '\n';
+        lg.record ( std::move ( e ) );
+    }
+
+    sweep.compute_visibility ( point, workspace.visible, workspace.occluding );
+
+    // The segments of the scenario are not split, so the overlay is left empty.
+    visibility_problem_solver::visible_point_vector & visible_points = workspace.visible_points;
+    visible_points.resize ( points.size() );
+    for ( point_index i = 0; i < points.size(); ++i )
+    {
+        visible_points[i] = { workspace.visible[i], workspace.occluding[i] };
+    }
+
+    complete_visibility ( points, point, visible_points, workspace.overlay, pso, only_bitangents, entries );
+}
+
+
+const std::size_t visibility_graph_generator::POINTS_PER_THREAD = 16;
+const std::size_t visibility_graph_generator::ROTATIONAL_SWEEP_MAX_POINTS = 10000;
+
+
 visibility_graph_generator::visibility_graph_generator ( shared_point_vector points )
     : points ( std::move ( points ) ),
-      sorter ( this->points ) //< Generate planar graph in O(n^2)
+      selection ( ALL_EDGES ),
+      algorithm ( ENVELOPE_ALGORITHM ),
+      number_of_threads ( 0 )
+{
+}
+
+
+const shared_point_vector & visibility_graph_generator::get_points() const noexcept
+{
+    return points;
+}
+
+
+visibility_graph_generator::edge_selection visibility_graph_generator::get_edge_selection() const noexcept
+{
+    return selection;
+}
+
+
+void visibility_graph_generator::set_edge_selection ( edge_selection selection ) noexcept
+{
+    this->selection = selection;
+}
+
+
+visibility_graph_generator::visibility_algorithm visibility_graph_generator::get_algorithm() const noexcept
+{
+    return algorithm;
+}
+
+
+void visibility_graph_generator::set_algorithm ( visibility_algorithm algorithm ) noexcept
 {
+    this->algorithm = algorithm;
+}
+
+
+unsigned int visibility_graph_generator::get_number_of_threads() const noexcept
+{
+    return number_of_threads;
+}
+
+
+void visibility_graph_generator::set_number_of_threads ( unsigned int number_of_threads ) noexcept
+{
+    if ( number_of_threads != this->number_of_threads )
+    {
+        this->number_of_threads = number_of_threads;
+        pool.reset();
+    }
 }
 
 
@@ -372,52 +538,95 @@ visibility_graph_generator::generate_visibility_graph ( const shared_segment_vec
         // Build the scenario object.
         scenario current_scenario ( points, segments, polygons );
 
+        // Index the points by their coordinates, so the points splitting segments are found
+        // without hashing the whole scenario again for every point.
+        point_map point_indices;
+        for ( point_index i = 0; i < points->size(); ++i )
+        {
+            point_indices.insert ( std::make_pair ( ( *points ) [i], i ) );
+        }
+
         // Generate self occluding polygon info.
         polygon_self_occlusion pso ( current_scenario );
 
-        // For each point:
-        for ( point_index point = 0; point < points->size(); ++point )
+        // The visibility from every point only reads the scenario and the sorter, so points are
+        // processed in parallel, in batches. The entries of each batch are added to the graph in
+        // the order of the points, so the graph is the same as if they were processed one by
+        // one. Traces are not recorded concurrently, so they force a single thread.
+        const bool sequential = number_of_threads == 1 || lg.min_level() <= ues::log::TRACE_LVL;
+        if ( !sequential && !pool )
+        {
+            pool = std::make_shared< ues::misc::thread_pool > ( number_of_threads );
+        }
+        const std::size_t batch_size = sequential ? 1 : pool->size() * POINTS_PER_THREAD;
+
+        // The rotational sweep is cheaper for small scenarios, as it does not sort the points
+        // beforehand. Otherwise, the points are sorted with the first graph generated, in
+        // parallel too.
+        const bool use_sweep = algorithm == ROTATIONAL_SWEEP_ALGORITHM ||
+                               ( algorithm == AUTOMATIC_ALGORITHM && points->size() <= ROTATIONAL_SWEEP_MAX_POINTS );
+        std::unique_ptr< rotational_sweep > sweep;
+        if ( use_sweep )
         {
+            sweep = std::make_unique< rotational_sweep > ( current_scenario );
+        }
+        else if ( !sorter )
+        {
+            sorter = std::make_unique< point_sorter > ( points, sequential ? nullptr : pool.get() );
+        }
+        const bool only_bitangents = selection == BITANGENT_EDGES;
+
+        // Every worker has its own overlay of the scenario and buffers.
+        std::vector< visibility_workspace > workspaces ( sequential ? 1 : pool->size(),
+                                                         visibility_workspace ( current_scenario, point_indices ) );
 
-            if ( lg.min_level() <= ues::log::TRACE_LVL )
+        std::vector< visibility_entry_vector > batch_entries ( std::min<std::size_t> ( batch_size, points->size() ) );
+        std::vector< std::exception_ptr > batch_errors ( batch_entries.size() );
+        for ( point_index first = 0; first < points->size(); first += batch_size )
+        {
+            const std::size_t count = std::min<std::size_t> ( batch_size, points->size() - first );
+            auto compute = [&] ( std::size_t i, unsigned int worker )
             {
-                ues::log::event e ( ues::log::TRACE_LVL, component_name, "Generating 2D visibility from point" );
-                e.message() << "Point: " << point << " " << ( *points ) [point] << '\n';
-                lg.record ( std::move ( e ) );
+                batch_entries[i].clear();
+                batch_errors[i] = nullptr;
+                try
+                {
+                    if ( use_sweep )
+                        compute_point_visibility ( workspaces[worker], *sweep, pso, first + i, only_bitangents, batch_entries[i], lg );
+                    else
+                        compute_point_visibility ( workspaces[worker], *sorter, pso, first + i, only_bitangents, batch_entries[i], lg );
+                }
+                catch ( ... )
+                {
+                    workspaces[worker].overlay.clear();
+                    batch_errors[i] = std::current_exception();
+                }
+            };
+            if ( sequential )
+            {
+                compute ( 0, 0 );
+            }
+            else
+            {
+                pool->run ( count, compute );
             }
 
-            // Get a sorted list of all the other points.
-            point_index_vector sorted_points = sorter.get_sorted_list_of_points ( point );
-
-            // Split the segments that intersect the positive y-axis from origin point.
-            scenario fixed_scenario;
-            point_index_vector fixed_sorted_points;
-            segment_index_vector segment_equivalence;
-            split_segments ( current_scenario, sorted_points, point,
-                             fixed_scenario, fixed_sorted_points, segment_equivalence, lg );
-
-            // Compute rank of other points.
-            rank_vector ranks;
-            rank_vector unsorted_ranks;
-            angle_vector angles;
-            compute_rank ( fixed_scenario.get_points(), fixed_sorted_points, point, ranks, unsorted_ranks, angles, lg, ues::math::epsilon );
-
-            visibility_problem_solver::segment_rank_vector segment_ranks = generate_segment_ranks ( fixed_scenario.get_segments(), unsorted_ranks, angles, lg );
-
-            // Compute the visibility for current point.
-            visibility_problem_solver::visible_point_vector visible_points;
-            visibility_problem_solver::solve_visibility ( fixed_scenario.get_points(),
-                                                          fixed_scenario.get_segments(),
-                                                          angles,
-                                                          point,
-                                                          fixed_sorted_points,
-                                                          ranks,
-                                                          segment_ranks,
-                                                          visible_points );
-
-            // Fill the graph with envelope information.
-            complete_visibility ( *points, point, visible_points, segment_equivalence, pso, *result );
+            for ( std::size_t i = 0; i < count; ++i )
+            {
+                // Report the error of the first point that failed, as a sequential run would.
+                if ( batch_errors[i] )
+                    std::rethrow_exception ( batch_errors[i] );
 
+                const ues::geom::point<2> & origin_point = ( *points ) [first + i];
+                for ( const visibility_entry & entry : batch_entries[i] )
+                {
+                    const ues::geom::point<2> & destination_point = ( *points ) [entry.destination];
+                    if ( entry.visible )
+                        result->add_visibility ( origin_point, destination_point, origin_point.distance_to ( destination_point ) );
+                    else
+                        result->add_occlusion_segment ( origin_point, destination_point, entry.segment );
+                }
+            }
         }
 
         if ( lg.min_level() <= ues::log::TRACE_LVL )
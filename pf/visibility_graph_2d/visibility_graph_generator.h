@@ -18,6 +18,9 @@
 #ifndef UES_PF_VG2D_VISIBILITY_GRAPH_GENERATOR_H
 #define UES_PF_VG2D_VISIBILITY_GRAPH_GENERATOR_H
 
+#include <memory>
+
+#include <misc/thread_pool.h>
 #include <pf/visibility_graph_2d/util/definitions.h>
 #include <pf/visibility_graph_2d/visibility_graph.h>
 #include <pf/visibility_graph_2d/point_sort/point_sorter.h>
@@ -32,14 +35,83 @@ namespace vg2d
 class visibility_graph_generator
 {
 public:
+    /** Edges of the visibility graph that are added to the generated graph. */
+    enum edge_selection
+    {
+        /** Every pair of mutually visible points. */
+        ALL_EDGES,
+        /** Only the edges tangent to the polygons of both endpoints, at convex vertices (the
+         * reduced visibility graph). Shortest paths only use such edges, so their length does
+         * not change, while most of the edges are discarded. */
+        BITANGENT_EDGES
+    };
+
+    /** Algorithms that compute the visibility from every point. They generate the same edges and
+     * occluding segments, except in two cases: when several segments meet at the point that
+     * blocks the view, any of them may be reported; and where the envelopes report a segment
+     * that ends at the viewpoint itself, the sweep reports the obstacle actually in front. Their
+     * costs differ. */
+    enum visibility_algorithm
+    {
+        /** The rotational sweep for scenarios of up to ROTATIONAL_SWEEP_MAX_POINTS points, and
+         * the visibility envelopes for larger ones. */
+        AUTOMATIC_ALGORITHM,
+        /** Visibility envelopes over the points sorted around every point. Sorting takes
+         * quadratic time and memory once per generator, and then linear time per point. This is
+         * the default algorithm. */
+        ENVELOPE_ALGORITHM,
+        /** Rotational sweep of the points around every point (Lee's algorithm), in
+         * O(n log n) time per point and without any precomputation. */
+        ROTATIONAL_SWEEP_ALGORITHM
+    };
+
+    /** Largest number of points for which the automatic algorithm is the rotational sweep.
+     * Generating whole graphs on one thread, the sweep was 2.5 to 3 times faster than the
+     * envelopes at every size measured, from 20 to 7960 points, but its cost per point grows
+     * faster. The DISABLED_visibility_graph_generator_crossover_benchmark test measures both. */
+    static const std::size_t ROTATIONAL_SWEEP_MAX_POINTS;
+
     visibility_graph_generator ( shared_point_vector points );
 
+    /** Returns the points of the generated graphs. */
+    const shared_point_vector & get_points() const noexcept;
+
+    /** Returns the edges added to the generated graphs. */
+    edge_selection get_edge_selection() const noexcept;
+
+    /** Changes the edges added to the generated graphs. */
+    void set_edge_selection ( edge_selection selection ) noexcept;
+
+    /** Returns the algorithm that computes the visibility from the points. */
+    visibility_algorithm get_algorithm() const noexcept;
+
+    /** Changes the algorithm that computes the visibility from the points. */
+    void set_algorithm ( visibility_algorithm algorithm ) noexcept;
+
+    /** Returns the number of threads that compute the visibility from the points, or zero if
+     * there are as many as hardware threads. */
+    unsigned int get_number_of_threads() const noexcept;
+
+    /** Changes the number of threads that compute the visibility from the points. If zero, as
+     * many as hardware threads are used. The generated graphs do not depend on it. */
+    void set_number_of_threads ( unsigned int number_of_threads ) noexcept;
+
     std::shared_ptr< visibility_graph > generate_visibility_graph ( const shared_segment_vector & segments,
                                                                     const shared_polygon_vector & polygons );
 
 private:
+    /** Number of points whose visibility is computed in parallel, per thread, before it is
+     * added to the graph. */
+    static const std::size_t POINTS_PER_THREAD;
+
     shared_point_vector points;
-    point_sorter sorter;
+    /** Sorter of the points, created by the first graph generated. */
+    std::unique_ptr< point_sorter > sorter;
+    edge_selection selection;
+    visibility_algorithm algorithm;
+    unsigned int number_of_threads;
+    /** Threads reused by all the graphs generated, created when first needed. */
+    std::shared_ptr< ues::misc::thread_pool > pool;
 };
 
 }
@@ -23,7 +23,9 @@
 
 #include <pf/visibility_graph_2d/util/definitions.h>
 #include <pf/visibility_graph_2d/util/util.h>
+#include <pf/visibility_graph_2d/visibility_graph_cache.h>
 #include <pf/visibility_graph_2d/visibility_graph_generator.h>
+#include <pf/visibility_graph/augmented_visibility_graph.h>
 #include <pf/visibility_graph/graph_pathfinder.h>
 
 using namespace ues::pf::vg2d;
@@ -31,76 +33,182 @@ using namespace ues::pf::vg2d;
 const std::string component_name = "2D Pathfinder";
 
 
-ues::pf::path<2> visibility_graph_pathfinder::find_path ( const std::vector< ues::geom::polygon > & obstacles,
-                                                          const ues::geom::point<2> & origin,
-                                                          const ues::geom::point<2> & target )
+namespace
+{
+
+/** Builds the scenario formed by the \a obstacles, and fills \a included_points with the index
+ * of every vertex. */
+scenario build_scenario ( const std::vector< ues::geom::polygon > & obstacles, point_map & included_points )
+{
+    point_vector points;
+    segment_vector segments;
+    polygon_vector polygons;
+
+    // Fill points, segments and polygons.
+    for ( const ues::geom::polygon & poly : obstacles )
+    {
+        ues::pf::vg2d::polygon current_polygon;
+        ues::pf::vg2d::point_index first_point, prev_point;
+        bool is_first = true;
+
+        for ( const ues::geom::point<2> & p : poly )
+        {
+            // Position of the current point in the point vector.
+            ues::pf::vg2d::point_index current_point;
+
+            // Check whether the point is already in the point vector,
+            // and initialize the current_point variable accordingly.
+            current_point = ues::pf::vg2d::add_if_not_present ( points, included_points, p );
+
+            if ( is_first )
+            {
+                first_point = current_point;
+                is_first = false;
+            }
+            else
+            {
+                // Create a segment from previous to current points.
+                ues::pf::vg2d::segment_index current_segment = segments.size();
+                segments.push_back ( { prev_point, current_point } );
+                current_polygon.push_back ( current_segment );
+            }
+            prev_point = current_point;
+        }
+
+        ues::pf::vg2d::segment_index current_segment = segments.size();
+        segments.push_back ( { prev_point, first_point } );
+        current_polygon.push_back ( current_segment );
+        polygons.push_back ( current_polygon );
+    }
+
+    return scenario ( std::move ( points ), std::move ( segments ), std::move ( polygons ) );
+}
+
+
+/** Generates the reduced visibility graph of the \a obstacle_scenario, or takes it from the
+ * shared cache. Paths from or to any point only turn at the vertices of its bitangent edges, so
+ * the edges of the origin and target of every query are enough to complete it. */
+std::shared_ptr< const visibility_graph > generate_obstacle_graph ( const scenario & obstacle_scenario )
+{
+    if ( obstacle_scenario.get_points().empty() )
+        return std::make_shared< visibility_graph > ( obstacle_scenario.get_shared_points(), obstacle_scenario.get_shared_segments() );
+
+    visibility_graph_generator vgg ( obstacle_scenario.get_shared_points() );
+    vgg.set_edge_selection ( visibility_graph_generator::BITANGENT_EDGES );
+    return visibility_graph_cache::get_shared_cache().get_visibility_graph ( vgg, obstacle_scenario.get_shared_segments(), obstacle_scenario.get_shared_polygons() );
+}
+
+}
+
+
+visibility_graph_pathfinder::visibility_graph_pathfinder ( const std::vector< ues::geom::polygon > & obstacles )
+    : obstacle_scenario ( build_scenario ( obstacles, obstacle_points ) ),
+      obstacle_graph ( generate_obstacle_graph ( obstacle_scenario ) ),
+      sweep ( obstacle_scenario )
+{
+}
+
+
+std::shared_ptr< const visibility_graph > visibility_graph_pathfinder::get_obstacle_graph() const noexcept
+{
+    return obstacle_graph;
+}
+
+
+ues::pf::path<2> visibility_graph_pathfinder::find_path ( const ues::geom::point<2> & origin,
+                                                          const ues::geom::point<2> & target ) const
+{
+    ues::pf::search_statistics statistics;
+    return find_path ( origin, target, statistics );
+}
+
+
+ues::pf::path<2> visibility_graph_pathfinder::find_path ( const ues::geom::point<2> & origin,
+                                                          const ues::geom::point<2> & target,
+                                                          ues::pf::search_statistics & statistics ) const
 {
     ues::log::logger lg;
 
     if ( lg.min_level() <= ues::log::DEBUG_LVL )
     {
-        ues::log::event e ( ues::log::DEBUG_LVL, component_name, "Start generating 2D path" );
-        e.message() << "From " << origin << " to " << target << " with " << obstacles.size() << " obstacles:\n";
-        std::for_each ( obstacles.begin(), obstacles.end(), [&e] ( const ues::geom::polygon & poly ) { e.message() << poly << '\n'; } );
+        ues::log::event e ( ues::log::DEBUG_LVL, component_name, "Start searching 2D path" );
+        e.message() << "From " << origin << " to " << target << " among " << obstacle_scenario.get_points().size() << " obstacle vertices\n";
         lg.record ( std::move ( e ) );
     }
 
     try
     {
-
-        point_vector points;
-        segment_vector segments;
-        polygon_vector polygons;
-
-        ues::pf::vg2d::point_map included_points;
-
-        // Fill points, segments and polygons.
-        for ( const ues::geom::polygon & poly : obstacles )
+        // The origin and target are added to a view of the obstacle graph, unless they are
+        // vertices of the obstacles already. Either way, they are connected to every vertex
+        // they see, as their edges need not be bitangent.
+        std::shared_ptr< ues::pf::augmented_visibility_graph<2> > graph = std::make_shared< ues::pf::augmented_visibility_graph<2> > ( obstacle_graph );
+        const point_vector & points = obstacle_scenario.get_points();
+        auto index_of = [&] ( const ues::geom::point<2> & p )
         {
-            ues::pf::vg2d::polygon current_polygon;
-            ues::pf::vg2d::point_index first_point, prev_point;
-            bool is_first = true;
-
-            for ( const ues::geom::point<2> & p : poly )
+            point_map::const_iterator it = obstacle_points.find ( p );
+            return it != obstacle_points.end() ? it->second : graph->add_point ( p );
+        };
+        const point_index origin_index = index_of ( origin );
+        const point_index target_index = ( target == origin ) ? origin_index : index_of ( target );
+        const bool free_target = target_index >= points.size();
+
+        std::vector< bool > visible;
+        sweep.compute_visibility ( origin, free_target ? point_vector { target } : point_vector(), visible );
+        for ( point_index i = 0; i < visible.size(); ++i )
+        {
+            if ( visible[i] )
             {
-                // Position of the current point in the point vector.
-                ues::pf::vg2d::point_index current_point;
-
-                // Check whether the point is already in the point vector,
-                // and initialize the current_point variable accordingly.
-                current_point = ues::pf::vg2d::add_if_not_present ( points, included_points, p );
-
-                if ( is_first )
-                {
-                    first_point = current_point;
-                    is_first = false;
-                }
-                else
-                {
-                    // Create a segment from previous to current points.
-                    ues::pf::vg2d::segment_index current_segment = segments.size();
-                    segments.push_back ( { prev_point, current_point } );
-                    current_polygon.push_back ( current_segment );
-                }
-                prev_point = current_point;
+                const ues::geom::point<2> & p = i < points.size() ? points[i] : target;
+                graph->add_visibility ( origin_index, i < points.size() ? i : target_index, origin.distance_to ( p ) );
+            }
+        }
+        if ( target_index != origin_index )
+        {
+            sweep.compute_visibility ( target, point_vector(), visible );
+            for ( point_index i = 0; i < visible.size(); ++i )
+            {
+                if ( visible[i] && i != origin_index )
+                    graph->add_visibility ( target_index, i, target.distance_to ( points[i] ) );
             }
-
-            ues::pf::vg2d::segment_index current_segment = segments.size();
-            segments.push_back ( { prev_point, first_point } );
-            current_polygon.push_back ( current_segment );
-            polygons.push_back ( current_polygon );
         }
 
-        ues::pf::vg2d::add_if_not_present ( points, included_points, origin );
-        ues::pf::vg2d::add_if_not_present ( points, included_points, target );
-
-        visibility_graph_generator vgg ( std::make_shared<point_vector> ( std::move ( points ) ) );
-        ues::pf::graph_pathfinder<2> pf ( vgg.generate_visibility_graph ( std::make_shared<segment_vector> ( std::move ( segments ) ), std::make_shared<polygon_vector> ( std::move ( polygons ) ) ) );
-        return pf.find_path ( origin, target );
-
+        ues::pf::graph_pathfinder<2> pf ( graph );
+        ues::pf::search_workspace<2> workspace;
+        ues::pf::path<2> result = pf.find_path ( origin, target, workspace );
+        statistics = workspace.statistics;
+        return result;
     }
     catch ( ues::exc::exception & e )
     {
         throw ues::exc::exception ( std::move ( e ), "Error computing 2D path", UES_CONTEXT );
     }
 }
+
+
+ues::pf::path<2> visibility_graph_pathfinder::find_path ( const std::vector< ues::geom::polygon > & obstacles,
+                                                          const ues::geom::point<2> & origin,
+                                                          const ues::geom::point<2> & target )
+{
+    ues::pf::search_statistics statistics;
+    return find_path ( obstacles, origin, target, statistics );
+}
+
+
+ues::pf::path<2> visibility_graph_pathfinder::find_path ( const std::vector< ues::geom::polygon > & obstacles,
+                                                          const ues::geom::point<2> & origin,
+                                                          const ues::geom::point<2> & target,
+                                                          ues::pf::search_statistics & statistics )
+{
+    ues::log::logger lg;
+
+    if ( lg.min_level() <= ues::log::DEBUG_LVL )
+    {
+        ues::log::event e ( ues::log::DEBUG_LVL, component_name, "Start generating 2D path" );
+        e.message() << "From " << origin << " to " << target << " with " << obstacles.size() << " obstacles:\n";
+        std::for_each ( obstacles.begin(), obstacles.end(), [&e] ( const ues::geom::polygon & poly ) { e.message() << poly << '\n'; } );
+        lg.record ( std::move ( e ) );
+    }
+
+    // The member overload already adds the context of the 2D search to its errors.
+    return visibility_graph_pathfinder ( obstacles ).find_path ( origin, target, statistics );
+}
@@ -18,8 +18,15 @@
 #ifndef UES_PF_VG2D_VISIBILITY_GRAPH_PATHFINDER_H
 #define UES_PF_VG2D_VISIBILITY_GRAPH_PATHFINDER_H
 
+#include <memory>
+
 #include <geom/polygon.h>
 #include <pf/path.h>
+#include <pf/search_statistics.h>
+#include <pf/visibility_graph_2d/rotational_sweep/rotational_sweep.h>
+#include <pf/visibility_graph_2d/util/scenario.h>
+#include <pf/visibility_graph_2d/util/util.h>
+#include <pf/visibility_graph_2d/visibility_graph.h>
 
 namespace ues
 {
@@ -28,12 +35,53 @@ namespace pf
 namespace vg2d
 {
 
+/** The visibility_graph_pathfinder class finds paths among polygonal obstacles. The reduced
+ * visibility graph of the obstacles is built once, and every query only computes the
+ * visibility from its origin and target, with a rotational sweep, before searching.
+ *
+ * The obstacle graph only keeps the bitangent edges between obstacle vertices
+ * (visibility_graph_generator::BITANGENT_EDGES), not every visible pair as before, so
+ * get_obstacle_graph() returns a subgraph of the complete visibility graph. The shortest
+ * paths found are the same. */
 class visibility_graph_pathfinder
 {
 public:
+    /** Builds the visibility graph of the \a obstacles, so paths among them can be found for
+     * many pairs of points. */
+    visibility_graph_pathfinder ( const std::vector< ues::geom::polygon > & obstacles );
+
+    /** Returns the visibility graph of the obstacles, without any origin or target. */
+    std::shared_ptr< const visibility_graph > get_obstacle_graph() const noexcept;
+
+    /** Finds the shortest path from \a origin to \a target among the obstacles. */
+    ues::pf::path<2> find_path ( const ues::geom::point<2> & origin,
+                                 const ues::geom::point<2> & target ) const;
+
+    /** Finds a path like the other overload, describing the work done by the search in
+     * \a statistics. */
+    ues::pf::path<2> find_path ( const ues::geom::point<2> & origin,
+                                 const ues::geom::point<2> & target,
+                                 ues::pf::search_statistics & statistics ) const;
+
+    /** Finds the shortest path from \a origin to \a target among the \a obstacles, building
+     * their visibility graph for this query only. */
     static ues::pf::path<2> find_path ( const std::vector< ues::geom::polygon > & obstacles,
                                         const ues::geom::point<2> & origin,
                                         const ues::geom::point<2> & target );
+
+    /** Finds a path like the other overload, describing the work done by the search in
+     * \a statistics. */
+    static ues::pf::path<2> find_path ( const std::vector< ues::geom::polygon > & obstacles,
+                                        const ues::geom::point<2> & origin,
+                                        const ues::geom::point<2> & target,
+                                        ues::pf::search_statistics & statistics );
+
+private:
+    /** Index of every vertex of the obstacles. */
+    point_map obstacle_points;
+    scenario obstacle_scenario;
+    std::shared_ptr< const visibility_graph > obstacle_graph;
+    rotational_sweep sweep;
 };
 
 }
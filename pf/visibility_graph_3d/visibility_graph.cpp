@@ -72,7 +72,13 @@ void visibility_graph::add_point ( ues::geom::point<3> point )
 
 visibility_graph::size_type visibility_graph::point_to_index ( const ues::geom::point<3> & point ) const
 {
-    point_indices::const_iterator pti_it = pti.find ( dynamic_cast< const ues::geom::point<3> & > ( point ) );
+    return index_of ( point );
+}
+
+
+visibility_graph::size_type visibility_graph::index_of ( const ues::geom::point<3> & point ) const
+{
+    point_indices::const_iterator pti_it = pti.find ( point );
     if ( pti_it != pti.end() )
     {
         return pti_it->second;
@@ -88,6 +94,6 @@ visibility_graph::size_type visibility_graph::point_to_index ( const ues::geom::
 
 const ues::geom::point<3> & ues::pf::vg3d::visibility_graph::index_to_point ( size_type point_index ) const
 {
-    return pv[point_index];
+    return point_at ( point_index );
 }
 
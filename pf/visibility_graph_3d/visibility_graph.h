@@ -44,19 +44,36 @@ public:
     /** Adds a new point to the graph. The point provided must not be in the graph. */
     void add_point ( ues::geom::point<3> point );
 
-private:
-    typedef std::unordered_map< ues::geom::point<3>, point_index > point_indices;
-
-    point_indices pti;
-    point_vector pv;
+    /** \name Non-virtual access, for searches that know the type of the graph */
+    /** \{ */
+    /** Returns the index assigned to a point. */
+    size_type index_of ( const ues::geom::point<3> & point ) const;
+    /** Returns the point assigned to an index. */
+    inline const ues::geom::point<3> & point_at ( size_type point_index ) const noexcept;
+    /** \} */
 
     /** Returns the index assigned to a point. */
     size_type point_to_index ( const ues::geom::point<3> & new_point ) const override;
 
     /** Returns the point assigned to an index. */
     const ues::geom::point<3> & index_to_point ( size_type point_index ) const override;
+
+private:
+    typedef std::unordered_map< ues::geom::point<3>, point_index > point_indices;
+
+    point_indices pti;
+    point_vector pv;
 };
 
+
+// Inlined methods.
+
+
+const ues::geom::point<3> & visibility_graph::point_at ( size_type point_index ) const noexcept
+{
+    return pv[point_index];
+}
+
 }
 }
 }
@@ -17,9 +17,13 @@
 
 #include "visibility_graph_generator.h"
 
+#include <algorithm>
+#include <functional>
+
 #include <log/logger.h>
 #include <geom/algorithms_2d.h>
 #include <geom/algorithms_3d.h>
+#include <geom/box_2d.h>
 
 #include <pf/visibility_graph_2d/visibility_graph_generator.h>
 #include <pf/visibility_graph_2d/envelope_generation/envelope.h>
@@ -32,7 +36,7 @@ using namespace ues::pf::vg3d;
 /** Vector containing the height of each level. */
 typedef std::vector< ues::math::numeric_type > obstacle_categories;
 /** Vector containing the 2D visibility graph of each  level. */
-typedef std::vector< std::shared_ptr< ues::pf::vg2d::visibility_graph > > visibilities;
+typedef std::vector< std::shared_ptr< const ues::pf::vg2d::visibility_graph > > visibilities;
 /** Auxiliary type for some internal functions. */
 typedef std::unordered_map< ues::geom::point<2>, ues::pf::vg2d::point_index > point_map;
 
@@ -100,16 +104,30 @@ generate_visibility_graph ( const visibilities & level_data,
                             const ues::pf::vg2d::segment_vector & segments,
                             const obstacle_categories & categories,
                             const ues::geom::point<3> & origin,
-                            const ues::geom::point<3> & target )
+                            const ues::geom::point<3> & target,
+                            const ues::pf::ellipse_bound<3> & bound )
 {
     // The output visibility graph.
     std::shared_ptr< visibility_graph > result ( new visibility_graph() );
 
+    // Points whose projection is out of the bound are out of it at every level.
+    std::vector< bool > in_bound ( points.size(), true );
+    if ( bound.is_bounded() )
+    {
+        for ( point_index pi = 0; pi < points.size(); ++pi )
+        {
+            in_bound[pi] = bound.may_intersect ( ues::geom::box_2d ( points[pi] ) );
+        }
+    }
+
     // Generate the initial set of points for the graph.
     for ( obstacle_categories::size_type i = 0; i < categories.size(); ++i )
     {
         for ( point_index pi = 0; pi < points.size(); ++pi )
         {
+            if ( !in_bound[pi] )
+                continue;
+
             result->add_point ( ues::geom::point<3> ( points[pi].get_x(), points[pi].get_y(), categories[i] ) );
 
             // Connect each point to the point immediately over it, as these points
@@ -135,10 +153,16 @@ generate_visibility_graph ( const visibilities & level_data,
     // Generate the connections between these points.
     for ( point_index pi1 = 1; pi1 < points.size(); ++pi1 )
     {
+        if ( !in_bound[pi1] )
+            continue;
+
         const ues::geom::point<2> & point_2d_1 = points[pi1];
 
         for ( point_index pi2 = 0; pi2 < pi1; ++pi2 )
         {
+            if ( !in_bound[pi2] )
+                continue;
+
             const ues::geom::point<2> & point_2d_2 = points[pi2];
 
             ues::geom::point<3> intersection_point1, intersection_point2;
@@ -239,6 +263,8 @@ visibilities compute_level_visibilities ( ues::pf::vg2d::scenario & current_scen
 
         }
 
+        // The graphs of the levels are not cached: their points include the origin and target of
+        // the query, so no other query would find them.
         result.push_back ( graph_generator.generate_visibility_graph ( used_segments, used_polygons ) );
 
         categories_it++;
@@ -375,6 +401,16 @@ std::shared_ptr< visibility_graph >
 visibility_graph_generator::generate_visibility_graph ( const ues::env::obstacle_vector & obstacles,
                                                         const ues::geom::point<3> & origin,
                                                         const ues::geom::point<3> & target )
+{
+    return generate_visibility_graph ( obstacles, origin, target, ues::pf::ellipse_bound<3> ( origin, target ) );
+}
+
+
+std::shared_ptr< visibility_graph >
+visibility_graph_generator::generate_visibility_graph ( const ues::env::obstacle_vector & obstacles,
+                                                        const ues::geom::point<3> & origin,
+                                                        const ues::geom::point<3> & target,
+                                                        const ues::pf::ellipse_bound<3> & bound )
 {
     ues::pf::vg2d::scenario current_scenario;
     obstacle_categories heights;
@@ -382,9 +418,47 @@ visibility_graph_generator::generate_visibility_graph ( const ues::env::obstacle
     // Create a logger for the algorithm.
     ues::log::logger lg;
 
-    extract_obstacle_data ( obstacles, origin, target, current_scenario, heights, lg );
+    if ( !bound.is_bounded() )
+    {
+        extract_obstacle_data ( obstacles, origin, target, current_scenario, heights, lg );
+    }
+    else
+    {
+        // Keep the obstacles that may be reached by a path within the bound.
+        ues::env::obstacle_vector bounded_obstacles;
+        for ( const ues::env::obstacle & obs : obstacles )
+        {
+            ues::geom::box_2d box ( obs.get_shape().get_point_at ( 0 ) );
+            for ( const ues::geom::point<2> & p : obs.get_shape() )
+            {
+                box.include_point ( p );
+            }
+            if ( bound.may_intersect ( box ) )
+            {
+                bounded_obstacles.push_back ( obs );
+            }
+        }
 
-    obstacle_categories categories = compute_categories ( heights, origin, target );
+        if ( lg.min_level() <= ues::log::DEBUG_LVL )
+        {
+            ues::log::event e ( ues::log::DEBUG_LVL, component_name, "Obstacles discarded by the bound of the path length" );
+            e.message() << obstacles.size() - bounded_obstacles.size() << " of " << obstacles.size()
+                        << " obstacles cannot be reached by a path of length " << bound.get_length() << '\n';
+            lg.record ( std::move ( e ) );
+        }
+
+        extract_obstacle_data ( bounded_obstacles, origin, target, current_scenario, heights, lg );
+    }
+
+    // The levels are chosen as if all the obstacles were used, so that the resulting graph
+    // approximates the paths in the same way.
+    obstacle_categories all_heights;
+    for ( const ues::env::obstacle & obs : obstacles )
+    {
+        all_heights.push_back ( obs.get_height() );
+    }
+    std::sort ( all_heights.begin(), all_heights.end(), std::greater< ues::math::numeric_type >() );
+    obstacle_categories categories = compute_categories ( all_heights, origin, target );
 
     // First, the two-dimensional pathfinding algorithm is executed for several level. The upper level is as
     // high as the highest building. Thus, all points are visible to each other at that level. In
@@ -394,5 +468,5 @@ visibility_graph_generator::generate_visibility_graph ( const ues::env::obstacle
     visibilities level_data = compute_level_visibilities ( current_scenario, heights, categories, lg );
 
     // Build 3D visibility graph from 2D level data.
-    return ::generate_visibility_graph ( level_data, current_scenario.get_points(), current_scenario.get_segments(), categories, origin, target );
+    return ::generate_visibility_graph ( level_data, current_scenario.get_points(), current_scenario.get_segments(), categories, origin, target, bound );
 }
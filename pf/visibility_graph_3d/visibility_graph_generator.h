@@ -21,6 +21,7 @@
 #include <env/obstacle_vector.h>
 #include <geom/point.h>
 
+#include <pf/ellipse_bound.h>
 #include <pf/visibility_graph_3d/visibility_graph.h>
 
 namespace ues
@@ -39,6 +40,16 @@ public:
                                                                            const ues::geom::point<3> & origin,
                                                                            const ues::geom::point<3> & target );
 
+    /** Generates the visibility graph like the other overload, but only for the paths within the
+     * \a bound, which must have been built for the same origin and target. The obstacles that
+     * cannot reach the bound are ignored, and the points out of it are not added to the graph,
+     * so the work depends on the region around the query instead of the whole environment. The
+     * levels of the graph are still chosen from the heights of all the obstacles. */
+    static std::shared_ptr< visibility_graph > generate_visibility_graph ( const ues::env::obstacle_vector & obstacles,
+                                                                           const ues::geom::point<3> & origin,
+                                                                           const ues::geom::point<3> & target,
+                                                                           const ues::pf::ellipse_bound<3> & bound );
+
 };
 
 }
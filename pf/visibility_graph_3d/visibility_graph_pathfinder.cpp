@@ -30,6 +30,16 @@ const std::string component_name = "3D Pathfinder";
 ues::pf::path<3> visibility_graph_pathfinder::find_path ( const ues::env::obstacle_vector & obstacles,
                                                           const ues::geom::point<3> & origin,
                                                           const ues::geom::point<3> & target ) const
+{
+    ues::pf::search_statistics statistics;
+    return find_path ( obstacles, origin, target, statistics );
+}
+
+
+ues::pf::path<3> visibility_graph_pathfinder::find_path ( const ues::env::obstacle_vector & obstacles,
+                                                          const ues::geom::point<3> & origin,
+                                                          const ues::geom::point<3> & target,
+                                                          ues::pf::search_statistics & statistics ) const
 {
     ues::log::logger lg;
 
@@ -45,8 +55,14 @@ ues::pf::path<3> visibility_graph_pathfinder::find_path ( const ues::env::obstac
     try
     {
 
-        ues::pf::graph_pathfinder<3> finder ( vgg.generate_visibility_graph ( obstacles, origin, target ) );
-        path<3> result = finder.find_path ( origin, target );
+        // Flying over every obstacle is always possible, so no point out of the ellipse that
+        // such path defines can be on the shortest path.
+        ues::pf::ellipse_bound<3> bound ( origin, target, ues::pf::fly_over_length ( obstacles, origin, target ) );
+
+        ues::pf::graph_pathfinder<3> finder ( vgg.generate_visibility_graph ( obstacles, origin, target, bound ) );
+        ues::pf::search_workspace<3> workspace;
+        path<3> result = finder.find_path ( origin, target, workspace, bound );
+        statistics = workspace.statistics;
 
         if ( lg.min_level() <= ues::log::DEBUG_LVL )
         {
@@ -35,6 +35,11 @@ public:
                                    const ues::geom::point<3> & origin,
                                    const ues::geom::point<3> & target ) const override;
 
+    ues::pf::path< 3 > find_path ( const ues::env::obstacle_vector & obstacles,
+                                   const ues::geom::point<3> & origin,
+                                   const ues::geom::point<3> & target,
+                                   ues::pf::search_statistics & statistics ) const override;
+
     /** \name Clone methods */
     /** \{ */
     visibility_graph_pathfinder * clone() const & override;
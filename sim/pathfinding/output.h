@@ -22,6 +22,7 @@
 
 #include <env/environment.h>
 #include <pf/path.h>
+#include <pf/search_statistics.h>
 
 namespace ues
 {
@@ -34,6 +35,9 @@ struct output_element
 {
     ues::pf::path<3> path;
     boost::posix_time::time_duration running_time;
+    /** Time spent post-processing the path, not included in the running time. */
+    boost::posix_time::time_duration postprocessing_time;
+    ues::pf::search_statistics statistics;
 };
 
 struct output {
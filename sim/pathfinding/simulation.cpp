@@ -69,8 +69,14 @@ output simulation::run_simulation ( input in )
     {
         output_element oe;
         boost::posix_time::ptime time_start = boost::posix_time::microsec_clock::universal_time();
-        oe.path = pf.find_path ( in.environment.get_obstacles(), in.origin, in.target );
+        oe.path = pf.find_path ( in.environment.get_obstacles(), in.origin, in.target, oe.statistics );
         oe.running_time = boost::posix_time::microsec_clock::universal_time() - time_start;
+        if ( pf.get_path_shortcutter() )
+        {
+            time_start = boost::posix_time::microsec_clock::universal_time();
+            oe.path = pf.postprocess_path ( in.environment.get_obstacles(), std::move ( oe.path ) );
+            oe.postprocessing_time = boost::posix_time::microsec_clock::universal_time() - time_start;
+        }
         out.algorithm_results.push_back ( oe );
     }
     out.environment = std::move ( in.environment );
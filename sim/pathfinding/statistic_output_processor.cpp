@@ -27,6 +27,19 @@ const std::string component_name = "Statistical pathfinding output processor";
 
 const float statistic_output_processor::PERCENTILE = 0.95f;
 
+namespace
+{
+
+#ifdef UES_PF_SEARCH_STATISTICS
+/** Converts a duration of the search statistics to the type of the running times. */
+boost::posix_time::time_duration to_time_duration ( ues::pf::search_statistics::duration d )
+{
+    return boost::posix_time::microseconds ( std::chrono::duration_cast<std::chrono::microseconds> ( d ).count() );
+}
+#endif
+
+}
+
 
 statistic_output_processor::statistic_output_processor ( std::vector< OUTPUT_GENERATOR > generators )
     : generators ( std::move ( generators ) ),
@@ -65,6 +78,8 @@ void statistic_output_processor::process_output ( const output & out )
     {
         generator_results[i].path_lengths.push_back ( out.algorithm_results[i].path.length() );
         generator_results[i].running_times.push_back ( out.algorithm_results[i].running_time );
+        generator_results[i].postprocessing_times.push_back ( out.algorithm_results[i].postprocessing_time );
+        generator_results[i].statistics.push_back ( out.algorithm_results[i].statistics );
     }
 
     if ( reference_generator < generators.size() )
@@ -144,13 +159,32 @@ void statistic_output_processor::postprocess()
             {
                 averages[i].average_path_length += generator_results[i].path_lengths[j];
                 averages[i].average_running_time += generator_results[i].running_times[j];
+                averages[i].average_postprocessing_time += generator_results[i].postprocessing_times[j];
                 if ( relative_path_statistics )
                 {
                     averages[i].average_relative_path_length += generator_results[i].relative_path_lengths[j];
                 }
             }
             averages[i].average_path_length /= averages[i].sample_size;
+
+#ifdef UES_PF_SEARCH_STATISTICS
+            ues::math::numeric_type peak_frontier_sizes = 0;
+            ues::pf::search_statistics total_statistics;
+            for ( const ues::pf::search_statistics & statistics : generator_results[i].statistics )
+            {
+                total_statistics += statistics;
+                peak_frontier_sizes += statistics.peak_frontier_size;
+            }
+            averages[i].average_expanded_points = static_cast<ues::math::numeric_type> ( total_statistics.expanded_points ) / averages[i].sample_size;
+            averages[i].average_relaxed_edges = static_cast<ues::math::numeric_type> ( total_statistics.relaxed_edges ) / averages[i].sample_size;
+            averages[i].average_decreased_keys = static_cast<ues::math::numeric_type> ( total_statistics.decreased_keys ) / averages[i].sample_size;
+            averages[i].average_peak_frontier_size = peak_frontier_sizes / averages[i].sample_size;
+            averages[i].average_heuristic_time = to_time_duration ( total_statistics.heuristic_time / averages[i].sample_size );
+            averages[i].average_adjacents_time = to_time_duration ( total_statistics.adjacents_time / averages[i].sample_size );
+            averages[i].average_edge_time = to_time_duration ( total_statistics.edge_time / averages[i].sample_size );
+#endif
             averages[i].average_running_time /= averages[i].sample_size;
+            averages[i].average_postprocessing_time /= averages[i].sample_size;
             averages[i].average_relative_path_length /= averages[i].sample_size;
 
             std::sort ( generator_results[i].path_lengths.begin(), generator_results[i].path_lengths.end() );
@@ -188,6 +222,16 @@ void statistic_output_processor::postprocess()
             }
             e.message() << "\tMean running time: " << averages[i].average_running_time << '\n';
             e.message() << "\tRunning time (" << PERCENTILE << " centile): " << averages[i].centile_running_time << '\n';
+            e.message() << "\tMean post-processing time: " << averages[i].average_postprocessing_time << '\n';
+#ifdef UES_PF_SEARCH_STATISTICS
+            e.message() << "\tMean expanded points: " << averages[i].average_expanded_points << '\n';
+            e.message() << "\tMean relaxed edges: " << averages[i].average_relaxed_edges << '\n';
+            e.message() << "\tMean decreased keys: " << averages[i].average_decreased_keys << '\n';
+            e.message() << "\tMean peak open list size: " << averages[i].average_peak_frontier_size << '\n';
+            e.message() << "\tMean heuristic time: " << averages[i].average_heuristic_time << '\n';
+            e.message() << "\tMean neighbour enumeration time: " << averages[i].average_adjacents_time << '\n';
+            e.message() << "\tMean edge validation time: " << averages[i].average_edge_time << '\n';
+#endif
         }
         lg.record ( std::move ( e ) );
     }
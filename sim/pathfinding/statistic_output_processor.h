@@ -42,6 +42,19 @@ public:
         ues::math::numeric_type centile_relative_path_length;
         boost::posix_time::time_duration average_running_time;
         boost::posix_time::time_duration centile_running_time;
+        boost::posix_time::time_duration average_postprocessing_time;
+#ifdef UES_PF_SEARCH_STATISTICS
+        /** \name Mean search statistics, only collected with UES_PF_SEARCH_STATISTICS */
+        /** \{ */
+        ues::math::numeric_type average_expanded_points;
+        ues::math::numeric_type average_relaxed_edges;
+        ues::math::numeric_type average_decreased_keys;
+        ues::math::numeric_type average_peak_frontier_size;
+        boost::posix_time::time_duration average_heuristic_time;
+        boost::posix_time::time_duration average_adjacents_time;
+        boost::posix_time::time_duration average_edge_time;
+        /** \} */
+#endif
     };
 
     static const float PERCENTILE;
@@ -80,6 +93,8 @@ private:
         std::vector< ues::math::numeric_type > path_lengths;
         std::vector< ues::math::numeric_type > relative_path_lengths;
         std::vector< boost::posix_time::time_duration > running_times;
+        std::vector< boost::posix_time::time_duration > postprocessing_times;
+        std::vector< ues::pf::search_statistics > statistics;
     };
 
     std::vector<OUTPUT_GENERATOR> generators;
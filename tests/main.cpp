@@ -19,6 +19,7 @@
 
 #include "env/tests.h"
 #include "geom/tests.h"
+#include "misc/tests.h"
 #include "pf/tests.h"
 #include "sim/tests.h"
 
@@ -0,0 +1,54 @@
+/*
+ * Copyright 2015-2017 Guillermo Frontera <guillermo.frontera@upm.es>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include "gtest/gtest.h"
+
+#include <cstdint>
+
+#include <misc/bits.h>
+
+
+TEST ( misc, count_trailing_zeros )
+{
+    EXPECT_EQ ( 0u, ues::misc::count_trailing_zeros ( 1 ) );
+    EXPECT_EQ ( 0u, ues::misc::count_trailing_zeros ( 7 ) );
+    EXPECT_EQ ( 3u, ues::misc::count_trailing_zeros ( 8 ) );
+    EXPECT_EQ ( 1u, ues::misc::count_trailing_zeros ( 0x8000000000000002ull ) );
+    EXPECT_EQ ( 63u, ues::misc::count_trailing_zeros ( std::uint64_t ( 1 ) << 63 ) );
+    EXPECT_EQ ( 0u, ues::misc::count_trailing_zeros ( ~std::uint64_t ( 0 ) ) );
+
+    for ( unsigned int i = 0; i < 64; ++i )
+    {
+        EXPECT_EQ ( i, ues::misc::count_trailing_zeros ( ~std::uint64_t ( 0 ) << i ) );
+    }
+}
+
+
+TEST ( misc, count_leading_zeros )
+{
+    EXPECT_EQ ( 63u, ues::misc::count_leading_zeros ( 1 ) );
+    EXPECT_EQ ( 61u, ues::misc::count_leading_zeros ( 7 ) );
+    EXPECT_EQ ( 60u, ues::misc::count_leading_zeros ( 8 ) );
+    EXPECT_EQ ( 0u, ues::misc::count_leading_zeros ( 0x8000000000000002ull ) );
+    EXPECT_EQ ( 32u, ues::misc::count_leading_zeros ( 0xffffffffull ) );
+    EXPECT_EQ ( 0u, ues::misc::count_leading_zeros ( ~std::uint64_t ( 0 ) ) );
+
+    for ( unsigned int i = 0; i < 64; ++i )
+    {
+        EXPECT_EQ ( i, ues::misc::count_leading_zeros ( ~std::uint64_t ( 0 ) >> i ) );
+    }
+}
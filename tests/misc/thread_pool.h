@@ -0,0 +1,68 @@
+/*
+ * Copyright 2015-2017 Guillermo Frontera <guillermo.frontera@upm.es>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include "gtest/gtest.h"
+
+#include <atomic>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <misc/thread_pool.h>
+
+
+TEST ( misc, thread_pool )
+{
+    ues::misc::thread_pool pool ( 4 );
+    EXPECT_EQ ( 4u, pool.size() );
+
+    // Every task runs once, on a worker of the pool.
+    std::vector< std::atomic< unsigned int > > runs ( 100 );
+    pool.run ( runs.size(), [&] ( std::size_t task, unsigned int worker )
+    {
+        EXPECT_LT ( worker, pool.size() );
+        ++runs[task];
+    } );
+    for ( const std::atomic< unsigned int > & r : runs )
+    {
+        EXPECT_EQ ( 1u, r.load() );
+    }
+
+    // When several tasks throw, the batch still completes and the error of the lowest task
+    // is rethrown, whichever worker failed first.
+    for ( unsigned int repetition = 0; repetition < 20; ++repetition )
+    {
+        std::atomic< std::size_t > completed ( 0 );
+        try
+        {
+            pool.run ( 64, [&] ( std::size_t task, unsigned int )
+            {
+                ++completed;
+                if ( task % 16 == 5 )
+                {
+                    throw std::runtime_error ( std::to_string ( task ) );
+                }
+            } );
+            ADD_FAILURE() << "The batch did not throw";
+        }
+        catch ( const std::runtime_error & e )
+        {
+            EXPECT_EQ ( std::string ( "5" ), e.what() );
+        }
+        EXPECT_EQ ( 64u, completed.load() );
+    }
+}
@@ -0,0 +1,79 @@
+/*
+ * Copyright 2015-2017 Guillermo Frontera <guillermo.frontera@upm.es>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include "gtest/gtest.h"
+
+#include <memory>
+
+#include <pf/path_shortcutter.h>
+#include <pf/visibility_graph_3d/visibility_graph_pathfinder.h>
+
+#include <tests/pf/compare_paths.h>
+
+
+TEST ( pf, path_shortcutter )
+{
+    ues::env::obstacle_vector obstacles;
+    obstacles.push_back ( ues::env::obstacle ( { { 0, 0 }, { 0, 1 }, { 1, 1 }, { 1, 0 } }, 1 ) );
+
+    // A detour around the obstacle, whose direct shortcut goes through it.
+    ues::pf::path<3> input_path;
+    input_path.push_back ( ues::geom::point<3> ( -1, .5, 0 ) );
+    input_path.push_back ( ues::geom::point<3> ( -1, 2.5, 0 ) );
+    input_path.push_back ( ues::geom::point<3> ( 2, 3, 0 ) );
+    input_path.push_back ( ues::geom::point<3> ( 2, .5, 0 ) );
+
+    // The greedy strategy jumps to the furthest visible vertex.
+    ues::pf::path_shortcutter shortcutter;
+    ues::pf::path<3> expected_result;
+    expected_result.push_back ( input_path[0] );
+    expected_result.push_back ( input_path[2] );
+    expected_result.push_back ( input_path[3] );
+    compare_paths ( expected_result, shortcutter.shortcut ( obstacles, input_path ) );
+
+    // The dynamic strategy finds the shortest path along the visible vertices.
+    shortcutter.set_strategy ( ues::pf::path_shortcutter::DYNAMIC );
+    expected_result[1] = input_path[1];
+    compare_paths ( expected_result, shortcutter.shortcut ( obstacles, input_path ) );
+
+    // Above the obstacle, every vertex but the endpoints is removed.
+    for ( ues::geom::point<3> & p : input_path )
+    {
+        p.set_z ( 2 );
+    }
+    expected_result = { input_path.front(), input_path.back() };
+    compare_paths ( expected_result, shortcutter.shortcut ( obstacles, input_path ) );
+    shortcutter.set_strategy ( ues::pf::path_shortcutter::GREEDY );
+    compare_paths ( expected_result, shortcutter.shortcut ( obstacles, input_path ) );
+}
+
+TEST ( pf, path_shortcutter_pathfinder )
+{
+    ues::env::obstacle_vector obstacles;
+    obstacles.push_back ( ues::env::obstacle ( { { 0, 0 }, { 0, 1 }, { 1, 1 }, { 1, 0 } }, 1 ) );
+    ues::geom::point<3> origin = { -1, .3, 0 };
+    ues::geom::point<3> target = { 2, .3, 0 };
+
+    ues::pf::vg3d::visibility_graph_pathfinder finder;
+    finder.set_path_shortcutter ( std::make_shared< ues::pf::path_shortcutter > ( ues::pf::path_shortcutter::DYNAMIC ) );
+    std::unique_ptr< ues::pf::pathfinder > copy ( finder.clone() );
+    ASSERT_EQ ( finder.get_path_shortcutter(), copy->get_path_shortcutter() );
+
+    // A shortest path cannot be shortened.
+    ues::pf::path<3> result = copy->find_path ( obstacles, origin, target );
+    compare_paths ( result, copy->postprocess_path ( obstacles, result ) );
+}
@@ -17,6 +17,8 @@
 
 #include "gtest/gtest.h"
 
+#include <random>
+
 #include <pf/visibility_graph_2d/point_sort/planar_graph_generator.h>
 
 
@@ -34,3 +36,43 @@ TEST ( pf, planar_graph_generator )
     // TODO Check the correctness of the result.
 
 }
+
+
+TEST ( pf, planar_graph_generator_crossings )
+{
+    // Random points, and a grid, whose collinear points make lines cross at the same vertex.
+    std::mt19937 generator ( 3 );
+    std::uniform_real_distribution< ues::math::numeric_type > coordinate ( 0, 100 );
+    std::vector< ues::geom::point<2> > random_points, grid_points;
+    for ( unsigned int i = 0; i < 200; ++i )
+    {
+        random_points.push_back ( ues::geom::point<2> ( coordinate ( generator ), coordinate ( generator ) ) );
+    }
+    for ( unsigned int i = 0; i < 10; ++i )
+    {
+        for ( unsigned int j = 0; j < 10; ++j )
+        {
+            grid_points.push_back ( ues::geom::point<2> ( i, j ) );
+        }
+    }
+
+    ues::misc::thread_pool pool ( 2 );
+    for ( const std::vector< ues::geom::point<2> > & points : { random_points, grid_points } )
+    {
+        ues::pf::vg2d::planar_graph g = ues::pf::vg2d::planar_graph_generator::generate_planar_graph ( points );
+        ues::pf::vg2d::planar_graph sequential = ues::pf::vg2d::planar_graph_generator::generate_planar_graph ( points, nullptr );
+        ues::pf::vg2d::planar_graph parallel = ues::pf::vg2d::planar_graph_generator::generate_planar_graph ( points, &pool );
+        ues::pf::vg2d::planar_graph linear_memory = ues::pf::vg2d::planar_graph_generator::generate_planar_graph ( points, nullptr, false );
+
+        ASSERT_FALSE ( g.has_only_crossings() );
+        ASSERT_TRUE ( parallel.has_only_crossings() );
+        ASSERT_TRUE ( parallel.stores_crossings() );
+        ASSERT_FALSE ( linear_memory.stores_crossings() );
+        for ( ues::pf::vg2d::planar_graph::line l = 0; l < points.size(); ++l )
+        {
+            ASSERT_EQ ( g.get_sorted_lines ( l ), sequential.get_sorted_lines ( l ) );
+            ASSERT_EQ ( g.get_sorted_lines ( l ), parallel.get_sorted_lines ( l ) );
+            ASSERT_EQ ( g.get_sorted_lines ( l ), linear_memory.get_sorted_lines ( l ) );
+        }
+    }
+}
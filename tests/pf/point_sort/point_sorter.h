@@ -17,6 +17,9 @@
 
 #include "gtest/gtest.h"
 
+#include <chrono>
+#include <random>
+
 #include <pf/visibility_graph_2d/point_sort/point_sorter.h>
 
 
@@ -36,3 +39,79 @@ TEST ( pf, point_sorter )
 
     ASSERT_EQ ( expected_result, result );
 }
+
+
+namespace
+{
+
+/** Returns \a number_of_points random points in a square of side 1000. */
+std::shared_ptr< ues::pf::vg2d::point_vector > random_points ( unsigned int number_of_points )
+{
+    std::mt19937 generator ( 1 );
+    std::uniform_real_distribution< ues::math::numeric_type > coordinate ( 0, 1000 );
+    std::shared_ptr< ues::pf::vg2d::point_vector > points = std::make_shared< ues::pf::vg2d::point_vector >();
+    for ( unsigned int i = 0; i < number_of_points; ++i )
+    {
+        points->push_back ( ues::geom::point<2> ( coordinate ( generator ), coordinate ( generator ) ) );
+    }
+    return points;
+}
+
+}
+
+
+TEST ( pf, point_sorter_buffers )
+{
+    const unsigned int number_of_points = 300;
+    std::shared_ptr< ues::pf::vg2d::point_vector > points = random_points ( number_of_points );
+    ues::pf::vg2d::point_sorter ps ( points );
+    ues::pf::vg2d::point_index_vector result;
+    ues::pf::vg2d::planar_graph::crossing_buffer buffer;
+
+    // All methods return the same sorting, also without storing the crossings of the lines, which
+    // contains every other point once, with growing angles.
+    const ues::pf::vg2d::point_index origin = number_of_points / 2;
+    ps.get_sorted_list_of_points ( origin, result, buffer );
+    ASSERT_EQ ( ps.get_sorted_list_of_points ( origin ), result );
+    ues::pf::vg2d::point_sorter linear_memory_ps ( points, nullptr, 0 );
+    ASSERT_EQ ( linear_memory_ps.get_sorted_list_of_points ( origin ), result );
+    ASSERT_EQ ( number_of_points - 1, result.size() );
+
+    const ues::geom::point<2> & origin_point = ( *points ) [origin];
+    auto angle = [&origin_point] ( const ues::geom::point<2> & p )
+    {
+        ues::math::numeric_type result = origin_point.angle_to ( p ) - ues::math::pi / 2;
+        return result < 0 ? result + 2 * ues::math::pi : result;
+    };
+    std::vector< bool > found ( number_of_points, false );
+    for ( ues::pf::vg2d::point_index_vector::size_type i = 0; i < result.size(); ++i )
+    {
+        ASSERT_NE ( origin, result[i] );
+        ASSERT_FALSE ( found[result[i]] );
+        found[result[i]] = true;
+        if ( i > 0 )
+        {
+            ASSERT_LT ( angle ( ( *points ) [result[i - 1]] ), angle ( ( *points ) [result[i]] ) );
+        }
+    }
+}
+
+
+TEST ( pf, DISABLED_point_sorter_benchmark )
+{
+    // The planar graph of n points has O(n^2) edges, so the size is kept moderate.
+    const unsigned int number_of_points = 1000;
+    std::shared_ptr< ues::pf::vg2d::point_vector > points = random_points ( number_of_points );
+    ues::pf::vg2d::point_sorter ps ( points );
+
+    // Sort the points from every origin, reusing the same buffers.
+    ues::pf::vg2d::point_index_vector result;
+    ues::pf::vg2d::planar_graph::crossing_buffer buffer;
+    const auto start = std::chrono::steady_clock::now();
+    for ( ues::pf::vg2d::point_index origin = 0; origin < number_of_points; ++origin )
+    {
+        ps.get_sorted_list_of_points ( origin, result, buffer );
+    }
+    const std::chrono::duration< double, std::micro > elapsed = std::chrono::steady_clock::now() - start;
+    RecordProperty ( "microseconds_per_origin", static_cast< int > ( elapsed.count() / number_of_points ) );
+}
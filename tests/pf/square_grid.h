@@ -0,0 +1,129 @@
+/*
+ * Copyright 2015-2017 Guillermo Frontera <guillermo.frontera@upm.es>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#ifndef UES_TESTS_SQUARE_GRID
+#define UES_TESTS_SQUARE_GRID
+
+#include <array>
+#include <random>
+
+#include <geom/point.h>
+#include <pf/visibility_graph_2d/util/scenario.h>
+#include <pf/visibility_graph_2d/visibility_graph.h>
+
+namespace
+{
+
+typedef std::array< ues::geom::point<2>, 4 > quadrilateral_corners;
+
+/** Appends a quadrilateral with the given clockwise \a corners to the points, segments and
+ * polygons of a 2D scenario. */
+void add_quadrilateral ( ues::pf::vg2d::point_vector & points, ues::pf::vg2d::segment_vector & segments,
+                         ues::pf::vg2d::polygon_vector & polygons, const quadrilateral_corners & corners )
+{
+    const ues::pf::vg2d::point_index first = points.size();
+    points.insert ( points.end(), corners.cbegin(), corners.cend() );
+
+    ues::pf::vg2d::polygon sides;
+    for ( ues::pf::vg2d::point_index k = 0; k < 4; ++k )
+    {
+        sides.push_back ( segments.size() );
+        segments.push_back ( { first + k, first + ( k + 1 ) % 4 } );
+    }
+    polygons.push_back ( sides );
+}
+
+/** Builds a 2D scenario with a grid of \a columns by \a rows cells. For every cell (i, j),
+ * \a cell_corners ( i, j, corners ) fills the clockwise corners of its obstacle, or returns
+ * false to leave the cell empty. The \a free_points are added after the obstacles. */
+template < typename CellCorners >
+ues::pf::vg2d::scenario quadrilateral_grid_scenario ( unsigned int columns, unsigned int rows, CellCorners cell_corners,
+                                                      const ues::pf::vg2d::point_vector & free_points = ues::pf::vg2d::point_vector() )
+{
+    ues::pf::vg2d::point_vector points;
+    ues::pf::vg2d::segment_vector segments;
+    ues::pf::vg2d::polygon_vector polygons;
+    quadrilateral_corners corners;
+    for ( unsigned int i = 0; i < columns; ++i )
+    {
+        for ( unsigned int j = 0; j < rows; ++j )
+        {
+            if ( cell_corners ( i, j, corners ) )
+            {
+                add_quadrilateral ( points, segments, polygons, corners );
+            }
+        }
+    }
+    points.insert ( points.end(), free_points.cbegin(), free_points.cend() );
+    return ues::pf::vg2d::scenario ( std::move ( points ), std::move ( segments ), std::move ( polygons ) );
+}
+
+/** Returns the clockwise corners of a square of random side and position inside the cell
+ * (\a i, \a j) of a grid of cells of side \a cell_size. */
+quadrilateral_corners random_square_in_cell ( unsigned int i, unsigned int j, ues::math::numeric_type cell_size, std::mt19937 & generator )
+{
+    std::uniform_real_distribution<ues::math::numeric_type> uniform ( 0, 1 );
+    const ues::math::numeric_type side = cell_size * ( 0.3 + 0.4 * uniform ( generator ) );
+    const ues::math::numeric_type x = i * cell_size + ( cell_size - side ) * uniform ( generator );
+    const ues::math::numeric_type y = j * cell_size + ( cell_size - side ) * uniform ( generator );
+    return { { { x, y }, { x, y + side }, { x + side, y + side }, { x + side, y } } };
+}
+
+
+/** Builds the visibility graph of a grid of \a grid_size by \a grid_size points, in which
+ * every point sees its horizontal, vertical and diagonal neighbours, except for a wall along
+ * the middle column that can only be crossed through the first row. The point of column i and
+ * row j has index i * grid_size + j. */
+std::shared_ptr< ues::pf::vg2d::visibility_graph > walled_grid_graph ( int grid_size, ues::pf::vg2d::shared_point_vector & points )
+{
+    ues::pf::vg2d::point_vector grid;
+    for ( int i = 0; i < grid_size; ++i )
+    {
+        for ( int j = 0; j < grid_size; ++j )
+        {
+            grid.push_back ( { static_cast<ues::math::numeric_type> ( i ), static_cast<ues::math::numeric_type> ( j ) } );
+        }
+    }
+    points = std::make_shared<const ues::pf::vg2d::point_vector> ( grid );
+
+    const int wall = grid_size / 2;
+    std::shared_ptr< ues::pf::vg2d::visibility_graph > vg = std::make_shared< ues::pf::vg2d::visibility_graph > ( points );
+    for ( int i = 0; i < grid_size; ++i )
+    {
+        for ( int j = 0; j < grid_size; ++j )
+        {
+            for ( int di = 0; di <= 1; ++di )
+            {
+                for ( int dj = -1; dj <= 1; ++dj )
+                {
+                    int ni = i + di;
+                    int nj = j + dj;
+                    bool blocked = di != 0 && ( i == wall || ni == wall ) && j > 0 && nj > 0;
+                    if ( ( di != 0 || dj == 1 ) && ni < grid_size && nj >= 0 && nj < grid_size && !blocked )
+                    {
+                        vg->add_visibility ( ( *points ) [i * grid_size + j], ( *points ) [ni * grid_size + nj] );
+                    }
+                }
+            }
+        }
+    }
+    return vg;
+}
+
+}
+
+#endif // UES_TESTS_SQUARE_GRID
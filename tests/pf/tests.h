@@ -15,6 +15,8 @@
  *
  */
 
+#include "path_shortcutter.h"
+
 #include "blovl/baseline_pathfinder.h"
 
 #include "plane_cut/plane_cut_pathfinder.h"
@@ -26,9 +28,17 @@
 #include "motion_planning/prm_pathfinder.h"
 #include "motion_planning/bitstar_pathfinder.h"
 
+#include "visibility_graph/contraction_hierarchy.h"
 #include "visibility_graph/graph_pathfinder.h"
+#include "visibility_graph/landmark_heuristic.h"
+#include "visibility_graph/mapped_visibility_graph.h"
+#include "visibility_graph/path_database.h"
+#include "visibility_graph/static_graph_pathfinder.h"
 
+#include "visibility_graph_2d/visibility_graph_cache.h"
 #include "visibility_graph_2d/visibility_graph_generator.h"
 #include "visibility_graph_2d/envelope.h"
 #include "visibility_graph_2d/least_common_ancestor_calculator.h"
+#include "visibility_graph_2d/rotational_sweep.h"
+#include "visibility_graph_2d/visibility_graph_pathfinder.h"
 #include "visibility_graph_3d/visibility_graph_generator.h"
@@ -0,0 +1,131 @@
+/*
+ * Copyright 2015-2017 Guillermo Frontera <guillermo.frontera@upm.es>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include "gtest/gtest.h"
+
+#include <cstdint>
+#include <sstream>
+
+#include <pf/visibility_graph/contraction_hierarchy.h>
+#include <pf/visibility_graph/graph_pathfinder.h>
+#include <pf/visibility_graph_2d/rotational_sweep/rotational_sweep.h>
+#include <pf/visibility_graph_2d/visibility_graph.h>
+#include <pf/visibility_graph_2d/visibility_graph_generator.h>
+#include <tests/pf/square_grid.h>
+
+
+TEST ( pf, contraction_hierarchy )
+{
+    ues::pf::vg2d::shared_point_vector points;
+    std::shared_ptr< ues::pf::vg2d::visibility_graph > vg = walled_grid_graph ( 7, points );
+
+    ues::pf::graph_pathfinder<2> finder ( vg );
+    ues::pf::contraction_hierarchy<2> ch ( *vg );
+    ASSERT_EQ ( points->size(), ch.size() );
+
+    for ( const ues::geom::point<2> & origin : *points )
+    {
+        for ( const ues::geom::point<2> & target : *points )
+        {
+            ues::pf::path<2> result = ch.find_path ( origin, target );
+            ASSERT_EQ ( origin, result.front() );
+            ASSERT_EQ ( target, result.back() );
+            for ( ues::pf::path<2>::size_type i = 1; i < result.size(); ++i )
+            {
+                ues::math::numeric_type distance;
+                ASSERT_TRUE ( vg->check_visibility ( result[i - 1], result[i], distance ) );
+            }
+            ASSERT_NEAR ( finder.find_path ( origin, target ).length(), result.length(), 1e-9 );
+        }
+    }
+}
+
+
+TEST ( pf, contraction_hierarchy_attached_points )
+{
+    // The hierarchy is built from the obstacles only, and the free points are attached to it by
+    // their coordinates. The reference graph also contains the free points, so its indices
+    // differ from those of the hierarchy.
+    auto cell_corners = [] ( unsigned int i, unsigned int j, quadrilateral_corners & corners )
+    {
+        const double x = 4.0 * i + ( j % 2 ), y = 4.0 * j;
+        corners = { { { x, y }, { x, y + 2 }, { x + 2, y + 2 }, { x + 2, y } } };
+        return true;
+    };
+    const ues::geom::point<2> origin ( -1, -1 ), target ( 12, 11 );
+    ues::pf::vg2d::scenario obstacle_scenario = quadrilateral_grid_scenario ( 3, 3, cell_corners );
+    ues::pf::vg2d::scenario reference_scenario = quadrilateral_grid_scenario ( 3, 3, cell_corners, { target, origin } );
+
+    ues::pf::vg2d::visibility_graph_generator obstacle_generator ( obstacle_scenario.get_shared_points() );
+    std::shared_ptr< ues::pf::vg2d::visibility_graph > obstacle_graph = obstacle_generator.generate_visibility_graph ( obstacle_scenario.get_shared_segments(),
+                                                                                                                      obstacle_scenario.get_shared_polygons() );
+    ues::pf::vg2d::visibility_graph_generator reference_generator ( reference_scenario.get_shared_points() );
+    std::shared_ptr< ues::pf::vg2d::visibility_graph > reference_graph = reference_generator.generate_visibility_graph ( reference_scenario.get_shared_segments(),
+                                                                                                                        reference_scenario.get_shared_polygons() );
+    ues::pf::graph_pathfinder<2> finder ( reference_graph );
+    ues::pf::vg2d::rotational_sweep obstacles ( obstacle_scenario );
+
+    std::stringstream buffer;
+    ues::pf::contraction_hierarchy<2> ( *obstacle_graph ).save ( buffer );
+    ues::pf::contraction_hierarchy<2> ch = ues::pf::contraction_hierarchy<2>::load ( buffer );
+
+    // Queries between free points, from a vertex of the obstacles and to it.
+    ASSERT_FALSE ( obstacles.check_visibility ( origin, target ) );
+    const ues::geom::point<2> & vertex = obstacle_scenario.get_points() [5];
+    for ( const std::pair< ues::geom::point<2>, ues::geom::point<2> > & query : { std::make_pair ( origin, target ),
+            std::make_pair ( vertex, target ), std::make_pair ( origin, vertex ) } )
+    {
+        ues::pf::path<2> result = ch.find_path ( obstacles, query.first, query.second );
+        EXPECT_EQ ( query.first, result.front() );
+        EXPECT_EQ ( query.second, result.back() );
+        for ( ues::pf::path<2>::size_type i = 1; i < result.size(); ++i )
+        {
+            EXPECT_TRUE ( obstacles.check_visibility ( result[i - 1], result[i] ) );
+        }
+        EXPECT_NEAR ( finder.find_path ( query.first, query.second ).length(), result.length(), 1e-9 );
+    }
+
+    // Free points that see each other are joined directly.
+    const ues::geom::point<2> below_origin ( -1, -2 );
+    EXPECT_EQ ( ues::pf::path<2> ( { origin, below_origin } ), ch.find_path ( obstacles, origin, below_origin ) );
+}
+
+
+TEST ( pf, contraction_hierarchy_corrupted )
+{
+    ues::pf::vg2d::shared_point_vector points;
+    std::shared_ptr< ues::pf::vg2d::visibility_graph > vg = walled_grid_graph ( 7, points );
+    ues::pf::contraction_hierarchy<2> ch ( *vg );
+    ASSERT_LT ( 0u, ch.number_of_shortcuts() );
+    std::ostringstream out;
+    ch.save ( out );
+    const std::string saved = out.str();
+
+    // The offsets follow the header, the number of coordinates and the coordinates, and the
+    // shortcut middles are the last field.
+    const std::size_t offsets_position = 20 + 8 + points->size() * 2 * sizeof ( double ) + 8;
+    auto load_with = [&] ( std::size_t position, std::uint64_t value )
+    {
+        std::string corrupted = saved;
+        corrupted.replace ( position, sizeof ( value ), reinterpret_cast<const char *> ( &value ), sizeof ( value ) );
+        std::istringstream in ( corrupted );
+        ues::pf::contraction_hierarchy<2>::load ( in );
+    };
+    EXPECT_NO_THROW ( load_with ( offsets_position, 0 ) );
+    EXPECT_THROW ( load_with ( offsets_position + 8, std::numeric_limits<std::uint32_t>::max() ), ues::exc::exception );
+    EXPECT_THROW ( load_with ( saved.size() - 8, points->size() ), ues::exc::exception );
+}
@@ -17,8 +17,12 @@
 
 #include "gtest/gtest.h"
 
+#include <type_traits>
+
+#include <pf/naive_3d/visibility_graph.h>
 #include <pf/visibility_graph/graph_pathfinder.h>
 #include <pf/visibility_graph_2d/visibility_graph.h>
+#include <tests/pf/square_grid.h>
 
 
 TEST ( pf, pathfinder_2d )
@@ -46,3 +50,223 @@ TEST ( pf, pathfinder_2d )
     EXPECT_EQ ( expected_result, result );
 
 }
+
+TEST ( pf, pathfinder_2d_batch )
+{
+    ues::pf::vg2d::shared_point_vector points = std::make_shared<const ues::pf::vg2d::point_vector> ( ues::pf::vg2d::point_vector { { 0, 0 }, { 1, 0 }, { 2, 0 }, { 0, 1 }, { 1, 1 }, { 2, 1 } } );
+    std::shared_ptr< ues::pf::vg2d::visibility_graph > vg = std::make_shared< ues::pf::vg2d::visibility_graph > ( points );
+
+    vg->add_visibility ( (*points)[0], (*points)[1] );
+    vg->add_visibility ( (*points)[0], (*points)[4] );
+    vg->add_visibility ( (*points)[2], (*points)[5] );
+    vg->add_visibility ( (*points)[3], (*points)[4] );
+    vg->add_visibility ( (*points)[4], (*points)[5] );
+
+    ues::pf::graph_pathfinder<2> finder ( vg );
+
+    ues::pf::graph_pathfinder<2>::query_vector queries;
+    for ( unsigned int repetition = 0; repetition < 20; ++repetition )
+    {
+        for ( const ues::geom::point<2> & origin : *points )
+        {
+            for ( const ues::geom::point<2> & target : *points )
+            {
+                queries.push_back ( { origin, target } );
+            }
+        }
+    }
+
+    ues::pf::graph_pathfinder<2>::path_vector result = finder.find_paths ( queries, 4 );
+
+    ASSERT_EQ ( queries.size(), result.size() );
+    for ( std::size_t i = 0; i < queries.size(); ++i )
+    {
+        EXPECT_EQ ( finder.find_path ( queries[i].first, queries[i].second ), result[i] );
+    }
+}
+
+TEST ( pf, pathfinder_lazy_evaluation )
+{
+    ues::env::obstacle_vector obstacles;
+    obstacles.push_back ( ues::env::obstacle ( { { 1, -1 }, { 1, 1 }, { 2, 1 }, { 2, -1 } }, 2 ) );
+
+    ues::geom::point<3> origin = { 0, 0, 1 };
+    ues::geom::point<3> target = { 3, 0, 1 };
+
+    ues::pf::graph_pathfinder<3> finder ( std::make_shared< ues::pf::naive_3d::visibility_graph > ( obstacles, origin, target ) );
+    ues::pf::path<3> eager_result = finder.find_path ( origin, target );
+
+    finder.set_edge_evaluation ( ues::pf::graph_pathfinder<3>::LAZY_EVALUATION );
+    ues::pf::path<3> lazy_result = finder.find_path ( origin, target );
+
+    EXPECT_GT ( lazy_result.length(), origin.distance_to ( target ) );
+    EXPECT_DOUBLE_EQ ( eager_result.length(), lazy_result.length() );
+    for ( ues::pf::path<3>::size_type i = 1; i < lazy_result.size(); ++i )
+    {
+        EXPECT_FALSE ( obstacles.check_intersection ( ues::geom::segment<3> ( lazy_result[i - 1], lazy_result[i] ) ) );
+    }
+}
+
+TEST ( pf, pathfinder_ellipse_bound )
+{
+    ues::pf::vg2d::shared_point_vector points = std::make_shared<const ues::pf::vg2d::point_vector> ( ues::pf::vg2d::point_vector { { 0, 0 }, { 1, 0 }, { 2, 0 }, { 0, 1 }, { 1, 1 }, { 2, 1 }, { 1, 5 } } );
+    std::shared_ptr< ues::pf::vg2d::visibility_graph > vg = std::make_shared< ues::pf::vg2d::visibility_graph > ( points );
+
+    vg->add_visibility ( (*points)[0], (*points)[1] );
+    vg->add_visibility ( (*points)[0], (*points)[4] );
+    vg->add_visibility ( (*points)[2], (*points)[5] );
+    vg->add_visibility ( (*points)[3], (*points)[4] );
+    vg->add_visibility ( (*points)[4], (*points)[5] );
+    vg->add_visibility ( (*points)[0], (*points)[6] );
+    vg->add_visibility ( (*points)[2], (*points)[6] );
+
+    ues::pf::graph_pathfinder<2> finder ( vg );
+    ues::pf::search_workspace<2> workspace;
+    const ues::geom::point<2> & origin = (*points)[0];
+    const ues::geom::point<2> & target = (*points)[2];
+
+    ues::pf::path<2> unbounded_result = finder.find_path ( origin, target, workspace );
+    std::size_t unbounded_expansions = workspace.explored.size();
+
+    // The detour through the farthest point is pruned by a bound of the length of the shortest path.
+    ues::math::numeric_type length = unbounded_result.length();
+    EXPECT_TRUE ( ues::pf::ellipse_bound<2> ( origin, target, length ).contains ( (*points)[4] ) );
+    EXPECT_FALSE ( ues::pf::ellipse_bound<2> ( origin, target, length ).contains ( (*points)[6] ) );
+    EXPECT_EQ ( unbounded_result, finder.find_path ( origin, target, workspace, ues::pf::ellipse_bound<2> ( origin, target, length ) ) );
+    EXPECT_LE ( workspace.explored.size(), unbounded_expansions );
+
+    // No path is shorter than the shortest one.
+    EXPECT_THROW ( finder.find_path ( origin, target, workspace, ues::pf::ellipse_bound<2> ( origin, target, 0.9 * length ) ), ues::exc::exception );
+
+    finder.set_edge_evaluation ( ues::pf::graph_pathfinder<2>::LAZY_EVALUATION );
+    EXPECT_EQ ( unbounded_result, finder.find_path ( origin, target, workspace, ues::pf::ellipse_bound<2> ( origin, target, length ) ) );
+}
+
+TEST ( pf, pathfinder_weighted_search )
+{
+    ues::pf::vg2d::shared_point_vector shared_points;
+    std::shared_ptr< ues::pf::vg2d::visibility_graph > vg = walled_grid_graph ( 10, shared_points );
+    const ues::pf::vg2d::point_vector & points = *shared_points;
+    ues::pf::graph_pathfinder<2> finder ( vg );
+
+    EXPECT_THROW ( finder.set_heuristic_weight ( 0.5 ), ues::exc::exception );
+
+    for ( std::size_t origin = 0; origin < points.size(); origin += 7 )
+    {
+        for ( std::size_t target = 0; target < points.size(); target += 3 )
+        {
+            finder.set_heuristic_weight ( 1 );
+            ues::math::numeric_type optimal = finder.find_path ( points[origin], points[target] ).length();
+            finder.set_heuristic_weight ( 2.5 );
+            ues::math::numeric_type weighted = finder.find_path ( points[origin], points[target] ).length();
+
+            EXPECT_GE ( weighted, optimal - 1e-9 );
+            EXPECT_LE ( weighted, 2.5 * optimal + 1e-9 );
+        }
+    }
+}
+
+TEST ( pf, pathfinder_anytime_search )
+{
+    ues::pf::vg2d::shared_point_vector shared_points;
+    std::shared_ptr< ues::pf::vg2d::visibility_graph > vg = walled_grid_graph ( 10, shared_points );
+    const ues::pf::vg2d::point_vector & points = *shared_points;
+    ues::pf::graph_pathfinder<2> finder ( vg );
+
+    const ues::geom::point<2> & origin = points[ 2 * 10 + 4 ];
+    const ues::geom::point<2> & target = points[ 8 * 10 + 5 ];
+    ues::math::numeric_type optimal = finder.find_path ( origin, target ).length();
+
+    std::vector< ues::pf::graph_pathfinder<2>::bounded_path > improvements;
+    boost::posix_time::ptime deadline = boost::posix_time::microsec_clock::universal_time() + boost::posix_time::seconds ( 60 );
+    ues::pf::graph_pathfinder<2>::bounded_path result = finder.find_path_anytime ( origin, target, 3, 0.5, deadline,
+            [&] ( const ues::pf::graph_pathfinder<2>::bounded_path & p )
+    {
+        improvements.push_back ( p );
+    } );
+
+    ASSERT_FALSE ( improvements.empty() );
+    for ( std::size_t i = 0; i < improvements.size(); ++i )
+    {
+        EXPECT_NEAR ( improvements[i].cost, improvements[i].points.length(), 1e-9 );
+        EXPECT_LE ( improvements[i].cost, improvements[i].suboptimality_bound * optimal + 1e-9 );
+        if ( i > 0 )
+        {
+            EXPECT_LE ( improvements[i].cost, improvements[i - 1].cost );
+            EXPECT_LE ( improvements[i].suboptimality_bound, improvements[i - 1].suboptimality_bound );
+        }
+    }
+
+    // With no time limit in practice, the search ends with a path proven optimal.
+    EXPECT_DOUBLE_EQ ( 1, result.suboptimality_bound );
+    EXPECT_DOUBLE_EQ ( optimal, result.cost );
+
+    // The deadline is only checked every few expansions, so a deadline already reached still
+    // lets the first weighted search end when it takes few expansions, and it returns its path.
+    result = finder.find_path_anytime ( origin, target, 3, 0.5, boost::posix_time::ptime ( boost::posix_time::min_date_time ) );
+    EXPECT_EQ ( improvements.front().points, result.points );
+    EXPECT_DOUBLE_EQ ( improvements.front().cost, result.cost );
+    EXPECT_DOUBLE_EQ ( improvements.front().suboptimality_bound, result.suboptimality_bound );
+}
+
+TEST ( pf, pathfinder_interleaved_batch )
+{
+    ues::pf::vg2d::shared_point_vector shared_points;
+    ues::pf::graph_pathfinder<2> finder ( walled_grid_graph ( 10, shared_points ) );
+    const ues::pf::vg2d::point_vector & points = *shared_points;
+
+    ues::pf::graph_pathfinder<2>::query_vector queries;
+    for ( std::size_t i = 0; i < points.size(); i += 7 )
+    {
+        for ( std::size_t j = 0; j < points.size(); j += 3 )
+        {
+            queries.push_back ( { points[i], points[j] } );
+        }
+    }
+
+    // The number of queries is not a multiple of the number of interleaved searches.
+    for ( unsigned int interleaving : { 1, 4, 7, 1000 } )
+    {
+        ues::pf::graph_pathfinder<2>::path_vector result = finder.find_paths_interleaved ( queries, interleaving );
+        ASSERT_EQ ( queries.size(), result.size() );
+        for ( std::size_t i = 0; i < queries.size(); ++i )
+        {
+            EXPECT_EQ ( finder.find_path ( queries[i].first, queries[i].second ), result[i] );
+        }
+    }
+
+    // A failed query does not stop the rest, and its error is reported at the end.
+    queries.insert ( queries.begin() + 2, { points[0], ues::geom::point<2> ( -1, -1 ) } );
+    EXPECT_THROW ( finder.find_paths_interleaved ( queries, 4 ), ues::exc::exception );
+    EXPECT_THROW ( finder.find_paths_interleaved ( queries, 0 ), ues::exc::exception );
+}
+
+TEST ( pf, pathfinder_search_statistics )
+{
+#ifdef UES_PF_SEARCH_STATISTICS
+    ues::pf::vg2d::shared_point_vector shared_points;
+    ues::pf::graph_pathfinder<2> finder ( walled_grid_graph ( 10, shared_points ) );
+    const ues::pf::vg2d::point_vector & points = *shared_points;
+
+    ues::pf::search_workspace<2> workspace;
+    finder.find_path ( points[ 2 * 10 + 4 ], points[ 8 * 10 + 5 ], workspace );
+    ues::pf::search_statistics eager_statistics = workspace.statistics;
+
+    finder.set_edge_evaluation ( ues::pf::graph_pathfinder<2>::LAZY_EVALUATION );
+    finder.find_path ( points[ 2 * 10 + 4 ], points[ 8 * 10 + 5 ], workspace );
+    ues::pf::search_statistics lazy_statistics = workspace.statistics;
+
+    for ( const ues::pf::search_statistics & statistics : { eager_statistics, lazy_statistics } )
+    {
+        EXPECT_GT ( statistics.expanded_points, 0u );
+        EXPECT_GE ( statistics.relaxed_edges, statistics.expanded_points );
+        EXPECT_GT ( statistics.peak_frontier_size, 1u );
+        EXPECT_LE ( statistics.peak_frontier_size, statistics.relaxed_edges + 1 );
+    }
+    EXPECT_GT ( eager_statistics.decreased_keys, 0u );
+    EXPECT_EQ ( 0u, lazy_statistics.decreased_keys );
+#else
+    // Without statistics compiled in, the searches carry an empty object.
+    EXPECT_TRUE ( std::is_empty< ues::pf::search_statistics >::value );
+#endif
+}
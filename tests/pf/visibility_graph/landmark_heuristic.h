@@ -0,0 +1,130 @@
+/*
+ * Copyright 2015-2017 Guillermo Frontera <guillermo.frontera@upm.es>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include "gtest/gtest.h"
+
+#include <chrono>
+#include <random>
+#include <string>
+
+#include <pf/visibility_graph/graph_pathfinder.h>
+#include <pf/visibility_graph/landmark_heuristic.h>
+#include <pf/visibility_graph_2d/util/scenario.h>
+#include <pf/visibility_graph_2d/visibility_graph_generator.h>
+#include <tests/pf/square_grid.h>
+
+namespace
+{
+
+/** Generates a scenario in which every cell of a grid contains a randomly sized and placed
+ * square obstacle with probability \a density. */
+ues::pf::vg2d::scenario landmark_test_scenario ( double density, std::mt19937 & generator )
+{
+    std::uniform_real_distribution<ues::math::numeric_type> uniform ( 0, 1 );
+    return quadrilateral_grid_scenario ( 8, 8, [&] ( unsigned int i, unsigned int j, quadrilateral_corners & corners )
+    {
+        if ( uniform ( generator ) >= density )
+            return false;
+
+        corners = random_square_in_cell ( i, j, 10, generator );
+        return true;
+    } );
+}
+
+
+/** Nodes expanded and time spent by searches with and without landmarks. */
+struct landmark_comparison
+{
+    std::size_t number_of_points = 0;
+    std::size_t plain_expansions = 0;
+    std::size_t alt_expansions = 0;
+    std::chrono::duration< double, std::micro > plain_time { 0 };
+    std::chrono::duration< double, std::micro > alt_time { 0 };
+};
+
+
+/** Runs \a number_of_queries random queries in a scenario of the given \a density with
+ * \a number_of_landmarks landmarks and with straight-line distance only, checking that both
+ * searches find paths of the same length. */
+landmark_comparison compare_landmark_searches ( double density, unsigned int number_of_queries, unsigned int number_of_landmarks,
+                                                std::mt19937 & generator )
+{
+    ues::pf::vg2d::scenario current_scenario = landmark_test_scenario ( density, generator );
+    ues::pf::vg2d::visibility_graph_generator graph_generator ( current_scenario.get_shared_points() );
+    std::shared_ptr< ues::pf::vg2d::visibility_graph > vg = graph_generator.generate_visibility_graph ( current_scenario.get_shared_segments(),
+                                                                                                        current_scenario.get_shared_polygons() );
+    const ues::pf::vg2d::point_vector & points = current_scenario.get_points();
+
+    ues::pf::graph_pathfinder<2> plain_finder ( vg );
+    ues::pf::graph_pathfinder<2> alt_finder ( vg );
+    alt_finder.set_landmark_heuristic ( std::make_shared< ues::pf::landmark_heuristic<2> > ( *vg, number_of_landmarks ) );
+
+    landmark_comparison result;
+    result.number_of_points = points.size();
+    ues::pf::search_workspace<2> workspace;
+    std::uniform_int_distribution<std::size_t> random_point ( 0, points.size() - 1 );
+    for ( unsigned int i = 0; i < number_of_queries; ++i )
+    {
+        const ues::geom::point<2> & origin = points[ random_point ( generator ) ];
+        const ues::geom::point<2> & target = points[ random_point ( generator ) ];
+
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        const ues::math::numeric_type plain_length = plain_finder.find_path ( origin, target, workspace ).length();
+        result.plain_time += std::chrono::steady_clock::now() - start;
+        result.plain_expansions += workspace.explored.size();
+
+        start = std::chrono::steady_clock::now();
+        const ues::math::numeric_type alt_length = alt_finder.find_path ( origin, target, workspace ).length();
+        result.alt_time += std::chrono::steady_clock::now() - start;
+        result.alt_expansions += workspace.explored.size();
+
+        EXPECT_NEAR ( plain_length, alt_length, 1e-6 );
+    }
+    return result;
+}
+
+}
+
+
+TEST ( pf, landmark_heuristic_expansions )
+{
+    // Landmark bounds are never below the straight-line distance, so the searches find paths of
+    // the same length without expanding more points.
+    std::mt19937 generator ( 42 );
+    for ( double density : { 0.25, 0.5, 0.75, 1.0 } )
+    {
+        const landmark_comparison result = compare_landmark_searches ( density, 50, 8, generator );
+        EXPECT_LE ( result.alt_expansions, result.plain_expansions ) << "Density " << density;
+        EXPECT_LT ( 0u, result.alt_expansions ) << "Density " << density;
+    }
+}
+
+
+TEST ( pf, DISABLED_landmark_heuristic_benchmark )
+{
+    std::mt19937 generator ( 42 );
+    for ( double density : { 0.25, 0.5, 0.75, 1.0 } )
+    {
+        const landmark_comparison result = compare_landmark_searches ( density, 500, 8, generator );
+        const std::string prefix = "density_" + std::to_string ( static_cast< int > ( density * 100 ) ) + "_";
+        RecordProperty ( prefix + "points", static_cast< int > ( result.number_of_points ) );
+        RecordProperty ( prefix + "plain_expansions", static_cast< int > ( result.plain_expansions ) );
+        RecordProperty ( prefix + "alt_expansions", static_cast< int > ( result.alt_expansions ) );
+        RecordProperty ( prefix + "plain_us", static_cast< int > ( result.plain_time.count() ) );
+        RecordProperty ( prefix + "alt_us", static_cast< int > ( result.alt_time.count() ) );
+    }
+}
@@ -0,0 +1,189 @@
+/*
+ * Copyright 2015-2017 Guillermo Frontera <guillermo.frontera@upm.es>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include "gtest/gtest.h"
+
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <limits>
+#include <sstream>
+
+#include <pf/visibility_graph/graph_pathfinder.h>
+#include <pf/visibility_graph/mapped_visibility_graph.h>
+#include <pf/visibility_graph_2d/visibility_graph_generator.h>
+#include <pf/visibility_graph_2d/util/scenario.h>
+#include <tests/pf/square_grid.h>
+
+namespace
+{
+
+/** Copies the contents of \a buffer to memory aligned as the binary graphs require. */
+std::shared_ptr<const void> aligned_copy ( const std::string & buffer )
+{
+    std::shared_ptr< std::vector< std::uint64_t > > storage = std::make_shared< std::vector< std::uint64_t > > ( buffer.size() / 8 + 1 );
+    std::copy ( buffer.begin(), buffer.end(), reinterpret_cast<char *> ( storage->data() ) );
+    return std::shared_ptr<const void> ( storage, storage->data() );
+}
+
+}
+
+TEST ( pf, mapped_visibility_graph )
+{
+    // Two clockwise squares between the origin and the target.
+    ues::pf::vg2d::scenario current_scenario ( ues::pf::vg2d::point_vector { { 1, 1 }, { 1, 3 }, { 3, 3 }, { 3, 1 },
+                                                                             { 4, -2 }, { 4, 0 }, { 6, 0 }, { 6, -2 },
+                                                                             { 0, 0 }, { 8, 2 } },
+    ues::pf::vg2d::segment_vector { { 0, 1 }, { 1, 2 }, { 2, 3 }, { 3, 0 }, { 4, 5 }, { 5, 6 }, { 6, 7 }, { 7, 4 } },
+    ues::pf::vg2d::polygon_vector { { 0, 1, 2, 3 }, { 4, 5, 6, 7 } } );
+    const ues::pf::vg2d::point_vector & points = current_scenario.get_points();
+
+    ues::pf::vg2d::visibility_graph_generator graph_generator ( current_scenario.get_shared_points() );
+    std::shared_ptr< ues::pf::vg2d::visibility_graph > vg = graph_generator.generate_visibility_graph ( current_scenario.get_shared_segments(),
+                                                                                                        current_scenario.get_shared_polygons() );
+
+    std::ostringstream out;
+    vg->save ( out );
+    std::shared_ptr< ues::pf::mapped_visibility_graph<2> > mapped = std::make_shared< ues::pf::mapped_visibility_graph<2> > ( aligned_copy ( out.str() ), out.str().size() );
+
+    ASSERT_EQ ( vg->size(), mapped->size() );
+    ASSERT_TRUE ( mapped->has_occlusions() );
+    EXPECT_EQ ( current_scenario.get_segments().size(), mapped->number_of_segments() );
+    EXPECT_EQ ( 6u, mapped->get_segment ( 5 ).second );
+    for ( const ues::geom::point<2> & p1 : points )
+    {
+        for ( const ues::geom::point<2> & p2 : points )
+        {
+            ues::math::numeric_type expected_distance = -1, distance = -1;
+            EXPECT_EQ ( vg->check_visibility ( p1, p2, expected_distance ), mapped->check_visibility ( p1, p2, distance ) );
+            EXPECT_EQ ( expected_distance, distance );
+
+            ues::pf::vg2d::segment_index expected_segment = 0;
+            std::size_t segment = 0;
+            EXPECT_EQ ( vg->check_occlusion_segment ( p1, p2, expected_segment ), mapped->check_occlusion_segment ( p1, p2, segment ) );
+            EXPECT_EQ ( expected_segment, segment );
+        }
+    }
+
+    ues::pf::graph_pathfinder<2> expected_finder ( vg );
+    ues::pf::graph_pathfinder<2> mapped_finder ( mapped );
+    EXPECT_EQ ( expected_finder.find_path ( points[8], points[9] ), mapped_finder.find_path ( points[8], points[9] ) );
+    EXPECT_THROW ( mapped_finder.find_path ( points[8], { 9, 9 } ), ues::exc::exception );
+    // Interleaved searches prefetch the edges stored in the mapped data.
+    const ues::pf::graph_pathfinder<2>::query_vector queries { { points[8], points[9] }, { points[9], points[8] }, { points[0], points[9] } };
+    EXPECT_EQ ( expected_finder.find_paths_interleaved ( queries ), mapped_finder.find_paths_interleaved ( queries, 2 ) );
+
+    // Map the graph from a file.
+    const std::string file_name = "mapped_visibility_graph_test.bin";
+    {
+        std::ofstream file ( file_name, std::ios::binary );
+        vg->save ( file );
+    }
+    std::shared_ptr< ues::pf::mapped_visibility_graph<2> > mapped_file = ues::pf::mapped_visibility_graph<2>::map_file ( file_name );
+    std::remove ( file_name.c_str() );
+    EXPECT_EQ ( expected_finder.find_path ( points[8], points[9] ), ues::pf::graph_pathfinder<2> ( mapped_file ).find_path ( points[8], points[9] ) );
+
+    // Corrupted data is rejected.
+    std::string truncated = out.str().substr ( 0, out.str().size() - 8 );
+    EXPECT_THROW ( ues::pf::mapped_visibility_graph<2> ( aligned_copy ( truncated ), truncated.size() ), ues::exc::exception );
+    EXPECT_THROW ( ues::pf::mapped_visibility_graph<3> ( aligned_copy ( out.str() ), out.str().size() ), ues::exc::exception );
+
+    // Offsets that decrease and neighbours out of the graph are not read when the data is
+    // mapped, but they are rejected by validate(). The header stores the positions of the
+    // offsets and neighbours sections at bytes 64 and 72.
+    EXPECT_NO_THROW ( mapped->validate() );
+    auto corrupt = [&out] ( std::size_t header_field, std::size_t element, std::uint64_t value )
+    {
+        std::string data = out.str();
+        std::uint64_t section;
+        data.copy ( reinterpret_cast<char *> ( &section ), sizeof ( section ), header_field );
+        data.replace ( section + element * sizeof ( value ), sizeof ( value ), reinterpret_cast<const char *> ( &value ), sizeof ( value ) );
+        ues::pf::mapped_visibility_graph<2> corrupted ( aligned_copy ( data ), data.size() );
+        corrupted.validate();
+    };
+    EXPECT_NO_THROW ( corrupt ( 64, 0, 0 ) );
+    EXPECT_THROW ( corrupt ( 64, 1, std::numeric_limits<std::uint32_t>::max() ), ues::exc::exception );
+    EXPECT_THROW ( corrupt ( 72, 0, points.size() ), ues::exc::exception );
+}
+
+TEST ( pf, mapped_visibility_graph_renumbered )
+{
+    // A row of clockwise squares, so the spatial order differs from the order of insertion.
+    ues::pf::vg2d::scenario current_scenario = quadrilateral_grid_scenario ( 4, 1, [] ( unsigned int i, unsigned int, quadrilateral_corners & corners )
+    {
+        const double x = ( i % 2 == 0 ? 3.0 * i : 12.0 - 3.0 * i ), y = ( i % 2 == 0 ? 0.0 : 4.0 );
+        corners = { { { x, y }, { x, y + 2 }, { x + 2, y + 2 }, { x + 2, y } } };
+        return true;
+    }, { { -2, -2 }, { 14, 8 } } );
+    const ues::pf::vg2d::point_vector & points = current_scenario.get_points();
+
+    ues::pf::vg2d::visibility_graph_generator graph_generator ( current_scenario.get_shared_points() );
+    std::shared_ptr< ues::pf::vg2d::visibility_graph > vg = graph_generator.generate_visibility_graph ( current_scenario.get_shared_segments(),
+                                                                                                        current_scenario.get_shared_polygons() );
+
+    std::ostringstream out;
+    vg->save ( out, ues::pf::mapped_visibility_graph<2>::SPATIAL_NUMBERING );
+    std::shared_ptr< ues::pf::mapped_visibility_graph<2> > mapped = std::make_shared< ues::pf::mapped_visibility_graph<2> > ( aligned_copy ( out.str() ), out.str().size() );
+
+    ASSERT_EQ ( vg->size(), mapped->size() );
+    ASSERT_TRUE ( mapped->is_renumbered() );
+    bool moved = false;
+    for ( std::size_t i = 0; i < points.size(); ++i )
+    {
+        std::size_t renumbered = mapped->index_of_original ( i );
+        EXPECT_EQ ( i, mapped->original_index ( renumbered ) );
+        EXPECT_EQ ( points[i], mapped->point_at ( renumbered ) );
+        moved = moved || renumbered != i;
+
+        // The segments keep their indices, with the endpoints renumbered.
+        if ( i < current_scenario.get_segments().size() )
+        {
+            std::pair< std::size_t, std::size_t > s = mapped->get_segment ( i );
+            EXPECT_EQ ( current_scenario.get_segments()[i].first, mapped->original_index ( s.first ) );
+            EXPECT_EQ ( current_scenario.get_segments()[i].second, mapped->original_index ( s.second ) );
+        }
+    }
+    EXPECT_TRUE ( moved );
+    EXPECT_THROW ( mapped->original_index ( points.size() ), ues::exc::exception );
+
+    for ( const ues::geom::point<2> & p1 : points )
+    {
+        for ( const ues::geom::point<2> & p2 : points )
+        {
+            ues::math::numeric_type expected_distance = -1, distance = -1;
+            EXPECT_EQ ( vg->check_visibility ( p1, p2, expected_distance ), mapped->check_visibility ( p1, p2, distance ) );
+            EXPECT_EQ ( expected_distance, distance );
+
+            ues::pf::vg2d::segment_index expected_segment = 0;
+            std::size_t segment = 0;
+            EXPECT_EQ ( vg->check_occlusion_segment ( p1, p2, expected_segment ), mapped->check_occlusion_segment ( p1, p2, segment ) );
+            EXPECT_EQ ( expected_segment, segment );
+        }
+    }
+
+    ues::pf::graph_pathfinder<2> expected_finder ( vg );
+    ues::pf::graph_pathfinder<2> mapped_finder ( mapped );
+    EXPECT_EQ ( expected_finder.find_path ( points[16], points[17] ), mapped_finder.find_path ( points[16], points[17] ) );
+
+    // Graphs saved with their numbering map every index to itself.
+    std::ostringstream original_out;
+    vg->save ( original_out );
+    ues::pf::mapped_visibility_graph<2> original ( aligned_copy ( original_out.str() ), original_out.str().size() );
+    EXPECT_FALSE ( original.is_renumbered() );
+    EXPECT_EQ ( 5u, original.original_index ( 5 ) );
+    EXPECT_EQ ( 5u, original.index_of_original ( 5 ) );
+}
@@ -0,0 +1,140 @@
+/*
+ * Copyright 2015-2017 Guillermo Frontera <guillermo.frontera@upm.es>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include "gtest/gtest.h"
+
+#include <sstream>
+
+#include <pf/visibility_graph/graph_pathfinder.h>
+#include <pf/visibility_graph/path_database.h>
+#include <pf/visibility_graph_2d/rotational_sweep/rotational_sweep.h>
+#include <pf/visibility_graph_2d/visibility_graph_generator.h>
+#include <pf/visibility_graph_2d/util/scenario.h>
+#include <tests/pf/square_grid.h>
+
+namespace
+{
+
+/** Builds a scenario with a grid of clockwise squares followed by the \a free_points, which
+ * are two points at opposite corners by default. */
+ues::pf::vg2d::scenario path_database_test_scenario ( const ues::pf::vg2d::point_vector & free_points = { { 1.5, 1 }, { 9.5, 9 } } )
+{
+    return quadrilateral_grid_scenario ( 3, 3, [] ( unsigned int i, unsigned int j, quadrilateral_corners & corners )
+    {
+        const double x = 4.0 * i + ( j % 2 ), y = 4.0 * j;
+        corners = { { { x, y }, { x, y + 2 }, { x + 2, y + 2 }, { x + 2, y } } };
+        return true;
+    }, free_points );
+}
+
+}
+
+
+TEST ( pf, path_database )
+{
+    ues::pf::vg2d::scenario current_scenario = path_database_test_scenario();
+    const ues::pf::vg2d::point_vector & points = current_scenario.get_points();
+
+    ues::pf::vg2d::visibility_graph_generator graph_generator ( current_scenario.get_shared_points() );
+    std::shared_ptr< ues::pf::vg2d::visibility_graph > vg = graph_generator.generate_visibility_graph ( current_scenario.get_shared_segments(),
+                                                                                                        current_scenario.get_shared_polygons() );
+
+    ues::pf::graph_pathfinder<2> finder ( vg );
+    ues::pf::path_database<2> database ( *vg, 4 );
+    ASSERT_EQ ( vg->size(), database.size() );
+    EXPECT_LT ( database.number_of_runs(), database.size() * database.size() );
+
+    for ( const ues::geom::point<2> & origin : points )
+    {
+        for ( const ues::geom::point<2> & target : points )
+        {
+            ues::pf::path<2> result = database.find_path ( origin, target );
+            ASSERT_EQ ( origin, result.front() );
+            ASSERT_EQ ( target, result.back() );
+            for ( ues::pf::path<2>::size_type i = 1; i < result.size(); ++i )
+            {
+                ues::math::numeric_type distance;
+                ASSERT_TRUE ( vg->check_visibility ( result[i - 1], result[i], distance ) );
+            }
+            ASSERT_NEAR ( finder.find_path ( origin, target ).length(), result.length(), 1e-9 );
+        }
+    }
+    EXPECT_THROW ( database.find_path ( points[0], { -5, -5 } ), ues::exc::exception );
+
+    // The tables do not depend on the number of threads, and are read back as saved.
+    std::stringstream buffer, single_thread_buffer;
+    database.save ( buffer );
+    ues::pf::path_database<2> ( *vg, 1 ).save ( single_thread_buffer );
+    EXPECT_EQ ( buffer.str(), single_thread_buffer.str() );
+
+    ues::pf::path_database<2> loaded = ues::pf::path_database<2>::load ( buffer );
+    EXPECT_EQ ( database.number_of_runs(), loaded.number_of_runs() );
+    EXPECT_EQ ( database.find_path ( points[0], points[35] ), loaded.find_path ( points[0], points[35] ) );
+
+    std::string truncated = single_thread_buffer.str().substr ( 0, single_thread_buffer.str().size() - 4 );
+    std::istringstream truncated_in ( truncated );
+    EXPECT_THROW ( ues::pf::path_database<2>::load ( truncated_in ), ues::exc::exception );
+}
+
+
+TEST ( pf, path_database_attached_points )
+{
+    // The database is built from the obstacles only, and the free points are attached to it by
+    // their coordinates. The reference graph also contains the free points, so its indices
+    // differ from those of the database.
+    const ues::geom::point<2> origin ( -1, -1 ), target ( 12, 11 );
+    ues::pf::vg2d::scenario obstacle_scenario = path_database_test_scenario ( {} );
+    ues::pf::vg2d::scenario reference_scenario = path_database_test_scenario ( { target, origin } );
+
+    ues::pf::vg2d::visibility_graph_generator obstacle_generator ( obstacle_scenario.get_shared_points() );
+    std::shared_ptr< ues::pf::vg2d::visibility_graph > obstacle_graph = obstacle_generator.generate_visibility_graph ( obstacle_scenario.get_shared_segments(),
+                                                                                                                      obstacle_scenario.get_shared_polygons() );
+    ues::pf::vg2d::visibility_graph_generator reference_generator ( reference_scenario.get_shared_points() );
+    std::shared_ptr< ues::pf::vg2d::visibility_graph > reference_graph = reference_generator.generate_visibility_graph ( reference_scenario.get_shared_segments(),
+                                                                                                                        reference_scenario.get_shared_polygons() );
+    ues::pf::graph_pathfinder<2> finder ( reference_graph );
+    ues::pf::vg2d::rotational_sweep obstacles ( obstacle_scenario );
+    ues::pf::path_database<2> database ( *obstacle_graph );
+
+    // Queries between free points, from a vertex of the obstacles and to it.
+    ASSERT_FALSE ( obstacles.check_visibility ( origin, target ) );
+    const ues::geom::point<2> & vertex = obstacle_scenario.get_points() [5];
+    for ( const std::pair< ues::geom::point<2>, ues::geom::point<2> > & query : { std::make_pair ( origin, target ),
+            std::make_pair ( vertex, target ), std::make_pair ( origin, vertex ) } )
+    {
+        ues::pf::path<2> result = database.find_path ( obstacles, query.first, query.second );
+        EXPECT_EQ ( query.first, result.front() );
+        EXPECT_EQ ( query.second, result.back() );
+        for ( ues::pf::path<2>::size_type i = 1; i < result.size(); ++i )
+        {
+            EXPECT_TRUE ( obstacles.check_visibility ( result[i - 1], result[i] ) );
+        }
+        EXPECT_NEAR ( finder.find_path ( query.first, query.second ).length(), result.length(), 1e-9 );
+    }
+
+    // Free points that see each other are joined directly.
+    const ues::geom::point<2> below_origin ( -1, -2 );
+    EXPECT_EQ ( ues::pf::path<2> ( { origin, below_origin } ), database.find_path ( obstacles, origin, below_origin ) );
+
+    // Points that only see vertices out of the database cannot be attached.
+    ues::pf::vg2d::rotational_sweep other_obstacles ( quadrilateral_grid_scenario ( 1, 1, [] ( unsigned int, unsigned int, quadrilateral_corners & corners )
+    {
+        corners = { { { 20, 20 }, { 20, 22 }, { 22, 22 }, { 22, 20 } } };
+        return true;
+    } ) );
+    EXPECT_THROW ( database.find_path ( other_obstacles, { 18, 21 }, { 24, 21 } ), ues::exc::exception );
+}
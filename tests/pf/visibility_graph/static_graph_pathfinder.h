@@ -0,0 +1,181 @@
+/*
+ * Copyright 2015-2017 Guillermo Frontera <guillermo.frontera@upm.es>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include "gtest/gtest.h"
+
+#include <chrono>
+#include <memory>
+#include <random>
+
+#include <env/environment.h>
+#include <pf/visibility_graph/graph_pathfinder.h>
+#include <pf/visibility_graph/landmark_heuristic.h>
+#include <pf/visibility_graph/static_graph_pathfinder.h>
+#include <pf/visibility_graph_3d/visibility_graph_generator.h>
+#include <tests/pf/square_grid.h>
+
+namespace
+{
+
+/** Generates a grid of randomly sized and placed box obstacles of random heights. */
+ues::env::obstacle_vector static_search_test_obstacles ( int grid_size, std::mt19937 & generator )
+{
+    std::uniform_real_distribution<ues::math::numeric_type> uniform ( 0, 1 );
+    ues::env::obstacle_vector obstacles;
+    for ( int i = 0; i < grid_size; ++i )
+    {
+        for ( int j = 0; j < grid_size; ++j )
+        {
+            const quadrilateral_corners corners = random_square_in_cell ( i, j, 10, generator );
+            obstacles.push_back ( ues::env::obstacle ( { corners[0], corners[1], corners[2], corners[3] }, 1 + 9 * uniform ( generator ) ) );
+        }
+    }
+    return obstacles;
+}
+
+
+/** Generates the visibility graph of a grid of \a grid_size x \a grid_size random boxes, and
+ * \a number_of_queries queries: one across the grid, and random pairs of points of the graph,
+ * which may not be connected. */
+std::shared_ptr< ues::pf::vg3d::visibility_graph > static_search_test_graph ( int grid_size,
+                                                                             unsigned int number_of_queries,
+                                                                             std::mt19937 & generator,
+                                                                             ues::pf::graph_pathfinder<3>::query_vector & queries )
+{
+    ues::env::obstacle_vector obstacles = static_search_test_obstacles ( grid_size, generator );
+    ues::geom::point<3> origin = { -5, 1, 0 };
+    const ues::math::numeric_type grid_length = grid_size * 10;
+    ues::geom::point<3> target = { grid_length + 5, grid_length - 1, 3 };
+    std::shared_ptr< ues::pf::vg3d::visibility_graph > vg = ues::pf::vg3d::visibility_graph_generator::generate_visibility_graph ( obstacles, origin, target );
+
+    std::uniform_int_distribution<std::size_t> random_point ( 0, vg->size() - 1 );
+    queries = { { origin, target } };
+    while ( queries.size() < number_of_queries )
+    {
+        queries.push_back ( { vg->point_at ( random_point ( generator ) ), vg->point_at ( random_point ( generator ) ) } );
+    }
+    return vg;
+}
+
+
+/** Runs \a fn ( query ), returning false if it throws. */
+template<class F>
+bool run_query ( F && fn, const ues::pf::graph_pathfinder<3>::query & q, ues::pf::path<3> & result )
+{
+    try
+    {
+        result = fn ( q );
+        return true;
+    }
+    catch ( ues::exc::exception & )
+    {
+        return false;
+    }
+}
+
+}
+
+
+TEST ( pf, static_graph_pathfinder )
+{
+    std::mt19937 generator ( 7 );
+    ues::pf::graph_pathfinder<3>::query_vector queries;
+    std::shared_ptr< ues::pf::vg3d::visibility_graph > vg = static_search_test_graph ( 3, 25, generator, queries );
+    ues::pf::graph_pathfinder<3> virtual_finder ( vg );
+    ues::pf::static_graph_pathfinder< 3, ues::pf::vg3d::visibility_graph > static_finder ( vg );
+    std::shared_ptr< const ues::pf::landmark_heuristic<3> > landmarks = std::make_shared< ues::pf::landmark_heuristic<3> > ( *vg, 4 );
+
+    // Both pathfinders run the same search, so they must find the very same paths, with every
+    // combination of edge evaluation, heuristic weight and landmarks.
+    ues::pf::search_workspace<3> workspace;
+    std::size_t found_paths = 0;
+    for ( ues::pf::graph_pathfinder<3>::edge_evaluation evaluation : { ues::pf::graph_pathfinder<3>::EAGER_EVALUATION, ues::pf::graph_pathfinder<3>::LAZY_EVALUATION } )
+    {
+        for ( ues::math::numeric_type weight : { 1.0, 1.5 } )
+        {
+            for ( bool with_landmarks : { false, true } )
+            {
+                virtual_finder.set_edge_evaluation ( evaluation );
+                static_finder.set_edge_evaluation ( evaluation );
+                virtual_finder.set_heuristic_weight ( weight );
+                static_finder.set_heuristic_weight ( weight );
+                virtual_finder.set_landmark_heuristic ( with_landmarks ? landmarks : nullptr );
+                static_finder.set_landmark_heuristic ( with_landmarks ? landmarks : nullptr );
+
+                for ( const ues::pf::graph_pathfinder<3>::query & q : queries )
+                {
+                    ues::pf::path<3> virtual_path, static_path;
+                    const bool virtual_found = run_query ( [&] ( const ues::pf::graph_pathfinder<3>::query & q )
+                    {
+                        return virtual_finder.find_path ( q.first, q.second, workspace );
+                    }, q, virtual_path );
+                    const bool static_found = run_query ( [&] ( const ues::pf::graph_pathfinder<3>::query & q )
+                    {
+                        return static_finder.find_path ( q.first, q.second, workspace );
+                    }, q, static_path );
+
+                    ASSERT_EQ ( virtual_found, static_found );
+                    EXPECT_EQ ( virtual_path, static_path );
+                    found_paths += virtual_found;
+                }
+            }
+        }
+    }
+    EXPECT_LT ( 0u, found_paths );
+
+    EXPECT_THROW ( static_finder.set_heuristic_weight ( 0.5 ), ues::exc::exception );
+    EXPECT_THROW ( ( ues::pf::static_graph_pathfinder< 3, ues::pf::vg3d::visibility_graph > ( nullptr ) ), ues::exc::exception );
+}
+
+
+TEST ( pf, DISABLED_static_graph_pathfinder_benchmark )
+{
+    typedef std::chrono::steady_clock clock;
+
+    std::mt19937 generator ( 7 );
+    ues::pf::graph_pathfinder<3>::query_vector queries;
+    std::shared_ptr< ues::pf::vg3d::visibility_graph > vg = static_search_test_graph ( 5, 200, generator, queries );
+    ues::pf::graph_pathfinder<3> virtual_finder ( vg );
+    ues::pf::static_graph_pathfinder< 3, ues::pf::vg3d::visibility_graph > static_finder ( vg );
+
+    ues::pf::search_workspace<3> workspace;
+    clock::duration virtual_time = clock::duration::zero(), static_time = clock::duration::zero();
+    std::size_t found_paths = 0;
+    for ( const ues::pf::graph_pathfinder<3>::query & q : queries )
+    {
+        ues::pf::path<3> result;
+        clock::time_point start = clock::now();
+        found_paths += run_query ( [&] ( const ues::pf::graph_pathfinder<3>::query & q )
+        {
+            return virtual_finder.find_path ( q.first, q.second, workspace );
+        }, q, result );
+        virtual_time += clock::now() - start;
+
+        start = clock::now();
+        run_query ( [&] ( const ues::pf::graph_pathfinder<3>::query & q )
+        {
+            return static_finder.find_path ( q.first, q.second, workspace );
+        }, q, result );
+        static_time += clock::now() - start;
+    }
+
+    RecordProperty ( "points", static_cast< int > ( vg->size() ) );
+    RecordProperty ( "queries", static_cast< int > ( queries.size() ) );
+    RecordProperty ( "connected_queries", static_cast< int > ( found_paths ) );
+    RecordProperty ( "virtual_us", static_cast< int > ( std::chrono::duration_cast<std::chrono::microseconds> ( virtual_time ).count() ) );
+    RecordProperty ( "static_us", static_cast< int > ( std::chrono::duration_cast<std::chrono::microseconds> ( static_time ).count() ) );
+}
@@ -26,7 +26,7 @@ TEST ( pf, envelope )
 
     std::vector< envelope::segment_data > sd = { { 0, 2 }, { 1, 3 }, { 2, 3 } };
 
-    envelope env ( 4 );
+    envelope env;
     ASSERT_TRUE ( env.empty() ) << "Envelope is not created empty.";
 
     envelope::iterator it = env.shortest_as_long_as ( sd[0] );
@@ -48,3 +48,33 @@ TEST ( pf, envelope )
     env.erase ( it2 );
     ASSERT_EQ ( *env.head(), sd[2] ) << "Incorrect content after third insertion.";
 }
+
+
+TEST ( pf, envelope_reused )
+{
+    using namespace ues::pf::vg2d;
+
+    // The segments of one origin are swept, and the envelope is cleared for the next one, whose
+    // segments have the same ranks. It must behave as a new envelope.
+    std::vector< envelope::segment_data > first_origin = { { 0, 1 }, { 1, 3 }, { 2, 0 } };
+    std::vector< envelope::segment_data > second_origin = { { 5, 1 }, { 3, 3 }, { 4, 0 } };
+
+    envelope env;
+    for ( const std::vector< envelope::segment_data > & sd : { first_origin, second_origin } )
+    {
+        env.clear();
+        ASSERT_TRUE ( env.empty() );
+        ASSERT_TRUE ( env.shortest_as_long_as ( sd[0] ) == env.shortest_as_long_as ( sd[1] ) );
+
+        for ( const envelope::segment_data & s : sd )
+        {
+            env.insert ( s, env.pred ( env.shortest_as_long_as ( s ) ) );
+        }
+        // Rank 0 is in the shortest group, then rank 1, and rank 3 in the longest one.
+        ASSERT_EQ ( sd[2], *env.head() );
+        env.erase ( env.head() );
+        ASSERT_EQ ( sd[0], *env.head() );
+        env.erase ( env.head() );
+        ASSERT_EQ ( sd[1], *env.head() );
+    }
+}
@@ -0,0 +1,118 @@
+/*
+ * Copyright 2015-2017 Guillermo Frontera <guillermo.frontera@upm.es>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include "gtest/gtest.h"
+
+#include <cmath>
+
+#include <pf/visibility_graph_2d/rotational_sweep/rotational_sweep.h>
+#include <pf/visibility_graph_2d/visibility_graph_generator.h>
+#include <pf/visibility_graph_2d/util/scenario.h>
+#include <tests/pf/square_grid.h>
+
+
+TEST ( pf, rotational_sweep )
+{
+    // Two clockwise squares, a clockwise L-shaped polygon and several free points around them.
+    ues::pf::vg2d::scenario current_scenario ( ues::pf::vg2d::point_vector { { 1, 1 }, { 1, 3 }, { 3, 3 }, { 3, 1 },
+                                                                             { 4, -2 }, { 4, 0 }, { 6, 0 }, { 6, -2 },
+                                                                             { 10, 0 }, { 10, 4 }, { 12, 4 }, { 12, 2 }, { 14, 2 }, { 14, 0 },
+                                                                             { 0, 0 }, { 8, 2 }, { 16, 5 }, { 11, -3 }, { 13, 6 }, { -2, 5 }, { 9, 5 }, { 13.5, 3 } },
+    ues::pf::vg2d::segment_vector { { 0, 1 }, { 1, 2 }, { 2, 3 }, { 3, 0 }, { 4, 5 }, { 5, 6 }, { 6, 7 }, { 7, 4 },
+                                    { 8, 9 }, { 9, 10 }, { 10, 11 }, { 11, 12 }, { 12, 13 }, { 13, 8 } },
+    ues::pf::vg2d::polygon_vector { { 0, 1, 2, 3 }, { 4, 5, 6, 7 }, { 8, 9, 10, 11, 12, 13 } } );
+    const ues::pf::vg2d::point_vector & points = current_scenario.get_points();
+
+    ues::pf::vg2d::visibility_graph_generator graph_generator ( current_scenario.get_shared_points() );
+    std::shared_ptr< ues::pf::vg2d::visibility_graph > vg = graph_generator.generate_visibility_graph ( current_scenario.get_shared_segments(),
+                                                                                                        current_scenario.get_shared_polygons() );
+
+    // Whether there is a third point between the points of indices i and j. The generator
+    // does not see past such points, while the sweep only stops at polygons.
+    auto aligned = [&points] ( ues::pf::vg2d::point_index i, ues::pf::vg2d::point_index j )
+    {
+        for ( ues::pf::vg2d::point_index k = 0; k < points.size(); ++k )
+        {
+            if ( k != i && k != j &&
+                 std::abs ( points[i].distance_to ( points[k] ) + points[k].distance_to ( points[j] ) - points[i].distance_to ( points[j] ) ) < ues::math::epsilon )
+                return true;
+        }
+        return false;
+    };
+
+    // The sweep from every point sees the same points as the visibility graph.
+    ues::pf::vg2d::rotational_sweep sweep ( current_scenario );
+    std::vector< bool > visible;
+    ues::math::numeric_type dummy_distance;
+    for ( ues::pf::vg2d::point_index i = 0; i < points.size(); ++i )
+    {
+        sweep.compute_visibility ( points[i], ues::pf::vg2d::point_vector(), visible );
+        ASSERT_EQ ( points.size(), visible.size() );
+        for ( ues::pf::vg2d::point_index j = 0; j < points.size(); ++j )
+        {
+            if ( i != j && !aligned ( i, j ) )
+            {
+                EXPECT_EQ ( vg->check_visibility ( points[i], points[j], dummy_distance ), visible[j] ) << "From " << i << " to " << j;
+            }
+        }
+        EXPECT_FALSE ( visible[i] );
+    }
+
+    // The extra points are placed after the points of the scenario.
+    sweep.compute_visibility ( { 2, 0 }, ues::pf::vg2d::point_vector { { 2, 4 }, { 2, -1 } }, visible );
+    ASSERT_EQ ( points.size() + 2, visible.size() );
+    EXPECT_FALSE ( visible[points.size()] );
+    EXPECT_TRUE ( visible[points.size() + 1] );
+}
+
+
+TEST ( pf, rotational_sweep_check_visibility )
+{
+    // A grid of squares, where many lines between points run along sides and through corners,
+    // and a clockwise L-shaped polygon. Some free points lie inside the polygons.
+    ues::pf::vg2d::point_vector free_points { { -0.5, -0.5 }, { 0.4, 0.4 }, { 0.5, 0.5 }, { 2.2, 1.2 }, { 4.4, 1.0 } };
+    ues::pf::vg2d::scenario grid_scenario = quadrilateral_grid_scenario ( 4, 3, [] ( unsigned int i, unsigned int j, quadrilateral_corners & corners )
+    {
+        corners = { { { 1.0 * i, 1.0 * j }, { 1.0 * i, j + 0.8 }, { i + 0.8, j + 0.8 }, { i + 0.8, 1.0 * j } } };
+        return true;
+    }, free_points );
+    ues::pf::vg2d::scenario l_scenario ( ues::pf::vg2d::point_vector { { 10, 0 }, { 10, 4 }, { 12, 4 }, { 12, 2 }, { 14, 2 }, { 14, 0 },
+                                                                       { 11, 1 }, { 8, 2 }, { 13, 3 }, { 9, 5 }, { 16, -2 } },
+    ues::pf::vg2d::segment_vector { { 0, 1 }, { 1, 2 }, { 2, 3 }, { 3, 4 }, { 4, 5 }, { 5, 0 } },
+    ues::pf::vg2d::polygon_vector { { 0, 1, 2, 3, 4, 5 } } );
+
+    // A single pair gets the same answer as the sweep around the first point, with the second
+    // one as an extra point.
+    for ( const ues::pf::vg2d::scenario * current_scenario : { &grid_scenario, &l_scenario } )
+    {
+        const ues::pf::vg2d::point_vector & points = current_scenario->get_points();
+        ues::pf::vg2d::rotational_sweep sweep ( *current_scenario );
+        std::vector< bool > visible;
+        for ( const ues::geom::point<2> & p1 : points )
+        {
+            for ( const ues::geom::point<2> & p2 : points )
+            {
+                if ( p1 != p2 )
+                {
+                    sweep.compute_visibility ( p1, ues::pf::vg2d::point_vector { p2 }, visible );
+                    EXPECT_EQ ( visible.back(), sweep.check_visibility ( p1, p2 ) ) << "From " << p1 << " to " << p2;
+                }
+            }
+        }
+        EXPECT_TRUE ( sweep.check_visibility ( points[0], points[0] ) );
+    }
+}
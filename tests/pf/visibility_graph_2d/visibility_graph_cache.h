@@ -0,0 +1,176 @@
+/*
+ * Copyright 2015-2017 Guillermo Frontera <guillermo.frontera@upm.es>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include "gtest/gtest.h"
+
+#include <cstdio>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include <pf/visibility_graph_2d/visibility_graph_cache.h>
+#include <pf/visibility_graph_2d/visibility_graph_generator.h>
+#include <pf/visibility_graph_2d/util/scenario.h>
+
+namespace
+{
+
+/** Two clockwise squares and two free points. */
+ues::pf::vg2d::scenario cache_test_scenario()
+{
+    return ues::pf::vg2d::scenario ( ues::pf::vg2d::point_vector { { 1, 1 }, { 1, 3 }, { 3, 3 }, { 3, 1 },
+                                                                   { 4, -2 }, { 4, 0 }, { 6, 0 }, { 6, -2 },
+                                                                   { 0, 0 }, { 8, 2 } },
+                                     ues::pf::vg2d::segment_vector { { 0, 1 }, { 1, 2 }, { 2, 3 }, { 3, 0 }, { 4, 5 }, { 5, 6 }, { 6, 7 }, { 7, 4 } },
+                                     ues::pf::vg2d::polygon_vector { { 0, 1, 2, 3 }, { 4, 5, 6, 7 } } );
+}
+
+
+/** Returns the lines of the index of the graphs cached in the current directory. */
+std::vector< std::string > cache_index_lines()
+{
+    std::ifstream in ( "visibility_graphs.index" );
+    std::vector< std::string > result;
+    for ( std::string line; std::getline ( in, line ); )
+    {
+        result.push_back ( line );
+    }
+    return result;
+}
+
+}
+
+
+TEST ( pf, visibility_graph_cache )
+{
+    ues::pf::vg2d::visibility_graph_cache cache;
+
+    ues::pf::vg2d::scenario current_scenario = cache_test_scenario();
+    ues::pf::vg2d::visibility_graph_generator generator ( current_scenario.get_shared_points() );
+    std::shared_ptr< const ues::pf::vg2d::visibility_graph > first = cache.get_visibility_graph ( generator, current_scenario.get_shared_segments(), current_scenario.get_shared_polygons() );
+    EXPECT_EQ ( 1u, cache.get_counters().misses );
+    EXPECT_LT ( 0u, cache.get_memory_size() );
+
+    // The graph is found by the contents of another copy of the scenario.
+    ues::pf::vg2d::scenario copied_scenario = cache_test_scenario();
+    ues::pf::vg2d::visibility_graph_generator copied_generator ( copied_scenario.get_shared_points() );
+    EXPECT_EQ ( first, cache.get_visibility_graph ( copied_generator, copied_scenario.get_shared_segments(), copied_scenario.get_shared_polygons() ) );
+    EXPECT_EQ ( 1u, cache.get_counters().memory_hits );
+
+    // The selected edges are part of the scenario.
+    copied_generator.set_edge_selection ( ues::pf::vg2d::visibility_graph_generator::BITANGENT_EDGES );
+    EXPECT_NE ( first, cache.get_visibility_graph ( copied_generator, copied_scenario.get_shared_segments(), copied_scenario.get_shared_polygons() ) );
+    EXPECT_EQ ( 2u, cache.get_counters().misses );
+
+    // So is the algorithm, since the occluding segments it reports may differ.
+    copied_generator.set_edge_selection ( ues::pf::vg2d::visibility_graph_generator::ALL_EDGES );
+    copied_generator.set_algorithm ( ues::pf::vg2d::visibility_graph_generator::ROTATIONAL_SWEEP_ALGORITHM );
+    EXPECT_NE ( first, cache.get_visibility_graph ( copied_generator, copied_scenario.get_shared_segments(), copied_scenario.get_shared_polygons() ) );
+    EXPECT_EQ ( 3u, cache.get_counters().misses );
+
+    // Without memory, all the graphs are evicted.
+    cache.set_memory_budget ( 0 );
+    EXPECT_EQ ( 0u, cache.get_memory_size() );
+    EXPECT_EQ ( 3u, cache.get_counters().evictions );
+    cache.get_visibility_graph ( generator, current_scenario.get_shared_segments(), current_scenario.get_shared_polygons() );
+    EXPECT_EQ ( 4u, cache.get_counters().misses );
+}
+
+
+TEST ( pf, visibility_graph_cache_directory )
+{
+    ues::pf::vg2d::scenario current_scenario = cache_test_scenario();
+    const ues::pf::vg2d::point_vector & points = current_scenario.get_points();
+    ues::pf::vg2d::visibility_graph_generator generator ( current_scenario.get_shared_points() );
+
+    std::shared_ptr< const ues::pf::vg2d::visibility_graph > generated;
+    {
+        ues::pf::vg2d::visibility_graph_cache cache;
+        cache.set_directory ( ".", 1 << 20 );
+        generated = cache.get_visibility_graph ( generator, current_scenario.get_shared_segments(), current_scenario.get_shared_polygons() );
+        EXPECT_LT ( 0u, cache.get_disk_size() );
+    }
+
+    // Another cache reads the graph from the directory.
+    ues::pf::vg2d::visibility_graph_cache cache;
+    cache.set_directory ( ".", 1 << 20 );
+    std::shared_ptr< const ues::pf::vg2d::visibility_graph > loaded = cache.get_visibility_graph ( generator, current_scenario.get_shared_segments(), current_scenario.get_shared_polygons() );
+    EXPECT_EQ ( 1u, cache.get_counters().disk_hits );
+    EXPECT_EQ ( 0u, cache.get_counters().misses );
+
+    for ( const ues::geom::point<2> & p : points )
+    {
+        for ( const ues::geom::point<2> & q : points )
+        {
+            ues::math::numeric_type generated_distance = -1, loaded_distance = -1;
+            EXPECT_EQ ( generated->check_visibility ( p, q, generated_distance ), loaded->check_visibility ( p, q, loaded_distance ) );
+            EXPECT_EQ ( generated_distance, loaded_distance );
+
+            ues::pf::vg2d::segment_index generated_segment = 0, loaded_segment = 0;
+            EXPECT_EQ ( generated->check_occlusion_segment ( p, q, generated_segment ), loaded->check_occlusion_segment ( p, q, loaded_segment ) );
+            EXPECT_EQ ( generated_segment, loaded_segment );
+        }
+    }
+
+    // Without room in the directory, the files are removed.
+    cache.set_directory ( ".", 0 );
+    EXPECT_EQ ( 0u, cache.get_disk_size() );
+    EXPECT_EQ ( 1u, cache.get_counters().evictions );
+    std::remove ( "visibility_graphs.index" );
+}
+
+
+TEST ( pf, visibility_graph_cache_index )
+{
+    ues::pf::vg2d::scenario current_scenario = cache_test_scenario();
+    ues::pf::vg2d::visibility_graph_generator generator ( current_scenario.get_shared_points() );
+    ues::pf::vg2d::visibility_graph_generator bitangent_generator ( current_scenario.get_shared_points() );
+    bitangent_generator.set_edge_selection ( ues::pf::vg2d::visibility_graph_generator::BITANGENT_EDGES );
+    ues::pf::vg2d::point_vector other_points = current_scenario.get_points();
+    other_points.push_back ( { 9, 9 } );
+    ues::pf::vg2d::visibility_graph_generator other_generator ( std::make_shared< const ues::pf::vg2d::point_vector > ( std::move ( other_points ) ) );
+
+    // Graphs left by other runs are removed first.
+    {
+        ues::pf::vg2d::visibility_graph_cache cache;
+        cache.set_directory ( ".", 0 );
+        cache.set_directory ( ".", 1 << 20 );
+        cache.get_visibility_graph ( generator, current_scenario.get_shared_segments(), current_scenario.get_shared_polygons() );
+        cache.get_visibility_graph ( bitangent_generator, current_scenario.get_shared_segments(), current_scenario.get_shared_polygons() );
+    }
+    const std::vector< std::string > stored = cache_index_lines();
+    ASSERT_EQ ( 2u, stored.size() );
+
+    // Reading a graph from the directory does not rewrite the index, but its new order is saved
+    // along with the next graph stored.
+    ues::pf::vg2d::visibility_graph_cache cache;
+    cache.set_directory ( ".", 1 << 20 );
+    cache.get_visibility_graph ( generator, current_scenario.get_shared_segments(), current_scenario.get_shared_polygons() );
+    EXPECT_EQ ( 1u, cache.get_counters().disk_hits );
+    EXPECT_EQ ( stored, cache_index_lines() );
+
+    cache.get_visibility_graph ( other_generator, current_scenario.get_shared_segments(), current_scenario.get_shared_polygons() );
+    const std::vector< std::string > updated = cache_index_lines();
+    ASSERT_EQ ( 3u, updated.size() );
+    EXPECT_EQ ( stored[1], updated[1] );
+    EXPECT_EQ ( stored[0], updated[2] );
+
+    cache.set_directory ( ".", 0 );
+    EXPECT_EQ ( 3u, cache.get_counters().evictions );
+    EXPECT_TRUE ( cache_index_lines().empty() );
+    std::remove ( "visibility_graphs.index" );
+}
@@ -17,8 +17,81 @@
 
 #include "gtest/gtest.h"
 
+#include <chrono>
+#include <cstdint>
+#include <random>
+#include <sstream>
+
+#include <pf/visibility_graph/graph_pathfinder.h>
 #include <pf/visibility_graph_2d/visibility_graph_generator.h>
 #include <pf/visibility_graph_2d/util/scenario.h>
+#include <tests/pf/square_grid.h>
+
+namespace
+{
+
+/** Builds a scenario with a grid of \a size by \a size cells, most of which contain a random
+ * clockwise quadrilateral. */
+ues::pf::vg2d::scenario random_quadrilaterals_scenario ( unsigned int size, unsigned int seed )
+{
+    std::mt19937 generator ( seed );
+    std::uniform_real_distribution< ues::math::numeric_type > random ( 0, 1 );
+    return quadrilateral_grid_scenario ( size, size, [&] ( unsigned int i, unsigned int j, quadrilateral_corners & corners )
+    {
+        if ( random ( generator ) < 0.3 )
+            return false;
+
+        const double x = i * 10 + 1 + random ( generator ) * 3, y = j * 10 + 1 + random ( generator ) * 3;
+        const double width = 2 + random ( generator ) * 4, height = 2 + random ( generator ) * 4;
+        const double top = x + width * random ( generator ), right = y + height * random ( generator );
+        corners = { { { x, y }, { top, y + height }, { x + width, y + height }, { x + width, right } } };
+        return true;
+    } );
+}
+
+
+/** Returns the graph of \a current_scenario generated with \a algorithm. */
+std::shared_ptr< ues::pf::vg2d::visibility_graph >
+generate_with_algorithm ( const ues::pf::vg2d::scenario & current_scenario,
+                          ues::pf::vg2d::visibility_graph_generator::visibility_algorithm algorithm )
+{
+    ues::pf::vg2d::visibility_graph_generator graph_generator ( current_scenario.get_shared_points() );
+    graph_generator.set_algorithm ( algorithm );
+    EXPECT_EQ ( algorithm, graph_generator.get_algorithm() );
+    return graph_generator.generate_visibility_graph ( current_scenario.get_shared_segments(), current_scenario.get_shared_polygons() );
+}
+
+
+/** Returns an FNV-1a hash of the visibility and the occluding segment of every pair of
+ * \a points in \a vg. */
+std::uint64_t visibility_digest ( const ues::pf::vg2d::visibility_graph & vg, const ues::pf::vg2d::point_vector & points )
+{
+    std::uint64_t digest = 14695981039346656037ull;
+    auto mix = [&digest] ( std::uint64_t value )
+    {
+        digest ^= value;
+        digest *= 1099511628211ull;
+    };
+
+    ues::math::numeric_type distance;
+    ues::pf::vg2d::segment_index segment;
+    for ( const ues::geom::point<2> & p1 : points )
+    {
+        for ( const ues::geom::point<2> & p2 : points )
+        {
+            mix ( vg.check_visibility ( p1, p2, distance ) );
+            const bool occluded = vg.check_occlusion_segment ( p1, p2, segment );
+            mix ( occluded );
+            if ( occluded )
+            {
+                mix ( segment );
+            }
+        }
+    }
+    return digest;
+}
+
+}
 
 
 TEST ( pf, visibility_graph_generator_simple )
@@ -53,3 +126,208 @@ TEST ( pf, visibility_graph_generator_one_point )
                                                                                                         current_scenario.get_shared_polygons() );
 }
 
+
+TEST ( pf, visibility_graph_generator_bitangent_edges )
+{
+    // Two clockwise squares and a clockwise L-shaped polygon, whose vertex (12,2), index 11,
+    // is reflex, and several free points around them.
+    ues::pf::vg2d::scenario current_scenario ( ues::pf::vg2d::point_vector { { 1, 1 }, { 1, 3 }, { 3, 3 }, { 3, 1 },
+                                                                             { 4, -2 }, { 4, 0 }, { 6, 0 }, { 6, -2 },
+                                                                             { 10, 0 }, { 10, 4 }, { 12, 4 }, { 12, 2 }, { 14, 2 }, { 14, 0 },
+                                                                             { 0, 0 }, { 8, 2 }, { 16, 5 }, { 11, -3 }, { 13, 6 }, { -2, 5 }, { 9, 5 }, { 13.5, 3 } },
+    ues::pf::vg2d::segment_vector { { 0, 1 }, { 1, 2 }, { 2, 3 }, { 3, 0 }, { 4, 5 }, { 5, 6 }, { 6, 7 }, { 7, 4 },
+                                    { 8, 9 }, { 9, 10 }, { 10, 11 }, { 11, 12 }, { 12, 13 }, { 13, 8 } },
+    ues::pf::vg2d::polygon_vector { { 0, 1, 2, 3 }, { 4, 5, 6, 7 }, { 8, 9, 10, 11, 12, 13 } } );
+    const ues::pf::vg2d::point_vector & points = current_scenario.get_points();
+
+    ues::pf::vg2d::visibility_graph_generator graph_generator ( current_scenario.get_shared_points() );
+    std::shared_ptr< ues::pf::vg2d::visibility_graph > full_graph = graph_generator.generate_visibility_graph ( current_scenario.get_shared_segments(),
+                                                                                                                current_scenario.get_shared_polygons() );
+    graph_generator.set_edge_selection ( ues::pf::vg2d::visibility_graph_generator::BITANGENT_EDGES );
+    std::shared_ptr< ues::pf::vg2d::visibility_graph > reduced_graph = graph_generator.generate_visibility_graph ( current_scenario.get_shared_segments(),
+                                                                                                                   current_scenario.get_shared_polygons() );
+
+    unsigned int full_edges = 0, reduced_edges = 0;
+    ues::math::numeric_type distance;
+    for ( const ues::geom::point<2> & p1 : points )
+    {
+        for ( const ues::geom::point<2> & p2 : points )
+        {
+            bool full = full_graph->check_visibility ( p1, p2, distance );
+            bool reduced = reduced_graph->check_visibility ( p1, p2, distance );
+            full_edges += full;
+            reduced_edges += reduced;
+            // The reduced graph is a subgraph of the complete one.
+            EXPECT_TRUE ( full || !reduced );
+        }
+    }
+    EXPECT_LT ( reduced_edges, full_edges );
+
+    // The reflex vertex is not connected to anything.
+    for ( const ues::geom::point<2> & p : points )
+    {
+        EXPECT_FALSE ( p != points[11] && reduced_graph->check_visibility ( points[11], p, distance ) );
+    }
+
+    ues::pf::graph_pathfinder<2> full_finder ( full_graph );
+    ues::pf::graph_pathfinder<2> reduced_finder ( reduced_graph );
+    for ( ues::pf::vg2d::point_index i = 14; i < points.size(); ++i )
+    {
+        for ( ues::pf::vg2d::point_index j = 14; j < points.size(); ++j )
+        {
+            EXPECT_NEAR ( full_finder.find_path ( points[i], points[j] ).length(), reduced_finder.find_path ( points[i], points[j] ).length(), ues::math::epsilon );
+        }
+    }
+}
+
+
+TEST ( pf, visibility_graph_generator_parallel )
+{
+    // A grid of clockwise squares, with more points than a batch of a few threads.
+    ues::pf::vg2d::scenario current_scenario = quadrilateral_grid_scenario ( 6, 6, [] ( unsigned int i, unsigned int j, quadrilateral_corners & corners )
+    {
+        const double x = 4.0 * i + 0.5 * ( j % 3 ), y = 4.0 * j + 0.25 * ( i % 2 );
+        corners = { { { x, y }, { x, y + 2 }, { x + 2, y + 2 }, { x + 2, y } } };
+        return true;
+    } );
+
+    // The graphs, edges and occluding segments included, do not depend on the number of
+    // threads.
+    std::string expected;
+    for ( unsigned int number_of_threads : { 1u, 3u, 0u } )
+    {
+        ues::pf::vg2d::visibility_graph_generator graph_generator ( current_scenario.get_shared_points() );
+        graph_generator.set_number_of_threads ( number_of_threads );
+        EXPECT_EQ ( number_of_threads, graph_generator.get_number_of_threads() );
+        std::shared_ptr< ues::pf::vg2d::visibility_graph > vg = graph_generator.generate_visibility_graph ( current_scenario.get_shared_segments(),
+                                                                                                            current_scenario.get_shared_polygons() );
+        std::ostringstream out;
+        vg->save ( out );
+        if ( number_of_threads == 1 )
+        {
+            expected = out.str();
+        }
+        else
+        {
+            EXPECT_EQ ( expected, out.str() );
+        }
+    }
+}
+
+
+TEST ( pf, visibility_graph_generator_algorithms )
+{
+    typedef ues::pf::vg2d::visibility_graph_generator generator;
+
+    // In general position, both algorithms generate the same edges and occluding segments.
+    ues::pf::vg2d::scenario current_scenario = random_quadrilaterals_scenario ( 6, 2 );
+    std::shared_ptr< ues::pf::vg2d::visibility_graph > envelope_graph = generate_with_algorithm ( current_scenario, generator::ENVELOPE_ALGORITHM );
+    std::shared_ptr< ues::pf::vg2d::visibility_graph > sweep_graph = generate_with_algorithm ( current_scenario, generator::ROTATIONAL_SWEEP_ALGORITHM );
+    std::ostringstream envelope_out, sweep_out;
+    envelope_graph->save ( envelope_out );
+    sweep_graph->save ( sweep_out );
+    EXPECT_EQ ( envelope_out.str(), sweep_out.str() );
+
+    // In a grid of squares, many points are aligned with sides and other points. The edges are
+    // still the same, and both algorithms find an occluding segment for the same points,
+    // although it may be a different one of those meeting at the point that blocks the view.
+    ues::pf::vg2d::scenario grid_scenario = quadrilateral_grid_scenario ( 5, 5, [] ( unsigned int i, unsigned int j, quadrilateral_corners & corners )
+    {
+        corners = { { { 1.0 * i, 1.0 * j }, { 1.0 * i, j + 0.8 }, { i + 0.8, j + 0.8 }, { i + 0.8, 1.0 * j } } };
+        return true;
+    }, { { -0.5, -0.5 }, { 0.4, 0.4 } } );
+    const ues::pf::vg2d::point_vector & grid_points = grid_scenario.get_points();
+    envelope_graph = generate_with_algorithm ( grid_scenario, generator::ENVELOPE_ALGORITHM );
+    sweep_graph = generate_with_algorithm ( grid_scenario, generator::ROTATIONAL_SWEEP_ALGORITHM );
+    ues::math::numeric_type distance;
+    for ( const ues::geom::point<2> & p1 : grid_points )
+    {
+        for ( const ues::geom::point<2> & p2 : grid_points )
+        {
+            EXPECT_EQ ( envelope_graph->check_visibility ( p1, p2, distance ), sweep_graph->check_visibility ( p1, p2, distance ) ) << p1 << " to " << p2;
+            ues::pf::vg2d::segment_index envelope_segment, sweep_segment;
+            EXPECT_EQ ( envelope_graph->check_occlusion_segment ( p1, p2, envelope_segment ), sweep_graph->check_occlusion_segment ( p1, p2, sweep_segment ) ) << p1 << " to " << p2;
+        }
+    }
+}
+
+
+TEST ( pf, visibility_graph_generator_envelope_regression )
+{
+    typedef ues::pf::vg2d::visibility_graph_generator generator;
+
+    // The digests were computed with the envelopes that looked up the segments of every rank in
+    // an unordered_multimap. The grid of squares has many segments meeting at the points that
+    // block the view, so it also checks which one of them is chosen.
+    const ues::pf::vg2d::scenario random_scenario = random_quadrilaterals_scenario ( 6, 7 );
+    const ues::pf::vg2d::scenario grid_scenario = quadrilateral_grid_scenario ( 5, 5, [] ( unsigned int i, unsigned int j, quadrilateral_corners & corners )
+    {
+        corners = { { { 1.0 * i, 1.0 * j }, { 1.0 * i, j + 0.8 }, { i + 0.8, j + 0.8 }, { i + 0.8, 1.0 * j } } };
+        return true;
+    }, { { -0.5, -0.5 }, { 0.4, 0.4 } } );
+    const struct
+    {
+        const ues::pf::vg2d::scenario & current_scenario;
+        generator::edge_selection selection;
+        std::uint64_t digest;
+    } cases[] = { { random_scenario, generator::ALL_EDGES, 12727012390118948139ull },
+                  { random_scenario, generator::BITANGENT_EDGES, 9917243150662690047ull },
+                  { grid_scenario, generator::ALL_EDGES, 5885818122430219241ull },
+                  { grid_scenario, generator::BITANGENT_EDGES, 13046793610980570161ull } };
+
+    for ( const auto & c : cases )
+    {
+        generator graph_generator ( c.current_scenario.get_shared_points() );
+        graph_generator.set_algorithm ( generator::ENVELOPE_ALGORITHM );
+        graph_generator.set_edge_selection ( c.selection );
+        std::shared_ptr< ues::pf::vg2d::visibility_graph > vg = graph_generator.generate_visibility_graph ( c.current_scenario.get_shared_segments(),
+                                                                                                            c.current_scenario.get_shared_polygons() );
+        EXPECT_EQ ( c.digest, visibility_digest ( *vg, c.current_scenario.get_points() ) ) << c.current_scenario.get_points().size() << " points";
+    }
+}
+
+
+TEST ( pf, visibility_graph_generator_automatic )
+{
+    typedef ues::pf::vg2d::visibility_graph_generator generator;
+
+    // The envelopes are the default algorithm, so the occluding segments do not change unless
+    // another one is selected.
+    ues::pf::vg2d::scenario current_scenario = random_quadrilaterals_scenario ( 4, 1 );
+    EXPECT_EQ ( generator::ENVELOPE_ALGORITHM, generator ( current_scenario.get_shared_points() ).get_algorithm() );
+
+    // Up to ROTATIONAL_SWEEP_MAX_POINTS points, the automatic algorithm is the rotational sweep.
+    for ( unsigned int size : { 4u, 8u, 12u } )
+    {
+        current_scenario = random_quadrilaterals_scenario ( size, 1 );
+        ASSERT_LE ( current_scenario.get_points().size(), generator::ROTATIONAL_SWEEP_MAX_POINTS );
+        std::ostringstream automatic_out, sweep_out;
+        generate_with_algorithm ( current_scenario, generator::AUTOMATIC_ALGORITHM )->save ( automatic_out );
+        generate_with_algorithm ( current_scenario, generator::ROTATIONAL_SWEEP_ALGORITHM )->save ( sweep_out );
+        EXPECT_EQ ( sweep_out.str(), automatic_out.str() ) << current_scenario.get_points().size() << " points";
+    }
+}
+
+
+TEST ( pf, DISABLED_visibility_graph_generator_crossover_benchmark )
+{
+    typedef ues::pf::vg2d::visibility_graph_generator generator;
+
+    // Times both algorithms, points sorting included, on growing scenarios on one thread. The
+    // automatic algorithm switches to the envelopes past ROTATIONAL_SWEEP_MAX_POINTS points.
+    for ( unsigned int size : { 4u, 10u, 20u } )
+    {
+        ues::pf::vg2d::scenario current_scenario = random_quadrilaterals_scenario ( size, 1 );
+        const std::string suffix = "_us_" + std::to_string ( current_scenario.get_points().size() ) + "_points";
+        for ( generator::visibility_algorithm algorithm : { generator::ENVELOPE_ALGORITHM, generator::ROTATIONAL_SWEEP_ALGORITHM } )
+        {
+            generator graph_generator ( current_scenario.get_shared_points() );
+            graph_generator.set_algorithm ( algorithm );
+            graph_generator.set_number_of_threads ( 1 );
+            const auto start = std::chrono::steady_clock::now();
+            graph_generator.generate_visibility_graph ( current_scenario.get_shared_segments(), current_scenario.get_shared_polygons() );
+            const std::chrono::duration< double, std::micro > elapsed = std::chrono::steady_clock::now() - start;
+            RecordProperty ( ( algorithm == generator::ENVELOPE_ALGORITHM ? "envelope" : "rotational_sweep" ) + suffix, static_cast< int > ( elapsed.count() ) );
+        }
+    }
+}
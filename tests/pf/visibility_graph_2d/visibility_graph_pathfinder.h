@@ -0,0 +1,54 @@
+/*
+ * Copyright 2015-2017 Guillermo Frontera <guillermo.frontera@upm.es>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include "gtest/gtest.h"
+
+#include <pf/visibility_graph_2d/visibility_graph_pathfinder.h>
+
+
+TEST ( pf, visibility_graph_pathfinder_reused )
+{
+    // Two clockwise squares and a clockwise L-shaped polygon.
+    const std::vector< ues::geom::polygon > obstacles { { { 1, 1 }, { 1, 3 }, { 3, 3 }, { 3, 1 } },
+                                                        { { 4, -2 }, { 4, 0 }, { 6, 0 }, { 6, -2 } },
+                                                        { { 10, 0 }, { 10, 4 }, { 12, 4 }, { 12, 2 }, { 14, 2 }, { 14, 0 } } };
+    const std::vector< ues::geom::point<2> > endpoints { { 0, 0 }, { 8, 2 }, { 16, 5 }, { 11, -3 }, { 13, 6 }, { -2, 5 },
+                                                         { 9, 5 }, { 13.5, 3 }, { 1, 1 }, { 12, 2 }, { 6, -2 } };
+
+    ues::pf::vg2d::visibility_graph_pathfinder pathfinder ( obstacles );
+    std::shared_ptr< const ues::pf::vg2d::visibility_graph > obstacle_graph = pathfinder.get_obstacle_graph();
+    ASSERT_EQ ( 14u, obstacle_graph->size() );
+
+    // Every query finds the path found by building the visibility graph just for it, and the
+    // graph of the obstacles is not modified.
+    for ( const ues::geom::point<2> & origin : endpoints )
+    {
+        for ( const ues::geom::point<2> & target : endpoints )
+        {
+            ues::pf::path<2> expected = ues::pf::vg2d::visibility_graph_pathfinder::find_path ( obstacles, origin, target );
+            ues::pf::path<2> result = pathfinder.find_path ( origin, target );
+            EXPECT_NEAR ( expected.length(), result.length(), ues::math::epsilon ) << "From " << origin << " to " << target;
+            EXPECT_EQ ( origin, result.front() );
+            EXPECT_EQ ( target, result.back() );
+        }
+    }
+    EXPECT_EQ ( obstacle_graph, pathfinder.get_obstacle_graph() );
+    EXPECT_EQ ( 14u, obstacle_graph->size() );
+
+    // Around the first square, from one corner to the opposite one.
+    EXPECT_NEAR ( 4, pathfinder.find_path ( { 1, 1 }, { 3, 3 } ).length(), ues::math::epsilon );
+}
@@ -128,3 +128,26 @@ TEST ( pf, visibility_graph_generator_3d_contained )
     compare_paths ( expected_result, result );
 
 }
+
+
+TEST ( pf, visibility_graph_generator_3d_bounded )
+{
+    ues::env::obstacle_vector obstacles;
+    obstacles.push_back ( ues::env::obstacle ( { { 0, 0 }, { 0, 1 }, { 1, 1 }, { 1, 0 } }, 1 ) );
+    // Obstacles far from the query.
+    obstacles.push_back ( ues::env::obstacle ( { { 20, 20 }, { 20, 21 }, { 21, 21 }, { 21, 20 } }, 3 ) );
+    obstacles.push_back ( ues::env::obstacle ( { { -20, 20 }, { -20, 21 }, { -19, 21 }, { -19, 20 } }, 2 ) );
+
+    ues::geom::point<3> origin = { -1, .3, 0 };
+    ues::geom::point<3> target = { 2, .3, 0 };
+    ues::pf::ellipse_bound<3> bound ( origin, target, ues::pf::fly_over_length ( obstacles, origin, target ) );
+
+    std::shared_ptr< ues::pf::vg3d::visibility_graph > unbounded_graph = ues::pf::vg3d::visibility_graph_generator::generate_visibility_graph ( obstacles, origin, target );
+    std::shared_ptr< ues::pf::vg3d::visibility_graph > bounded_graph = ues::pf::vg3d::visibility_graph_generator::generate_visibility_graph ( obstacles, origin, target, bound );
+    EXPECT_LT ( bounded_graph->size(), unbounded_graph->size() );
+
+    ues::pf::search_workspace<3> workspace;
+    ues::pf::path<3> unbounded_result = ues::pf::graph_pathfinder<3> ( unbounded_graph ).find_path ( origin, target );
+    ues::pf::path<3> bounded_result = ues::pf::graph_pathfinder<3> ( bounded_graph ).find_path ( origin, target, workspace, bound );
+    compare_paths ( unbounded_result, bounded_result );
+}